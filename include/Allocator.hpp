@@ -0,0 +1,207 @@
+#ifndef Allocator_hpp
+#define Allocator_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <new>
+#include <type_traits>
+
+namespace vecxify {
+
+// source of memory for the limb storage of BigInt (and any container using PolicyAllocator)
+// every thread has an active policy, the global heap unless a PolicyScope is alive
+class MemoryPolicy {
+public:
+    virtual ~MemoryPolicy() = default;
+
+    virtual void* allocate(const size_t& bytes) = 0;
+
+    virtual void deallocate(void* ptr, const size_t& bytes) noexcept = 0;
+
+    // policy used by this thread for new allocations
+    static MemoryPolicy& current() noexcept;
+
+    // plain ::operator new / ::operator delete
+    static MemoryPolicy& heap() noexcept;
+
+    // size-class pool owned by this thread
+    static MemoryPolicy& pool() noexcept;
+};
+
+// caches freed blocks in power-of-2 size classes, one instance per thread
+// so neither allocation nor deallocation takes a lock
+// blocks freed by another thread (or after the owning thread exit) go back to the global heap
+class PoolPolicy final : public MemoryPolicy {
+private:
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t MIN_CLASS = 4;   // 16 bytes
+    static constexpr size_t MAX_CLASS = 20;  // 1 MiB, larger blocks bypass the pool
+    static constexpr size_t MAX_CACHED_BYTES = size_t{1} << 22; // per size class
+
+    std::array<FreeBlock*, MAX_CLASS + 1> _free{};
+    std::array<size_t, MAX_CLASS + 1> _cached{};
+
+    static size_t sizeClass(const size_t& bytes) noexcept;
+
+    // true iff the calling thread owns this pool and the pool is still alive
+    bool owned() const noexcept;
+
+    PoolPolicy() = default;
+
+    friend class MemoryPolicy;
+
+public:
+
+    PoolPolicy(const PoolPolicy&) = delete;
+    PoolPolicy& operator=(const PoolPolicy&) = delete;
+
+    void* allocate(const size_t& bytes) override;
+
+    void deallocate(void* ptr, const size_t& bytes) noexcept override;
+
+    // return every cached block to the global heap
+    void release() noexcept;
+};
+
+// monotonic bump allocator, everything is freed together when the arena is destroyed
+// deallocate only reclaims memory if it was the most recent allocation
+// not thread-safe, an arena should only be used by the thread that installed it
+class ArenaPolicy final : public MemoryPolicy {
+private:
+
+    struct Chunk {
+        std::byte* begin;
+        size_t size;
+    };
+
+    std::vector<Chunk> _chunks;
+    std::byte* _top = nullptr;
+    std::byte* _end = nullptr;
+    size_t _nextChunk;
+
+    void grow(const size_t& bytes);
+
+public:
+
+    explicit ArenaPolicy(const size_t& initialBytes = size_t{1} << 16);
+
+    ArenaPolicy(const ArenaPolicy&) = delete;
+    ArenaPolicy& operator=(const ArenaPolicy&) = delete;
+
+    ~ArenaPolicy();
+
+    void* allocate(const size_t& bytes) override;
+
+    void deallocate(void* ptr, const size_t& bytes) noexcept override;
+
+    // free all memory handed out by this arena
+    void release() noexcept;
+
+    // total bytes reserved from the global heap
+    size_t reserved() const noexcept;
+};
+
+// install a policy as the current policy of this thread for the lifetime of the scope
+class PolicyScope {
+private:
+    MemoryPolicy* _previous;
+public:
+    explicit PolicyScope(MemoryPolicy& policy) noexcept;
+
+    PolicyScope(const PolicyScope&) = delete;
+    PolicyScope& operator=(const PolicyScope&) = delete;
+
+    ~PolicyScope();
+};
+
+// scoped arena: every BigInt created inside the scope allocates from the arena
+// values meant to outlive the scope must be assigned to objects created outside of it,
+// assignment keeps the memory policy of the destination
+class ArenaScope final {
+private:
+    ArenaPolicy _arena;
+    PolicyScope _scope;
+public:
+    explicit ArenaScope(const size_t& initialBytes = size_t{1} << 16) : _arena{initialBytes}, _scope{_arena} {}
+
+    ArenaPolicy& arena() noexcept {
+        return _arena;
+    }
+};
+
+// scoped pool: every BigInt created inside the scope allocates from the thread-local pool
+class PoolScope final {
+private:
+    PolicyScope _scope;
+public:
+    PoolScope() noexcept : _scope{MemoryPolicy::pool()} {}
+};
+
+// standard allocator forwarding to a MemoryPolicy
+// a container binds to the policy current at construction (or copy construction)
+// and keeps it, the policy is never propagated on assignment or swap
+template <typename T>
+class PolicyAllocator {
+private:
+    MemoryPolicy* _policy;
+
+    template <typename U>
+    friend class PolicyAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    PolicyAllocator() noexcept : _policy { &MemoryPolicy::current() } {}
+
+    explicit PolicyAllocator(MemoryPolicy& policy) noexcept : _policy { &policy } {}
+
+    template <typename U>
+    PolicyAllocator(const PolicyAllocator<U>& m) noexcept : _policy { m._policy } {}
+
+    T* allocate(const size_t n) {
+        if constexpr (alignof(T) > alignof(std::max_align_t))
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+        else
+            return static_cast<T*>(_policy->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, const size_t n) noexcept {
+        if constexpr (alignof(T) > alignof(std::max_align_t))
+            ::operator delete(ptr, std::align_val_t{alignof(T)});
+        else
+            _policy->deallocate(ptr, n * sizeof(T));
+    }
+
+    // copies are bound to the policy of the copying thread, not the source
+    PolicyAllocator<T> select_on_container_copy_construction() const noexcept {
+        return PolicyAllocator<T>();
+    }
+
+    MemoryPolicy& policy() const noexcept {
+        return *_policy;
+    }
+
+    template <typename U>
+    bool operator==(const PolicyAllocator<U>& rhs) const noexcept {
+        return _policy == rhs._policy;
+    }
+
+    template <typename U>
+    bool operator!=(const PolicyAllocator<U>& rhs) const noexcept {
+        return !(*this == rhs);
+    }
+};
+
+}
+
+#endif /* Allocator_hpp */
@@ -4,10 +4,17 @@
 #include <iostream>
 #include <algorithm>
 #include <memory>
+#include <vector>
+#include <string>
+#include <string_view>
 #include <cstdint>
 #include <cassert>
 #include <compare>
 #include <stdexcept>
+#include <functional>
+#include <tuple>
+#include "Allocator.hpp"
+#include "MatrixKernel.hpp"
 
 namespace vecxify {
 
@@ -15,74 +22,182 @@ namespace vecxify {
 using big = BigInt;
 #endif
 
+class BigInt;
+
+// multi-modular matrix product: entries are reduced modulo enough word-size primes to bound
+// the result, multiplied as Mat<ModNum> per prime in parallel and rebuilt by the Chinese
+// remainder theorem, see BigIntMatrix.cpp
+template <>
+struct MatrixKernel<BigInt> {
+    static constexpr bool enabled = true;
+
+    static void multiply(const BigInt* lhs, const BigInt* rhs, BigInt* out, const size_t& n, const size_t& k, const size_t& m);
+};
+
 class BigInt final {
+public:
+
+    using Limb = uint32_t;
+
+    // magnitude of the number in base 2^32, least significant limb first
+    // the limb storage allocates from the MemoryPolicy current at construction,
+    // see Allocator.hpp for the thread-local pool and the scoped arena
+    using LimbVector = std::vector<Limb, PolicyAllocator<Limb>>;
+
 private:
-    
-    std::shared_ptr<std::string> _num;
-    
+
+    LimbVector _limbs;
+
+    // zero is never positive
     bool _positive;
-    
+
+    friend struct MatrixKernel<BigInt>;
+
     static bool isNumber(const char& x) noexcept;
-    
+
     // check if a string is a valid representation of BigInt
     // a string is a valid representation of BigInt iff
     // the string has no prefix zero(except 0) and consist only number
     // with the exception the first character could be '-'
     static bool isValidBigInt(const std::string_view& m) noexcept;
-    
+
     static int8_t charToInt(const char& c);
-    
+
     static char intToChar(const int8_t& x);
-    
+
     bool sameSign(const BigInt& rhs) const noexcept;
-    
-    BigInt(const std::shared_ptr<std::string>& ptr, const bool& positive);
-    
-    BigInt shallowCopy() noexcept;
-    BigInt deepCopy() const noexcept;
-    
-    //return a temp (shallow copy) abosulte value of the original BigInt
-    BigInt abs() const noexcept;
-    
-    // multiply by a single digit
-    BigInt operator*(const int8_t& rhs) const noexcept;
-    BigInt& operator*=(const int8_t& rhs) noexcept;
-    
+
+    BigInt(LimbVector&& limbs, const bool& positive);
+
+    // remove leading zero limbs and fix the sign of zero
+    void normalize() noexcept;
+
+    // operations on magnitudes, least significant limb first, no sign involved
+    static int compareMagnitude(const LimbVector& lhs, const LimbVector& rhs) noexcept;
+    static void addMagnitude(LimbVector& lhs, const LimbVector& rhs);
+    // requires lhs >= rhs
+    static void subMagnitude(LimbVector& lhs, const LimbVector& rhs) noexcept;
+    // requires rhs > lhs, compute lhs = rhs - lhs
+    static void reverseSubMagnitude(LimbVector& lhs, const LimbVector& rhs);
+    static LimbVector mulMagnitude(const LimbVector& lhs, const LimbVector& rhs);
+    // product of two limb ranges: schoolbook, Karatsuba, then three-prime NTT as operands grow
+    // subproducts and transforms of large operands run on the shared ThreadPool (BigIntMultiply.cpp)
+    static LimbVector mulRange(const Limb* lhs, const size_t& n, const Limb* rhs, const size_t& m);
+    // lhs += rhs * 2^(32 * offset)
+    static void addShifted(LimbVector& lhs, const LimbVector& rhs, const size_t& offset);
+    static void mulSmall(LimbVector& lhs, const Limb& mul, const Limb& add);
+    // divide in place by a single limb, return the remainder
+    static Limb divSmall(LimbVector& lhs, const Limb& div) noexcept;
+    // long division (Knuth algorithm D), rhs must be non-zero
+    static void divModMagnitude(const LimbVector& lhs, const LimbVector& rhs, LimbVector* quotient, LimbVector* remainder);
+
+    static void shiftLeftMagnitude(LimbVector& x, const size_t& shift);
+    // return true if any of the discarded bits is set
+    static bool shiftRightMagnitude(LimbVector& x, const size_t& shift);
+
+    // signed addition of a magnitude, used by += and -=
+    void addSigned(const LimbVector& rhs, const bool& rhsPositive);
+
+    // floor(2^(64n) / v) where n is the number of limbs of v, by Newton iteration
+    static LimbVector reciprocal(const LimbVector& v);
+
+    // 10^(9 * 2^level) and its reciprocal, computed once and shared by all threads
+    static const LimbVector& decimalPower(const size_t& level);
+    static const LimbVector& decimalReciprocal(const size_t& level);
+
+    // x = quotient * v + remainder given inverse = reciprocal(v) (Barrett reduction)
+    // x must have at most twice as many limbs as v
+    static void barrettDivMod(const LimbVector& x, const LimbVector& v, const LimbVector& inverse, LimbVector* quotient, LimbVector& remainder);
+
+    // divide by 10^(9 * 2^level) with the cached reciprocal
+    static void divModDecimalPower(const LimbVector& x, const size_t& level, LimbVector& quotient, LimbVector& remainder);
+
+    // divide-and-conquer radix conversion, O(M(n) log n)
+    static LimbVector parseDecimal(const std::string_view& digits);
+    // emit the digits of x most significant first, left padded with zeros to width (no padding if width is 0)
+    static void writeDecimal(const LimbVector& x, const size_t& width, const std::function<void(const char*, const size_t&)>& sink);
+    // write exactly width digits of x into out, left padded with zeros, halves run in parallel
+    static void writeDecimalFixed(const LimbVector& x, char* out, const size_t& width);
+    // upper bound of the number of decimal digits of the magnitude
+    size_t maxDecimalLength() const noexcept;
+
 public:
-    
+
     BigInt() noexcept;
     BigInt(const std::string_view& m);
     explicit BigInt(const char& m);
-    BigInt(const long long& m) noexcept;
-    BigInt(const BigInt& m) noexcept;
-    BigInt(const BigInt&& m) noexcept;
-    
+    BigInt(const long long& m);
+    BigInt(const BigInt& m);
+    BigInt(BigInt&& m) noexcept;
+
     BigInt& operator=(const std::string_view& m);
-    BigInt& operator=(const BigInt& m) noexcept;
-    BigInt& operator=(const BigInt&& m) noexcept;
-    
+    BigInt& operator=(const BigInt& m);
+    BigInt& operator=(BigInt&& m);
+
     BigInt operator+(const BigInt& rhs) const;
-    BigInt operator-() const noexcept;
+    BigInt operator-() const;
     BigInt operator-(const BigInt& rhs) const;
     BigInt operator*(const BigInt& rhs) const;
+    BigInt operator/(const BigInt& rhs) const;
     BigInt operator%(const BigInt& rhs) const;
+    BigInt operator<<(const size_t& shift) const;
+    BigInt operator>>(const size_t& shift) const;
     BigInt& operator+=(const BigInt& rhs);
     BigInt& operator-=(const BigInt& rhs);
     BigInt& operator*=(const BigInt& rhs);
+    // quotient is truncated toward zero, as for built-in integers
+    BigInt& operator/=(const BigInt& rhs);
+    // remainder has the sign of the dividend, as for built-in integers
     BigInt& operator%=(const BigInt& rhs);
-    
+    BigInt& operator<<=(const size_t& shift);
+    // arithmetic shift, rounds toward negative infinity as for built-in integers
+    BigInt& operator>>=(const size_t& shift);
+
     bool operator==(const BigInt& rhs) const noexcept;
     bool operator<(const BigInt& rhs) const noexcept;
     bool operator<=(const BigInt& rhs) const noexcept;
     bool operator>(const BigInt& rhs) const noexcept;
     bool operator>=(const BigInt& rhs) const noexcept;
-    operator bool() const noexcept;
-    
+    explicit operator bool() const noexcept;
+
+    bool isNegative() const noexcept;
+
+    // number of bits of the absolute value, 0 for zero
+    size_t bitLength() const noexcept;
+
+    // decimal representation, converted in parallel for very large values
+    std::string toString() const;
+
+    // write the decimal representation into [first, last)
+    // return one past the last written character, or nullptr if the range is too small
+    char* toChars(char* first, char* last) const;
+
+    // stream the decimal representation in chunks without building the whole string
+    void write(std::ostream& out) const;
+
+    const LimbVector& limbs() const noexcept;
+
     friend std::ostream& operator<<(std::ostream& out, const BigInt& x);
-    
+
     // return new instances of BigInt (deepCopy), which is the absolute value of original BigInt
-    friend BigInt abs(const BigInt& x) noexcept;
-    friend BigInt abs(const BigInt&& x) noexcept;
+    friend BigInt abs(const BigInt& x);
+    friend BigInt abs(BigInt&& x) noexcept;
+
+    // base^exp by square-and-multiply
+    friend BigInt pow(const BigInt& base, unsigned long long exp);
+
+    // base^exp mod |mod|, result in [0, |mod|)
+    // sliding window exponentiation, in Montgomery form when mod is odd
+    friend BigInt modpow(const BigInt& base, const BigInt& exp, const BigInt& mod);
+
+    // non-negative greatest common divisor, Lehmer's algorithm
+    friend BigInt gcd(const BigInt& lhs, const BigInt& rhs);
+
+    // (g, x, y) such that lhs * x + rhs * y = g = gcd(lhs, rhs)
+    friend std::tuple<BigInt, BigInt, BigInt> extendedGcd(const BigInt& lhs, const BigInt& rhs);
+
+    // floor(sqrt(x)) by Newton iteration, x must be non-negative
+    friend BigInt isqrt(const BigInt& x);
 };
 
 }
@@ -0,0 +1,116 @@
+#ifndef BitMatrix_hpp
+#define BitMatrix_hpp
+
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include "Matrix.hpp"
+
+namespace vecxify {
+
+// matrix over GF(2) with dimensions chosen at runtime, one bit per entry
+// every row is a run of 64-bit words, bit j of a row is bit j % 64 of its word j / 64,
+// the bits past the last column are always zero
+// addition is XOR, multiplication is AND and XOR (or OR for booleanMultiply), both by
+// the Method of Four Russians, see BitMatrix.cpp
+class BitMatrix final {
+public:
+
+    using Word = uint64_t;
+
+    static constexpr size_t WORD_BITS = 64;
+
+private:
+
+    size_t _rows;
+    size_t _cols;
+    // words per row
+    size_t _stride;
+    std::vector<Word> _words;
+
+    void checkIndex(const size_t& row, const size_t& col) const;
+
+public:
+
+    // zero matrix
+    BitMatrix(const size_t& rows, const size_t& cols);
+
+    // nonzero entries of m are set
+    template <typename T, size_t ROW, size_t COL>
+    explicit BitMatrix(const Basic_Matrix<T, ROW, COL>& m) : BitMatrix(ROW, COL) {
+        for (size_t i = 0; i < ROW; ++i)
+            for (size_t j = 0; j < COL; ++j)
+                if (m(i, j) != T{})
+                    set(i, j, true);
+    }
+
+    static BitMatrix identity(const size_t& n);
+
+    size_t rows() const noexcept {
+        return _rows;
+    }
+
+    size_t cols() const noexcept {
+        return _cols;
+    }
+
+    // number of words of a row
+    size_t stride() const noexcept {
+        return _stride;
+    }
+
+    Word* row(const size_t& i) noexcept {
+        return _words.data() + i * _stride;
+    }
+
+    const Word* row(const size_t& i) const noexcept {
+        return _words.data() + i * _stride;
+    }
+
+    bool operator()(const size_t& row, const size_t& col) const noexcept {
+        return (_words[row * _stride + col / WORD_BITS] >> (col % WORD_BITS)) & 1;
+    }
+
+    bool at(const size_t& row, const size_t& col) const;
+
+    void set(const size_t& row, const size_t& col, const bool& value) noexcept {
+        Word& word = _words[row * _stride + col / WORD_BITS];
+        const Word bit = Word{1} << (col % WORD_BITS);
+        word = value ? word | bit : word & ~bit;
+    }
+
+    void flip(const size_t& row, const size_t& col) noexcept {
+        _words[row * _stride + col / WORD_BITS] ^= Word{1} << (col % WORD_BITS);
+    }
+
+    // number of ones
+    size_t count() const noexcept;
+
+    BitMatrix transpose() const;
+
+    // reduce to reduced row echelon form in place by Gauss-Jordan elimination with
+    // Four Russians tables of up to 8 pivot rows, return the rank
+    size_t eliminate();
+
+    size_t rank() const;
+
+    // operands must have the same dimensions
+    BitMatrix operator+(const BitMatrix& rhs) const;
+    BitMatrix& operator+=(const BitMatrix& rhs);
+
+    // GF(2) product, lhs.cols() must equal rhs.rows()
+    BitMatrix operator*(const BitMatrix& rhs) const;
+
+    bool operator==(const BitMatrix& rhs) const noexcept;
+
+    // boolean product (OR of ANDs): reachability in one step through the middle vertices
+    friend BitMatrix booleanMultiply(const BitMatrix& lhs, const BitMatrix& rhs);
+
+    friend std::ostream& operator<<(std::ostream& out, const BitMatrix& m);
+};
+
+}
+
+#endif /* BitMatrix_hpp */
@@ -0,0 +1,156 @@
+#ifndef Distance_hpp
+#define Distance_hpp
+
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <concepts>
+#include <stdexcept>
+#include "Vector.hpp"
+#include "Semiring.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+// measures between two vectors a and b
+//     squaredEuclidean   |a - b|^2 = |a|^2 + |b|^2 - 2 a.b
+//     euclidean          |a - b|
+//     cosineDistance     1 - cosineSimilarity
+//     cosineSimilarity   a.b / (|a| |b|), 0 when either vector is zero
+//     innerProduct       a.b
+// the first three are distances (nearest is smallest), the last two similarities (nearest is largest)
+enum class Metric { squaredEuclidean, euclidean, cosineDistance, cosineSimilarity, innerProduct };
+
+// a point of a top-k query and its measure to the query
+template <typename T>
+struct Neighbor {
+    size_t index;
+    T value;
+};
+
+namespace detail {
+
+// queries per task, and points per tile of the top-k search (a tile of scores takes 64 KiB of floats)
+inline constexpr size_t DISTANCE_ROWS = 64;
+inline constexpr size_t DISTANCE_TILE = 256;
+
+constexpr bool similarity(const Metric& metric) noexcept {
+    return metric == Metric::cosineSimilarity || metric == Metric::innerProduct;
+}
+
+// vectors as a row-major matrix of count x N, or its transpose, and their squared norms
+template <typename T, size_t N>
+std::vector<T> packVectors(const std::vector<Vec<T, N>>& vectors, const bool& transposed, std::vector<T>& norms) {
+    const size_t count = vectors.size();
+    std::vector<T> res(count * N);
+    norms.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        T norm{};
+        for (size_t p = 0; p < N; ++p) {
+            const T& x = vectors[i](p);
+            norm += x * x;
+            res[transposed ? p * count + i : i * N + p] = x;
+        }
+        norms[i] = norm;
+    }
+    return res;
+}
+
+// the measure from the inner product and the squared norms of the two vectors
+template <typename T>
+T measure(const Metric& metric, const T& dot, const T& lhsNorm, const T& rhsNorm) noexcept {
+    switch (metric) {
+        case Metric::squaredEuclidean:
+            return std::max(lhsNorm + rhsNorm - 2 * dot, T{0});
+        case Metric::euclidean:
+            return std::sqrt(std::max(lhsNorm + rhsNorm - 2 * dot, T{0}));
+        case Metric::innerProduct:
+            return dot;
+        default: {
+            const T scale = lhsNorm * rhsNorm;
+            const T cosine = scale > 0 ? dot / std::sqrt(scale) : T{0};
+            return metric == Metric::cosineSimilarity ? cosine : 1 - cosine;
+        }
+    }
+}
+
+}
+
+// out(i, j) = metric(lhs[i], rhs[j]) as a row-major lhs.size() x rhs.size() matrix
+// the inner products are one matrix product on the vector kernels of Semiring.hpp, norms are
+// computed once per vector; the expansion of |a - b|^2 loses digits for close vectors of large
+// norm, squared distances are clamped at 0
+template <std::floating_point T, size_t N>
+std::vector<T> pairwise(const std::vector<Vec<T, N>>& lhs, const std::vector<Vec<T, N>>& rhs, const Metric& metric) {
+    const size_t n = lhs.size(), m = rhs.size();
+    std::vector<T> lhsNorms, rhsNorms;
+    const std::vector<T> a = detail::packVectors(lhs, false, lhsNorms);
+    const std::vector<T> b = detail::packVectors(rhs, true, rhsNorms);
+    std::vector<T> res(n * m);
+    detail::semiringMultiply<detail::ProductUpdate<T, false>>(a.data(), b.data(), res.data(), n, N, m);
+    if (metric == Metric::innerProduct)
+        return res;
+    ThreadPool::shared().parallelFor(0, n, detail::DISTANCE_ROWS, [&](const size_t& first, const size_t& last) {
+        for (size_t i = first; i < last; ++i)
+            for (size_t j = 0; j < m; ++j)
+                res[i * m + j] = detail::measure(metric, res[i * m + j], lhsNorms[i], rhsNorms[j]);
+    });
+    return res;
+}
+
+// the k points nearest to each query, best first (ties by index), fewer when there are fewer points
+// queries are split in blocks across the shared pool, and each block runs through the points a tile
+// at a time keeping a heap of its k best, so memory stays at one tile of measures per task
+template <std::floating_point T, size_t N>
+std::vector<std::vector<Neighbor<T>>> nearest(const std::vector<Vec<T, N>>& queries, const std::vector<Vec<T, N>>& points, const size_t& k, const Metric& metric) {
+    constexpr size_t ROWS = detail::DISTANCE_ROWS, TILE = detail::DISTANCE_TILE;
+    const size_t n = queries.size(), m = points.size();
+    const bool larger = detail::similarity(metric);
+    std::vector<T> queryNorms, pointNorms;
+    const std::vector<T> a = detail::packVectors(queries, false, queryNorms);
+    const std::vector<T> b = detail::packVectors(points, true, pointNorms);
+
+    // better(x, y): x goes before y in the result, the top of a heap is its worst neighbor
+    auto better = [larger](const Neighbor<T>& x, const Neighbor<T>& y) {
+        if (x.value != y.value)
+            return larger ? x.value > y.value : x.value < y.value;
+        return x.index < y.index;
+    };
+
+    std::vector<std::vector<Neighbor<T>>> res(n);
+    if (k == 0)
+        return res;
+    ThreadPool::shared().parallelFor(0, n, ROWS, [&](const size_t& first, const size_t& last) {
+        std::vector<T> scores(ROWS * TILE);
+        for (size_t i0 = first; i0 < last; i0 += ROWS) {
+            const size_t rows = std::min(ROWS, last - i0);
+            for (size_t j0 = 0; j0 < m; j0 += TILE) {
+                const size_t width = std::min(TILE, m - j0);
+                std::fill(scores.begin(), scores.begin() + rows * TILE, T{0});
+                detail::semiringAccumulate<detail::ProductUpdate<T, false>>(a.data() + i0 * N, N, b.data() + j0, m, scores.data(), TILE, 0, rows, N, width);
+                for (size_t r = 0; r < rows; ++r) {
+                    std::vector<Neighbor<T>>& heap = res[i0 + r];
+                    for (size_t j = 0; j < width; ++j) {
+                        const Neighbor<T> candidate{j0 + j, detail::measure(metric, scores[r * TILE + j], queryNorms[i0 + r], pointNorms[j0 + j])};
+                        if (heap.size() < k) {
+                            heap.push_back(candidate);
+                            std::push_heap(heap.begin(), heap.end(), better);
+                        } else if (better(candidate, heap.front())) {
+                            std::pop_heap(heap.begin(), heap.end(), better);
+                            heap.back() = candidate;
+                            std::push_heap(heap.begin(), heap.end(), better);
+                        }
+                    }
+                }
+            }
+            for (size_t r = 0; r < rows; ++r)
+                std::sort_heap(res[i0 + r].begin(), res[i0 + r].end(), better);
+        }
+    });
+    return res;
+}
+
+}
+
+#endif /* Distance_hpp */
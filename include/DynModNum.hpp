@@ -0,0 +1,283 @@
+#ifndef DynModNum_hpp
+#define DynModNum_hpp
+
+#include <iostream>
+#include <cstdint>
+#include <stdexcept>
+#include "Reduction.hpp"
+
+namespace vecxify {
+
+// modulus chosen at runtime, with the constants of its reduction engine computed once
+// (Montgomery for odd moduli, Barrett otherwise, see Reduction.hpp)
+// residues handled through a Modulus are in its form, see toForm / fromForm
+class Modulus final {
+private:
+    MontgomeryReduction _montgomery;
+    BarrettReduction _barrett;
+    bool _odd;
+
+public:
+    // mod must be in [1, 2^63)
+    explicit Modulus(const uint64_t& mod);
+
+    uint64_t modulus() const noexcept {
+        return _barrett.modulus();
+    }
+
+    // form of an arbitrary integer, negative values are mapped into [0, mod)
+    uint64_t fromInteger(const long long& x) const noexcept {
+        uint64_t magnitude = x < 0 ? 0 - static_cast<uint64_t>(x) : static_cast<uint64_t>(x);
+        uint64_t res = _barrett.reduce(magnitude);
+        return toForm(x < 0 ? _barrett.neg(res) : res);
+    }
+
+    uint64_t toForm(const uint64_t& x) const noexcept {
+        return _odd ? _montgomery.toForm(x) : x;
+    }
+
+    uint64_t fromForm(const uint64_t& x) const noexcept {
+        return _odd ? _montgomery.fromForm(x) : x;
+    }
+
+    uint64_t add(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        return _barrett.add(lhs, rhs);
+    }
+
+    uint64_t sub(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        return _barrett.sub(lhs, rhs);
+    }
+
+    uint64_t neg(const uint64_t& x) const noexcept {
+        return _barrett.neg(x);
+    }
+
+    uint64_t mul(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        return _odd ? _montgomery.mul(lhs, rhs) : _barrett.mul(lhs, rhs);
+    }
+
+    bool operator==(const Modulus& rhs) const noexcept {
+        return modulus() == rhs.modulus();
+    }
+
+    // modulus of the innermost ModulusScope alive on this thread, nullptr if there is none
+    static const Modulus* current() noexcept;
+};
+
+// make a modulus current for this thread while the scope is alive
+// DynModNum values built from plain integers in the scope are bound to it
+class ModulusScope final {
+private:
+    const Modulus* _previous;
+
+public:
+    explicit ModulusScope(const Modulus& mod) noexcept;
+
+    ModulusScope(const ModulusScope&) = delete;
+    ModulusScope& operator=(const ModulusScope&) = delete;
+
+    ~ModulusScope();
+};
+
+class DynModNum;
+
+std::ostream& operator<< (std::ostream& out, const DynModNum& m);
+
+// residue modulo a runtime Modulus
+// a value refers to its modulus without owning it, so copying it is as cheap as copying two words
+// (no reference count): the Modulus must outlive every value bound to it, copies kept in a Mat,
+// a Vec or any container included, a value used after its Modulus is destroyed dangles
+// operands bound to moduli of different values throw std::invalid_argument
+// a value built from a plain integer outside any ModulusScope is unbound: it keeps the integer
+// and takes the modulus of the other operand when combined with a bound value, so constants
+// such as the 0 and 1 written by Mat work without knowing the modulus
+// arithmetic between unbound values is exact on long long and throws std::overflow_error when
+// the result leaves its range: they are meant for small constants, bind anything larger
+class DynModNum final {
+private:
+    const Modulus* _mod;
+
+    // residue in the form of _mod, or the integer itself when unbound
+    uint64_t _data;
+
+    DynModNum(const Modulus* mod, const uint64_t& form) noexcept : _mod { mod }, _data { form } {}
+
+    long long integer() const noexcept {
+        return static_cast<long long>(_data);
+    }
+
+    // modulus shared by both operands, nullptr if both are unbound
+    const Modulus* context(const DynModNum& rhs) const {
+        if (_mod && rhs._mod && !(*_mod == *rhs._mod))
+            throw std::invalid_argument("DynModNum operands have different moduli");
+        return _mod ? _mod : rhs._mod;
+    }
+
+    uint64_t formIn(const Modulus& mod) const noexcept {
+        return _mod ? _data : mod.fromInteger(integer());
+    }
+
+    // result of an unbound operation computed by one of the __builtin_*_overflow
+    static DynModNum unbound(const bool& overflow, const long long& res) {
+        if (overflow)
+            throw std::overflow_error("unbound DynModNum arithmetic overflows");
+        return DynModNum(res);
+    }
+
+public:
+
+    DynModNum() noexcept : DynModNum(0ll) {}
+
+    // bound to the current ModulusScope if there is one
+    DynModNum(const long long& m) noexcept : _mod { Modulus::current() }, _data { _mod ? _mod->fromInteger(m) : static_cast<uint64_t>(m) } {}
+
+    DynModNum(const Modulus& mod, const long long& m) noexcept : _mod { &mod }, _data { mod.fromInteger(m) } {}
+
+    // the value in [0, modulus), or the integer of an unbound value
+    long long get() const noexcept {
+        return _mod ? static_cast<long long>(_mod->fromForm(_data)) : integer();
+    }
+
+    // nullptr when unbound
+    const Modulus* modulus() const noexcept {
+        return _mod;
+    }
+
+    DynModNum operator+(const DynModNum& rhs) const {
+        const Modulus* mod = context(rhs);
+        long long res;
+        if (!mod)
+            return unbound(__builtin_add_overflow(integer(), rhs.integer(), &res), res);
+        return DynModNum(mod, mod->add(formIn(*mod), rhs.formIn(*mod)));
+    }
+
+    DynModNum operator-(const DynModNum& rhs) const {
+        const Modulus* mod = context(rhs);
+        long long res;
+        if (!mod)
+            return unbound(__builtin_sub_overflow(integer(), rhs.integer(), &res), res);
+        return DynModNum(mod, mod->sub(formIn(*mod), rhs.formIn(*mod)));
+    }
+
+    DynModNum operator-() const {
+        long long res;
+        if (!_mod)
+            return unbound(__builtin_sub_overflow(0ll, integer(), &res), res);
+        return DynModNum(_mod, _mod->neg(_data));
+    }
+
+    DynModNum operator*(const DynModNum& rhs) const {
+        const Modulus* mod = context(rhs);
+        long long res;
+        if (!mod)
+            return unbound(__builtin_mul_overflow(integer(), rhs.integer(), &res), res);
+        return DynModNum(mod, mod->mul(formIn(*mod), rhs.formIn(*mod)));
+    }
+
+    DynModNum& operator+=(const DynModNum& rhs) {
+        return *this = *this + rhs;
+    }
+
+    DynModNum& operator-=(const DynModNum& rhs) {
+        return *this = *this - rhs;
+    }
+
+    DynModNum& operator*=(const DynModNum& rhs) {
+        return *this = *this * rhs;
+    }
+
+    // multiplicative inverse, throws std::domain_error when the value is not coprime with the modulus
+    // an unbound value has no modulus to invert in, only an unbound 1 or -1 can be inverted
+    DynModNum inv() const {
+        if (!_mod) {
+            if (integer() != 1 && integer() != -1)
+                throw std::domain_error("value is not invertible");
+            return *this;
+        }
+        return DynModNum(_mod, _mod->toForm(inverseMod(_mod->fromForm(_data), _mod->modulus())));
+    }
+
+    DynModNum operator/(const DynModNum& rhs) const {
+        const Modulus* mod = context(rhs);
+        if (!mod)
+            return *this * rhs.inv();
+        return *this * DynModNum(mod, rhs.formIn(*mod)).inv();
+    }
+
+    DynModNum& operator/=(const DynModNum& rhs) {
+        return *this = *this / rhs;
+    }
+
+    // fixed-window exponentiation
+    DynModNum pow(const unsigned long long& exp) const {
+        if (!_mod)
+            return windowPower(*this, exp, DynModNum(1ll));
+        return windowPower(*this, exp, DynModNum(_mod, _mod->toForm(1 % _mod->modulus())));
+    }
+
+    DynModNum& operator++() {
+        return *this += DynModNum(1ll);
+    }
+
+    DynModNum& operator--() {
+        return *this -= DynModNum(1ll);
+    }
+
+    DynModNum operator++(int) {
+        DynModNum copy{ *this };
+        ++(*this);
+        return copy;
+    }
+
+    DynModNum operator--(int) {
+        DynModNum copy{ *this };
+        --(*this);
+        return copy;
+    }
+
+    bool operator==(const DynModNum& rhs) const {
+        const Modulus* mod = context(rhs);
+        if (!mod)
+            return _data == rhs._data;
+        return formIn(*mod) == rhs.formIn(*mod);
+    }
+
+    bool operator!=(const DynModNum& rhs) const {
+        return !(*this == rhs);
+    }
+
+    // compare the values in [0, modulus)
+    bool operator<(const DynModNum& rhs) const {
+        const Modulus* mod = context(rhs);
+        if (!mod)
+            return integer() < rhs.integer();
+        return mod->fromForm(formIn(*mod)) < mod->fromForm(rhs.formIn(*mod));
+    }
+
+    bool operator>(const DynModNum& rhs) const {
+        return rhs < *this;
+    }
+
+    bool operator<=(const DynModNum& rhs) const {
+        return !(rhs < *this);
+    }
+
+    bool operator>=(const DynModNum& rhs) const {
+        return !(*this < rhs);
+    }
+
+    // zero is zero in every form, and an unbound zero is the integer 0
+    explicit operator bool() const noexcept {
+        return _data != 0;
+    }
+
+};
+
+inline std::ostream& operator<< (std::ostream& out, const DynModNum& m) {
+    out << m.get();
+    return out;
+}
+
+}
+
+#endif /* DynModNum_hpp */
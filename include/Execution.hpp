@@ -0,0 +1,274 @@
+#ifndef Execution_hpp
+#define Execution_hpp
+
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <optional>
+#include <type_traits>
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+// execution policies of the bulk matrix operations below, after std::execution
+//     seq        the calling thread, in order
+//     par        ranges of about grain elements on the shared pool (see ThreadPool.hpp)
+//     par_unseq  as par, the loop over a range is also vectorized regardless of possible aliasing,
+//                element operations must not synchronize with each other
+// par(grain) and par_unseq(grain) pick the grain, memory-bound operations need ranges large
+// enough to amortize a task (tens of kilobytes)
+namespace execution {
+
+inline constexpr size_t DEFAULT_GRAIN = size_t{1} << 15;
+
+struct SequencedPolicy {};
+
+struct ParallelPolicy {
+    size_t grain = DEFAULT_GRAIN;
+
+    constexpr ParallelPolicy operator()(const size_t& elements) const noexcept {
+        return ParallelPolicy{std::max<size_t>(elements, 1)};
+    }
+};
+
+struct ParallelUnsequencedPolicy {
+    size_t grain = DEFAULT_GRAIN;
+
+    constexpr ParallelUnsequencedPolicy operator()(const size_t& elements) const noexcept {
+        return ParallelUnsequencedPolicy{std::max<size_t>(elements, 1)};
+    }
+};
+
+inline constexpr SequencedPolicy seq{};
+inline constexpr ParallelPolicy par{};
+inline constexpr ParallelUnsequencedPolicy par_unseq{};
+
+template <typename P>
+concept Policy = std::is_same_v<std::remove_cvref_t<P>, SequencedPolicy>
+    || std::is_same_v<std::remove_cvref_t<P>, ParallelPolicy>
+    || std::is_same_v<std::remove_cvref_t<P>, ParallelUnsequencedPolicy>;
+
+}
+
+namespace detail {
+
+// square tiles of the transposes, a tile of doubles takes 8 KiB
+inline constexpr size_t TRANSPOSE_TILE = 32;
+
+template <execution::Policy P>
+constexpr size_t policyGrain(const P& policy) noexcept {
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        return ~size_t{0};
+    else
+        return policy.grain;
+}
+
+// func(first, last) over [0, n), in one call for seq
+template <execution::Policy P, typename F>
+void forRanges(const P& policy, const size_t& n, F&& func) {
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        func(size_t{0}, n);
+    else
+        ThreadPool::shared().parallelFor(0, n, policy.grain, func);
+}
+
+// func(i) for i in [first, last), without dependence checks for par_unseq
+template <execution::Policy P, typename F>
+void elementLoop(const size_t& first, const size_t& last, F& func) {
+    if constexpr (std::is_same_v<P, execution::ParallelUnsequencedPolicy>) {
+#pragma GCC ivdep
+        for (size_t i = first; i < last; ++i)
+            func(i);
+    } else {
+        for (size_t i = first; i < last; ++i)
+            func(i);
+    }
+}
+
+// op over [first, last) split in halves down to grain, the result does not depend on scheduling
+template <typename T, typename Op, typename Leaf>
+T reduceRange(const size_t& first, const size_t& last, const size_t& grain, Op& op, Leaf& leaf) {
+    if (last - first <= grain)
+        return leaf(first, last);
+    const size_t mid = first + (last - first) / 2;
+    std::optional<T> left, right;
+    ThreadPool::shared().invoke(
+        [&]() { left.emplace(reduceRange<T>(first, mid, grain, op, leaf)); },
+        [&]() { right.emplace(reduceRange<T>(mid, last, grain, op, leaf)); }
+    );
+    return op(*left, *right);
+}
+
+// out = in^T for in of rows x cols, tiles of out rows [first, last) * TRANSPOSE_TILE
+// rows of in start ldIn elements apart and rows of out ldOut apart
+template <typename T>
+void transposeTiles(const T* in, const size_t& ldIn, T* out, const size_t& ldOut, const size_t& rows, const size_t& cols, const size_t& first, const size_t& last) {
+    constexpr size_t TILE = TRANSPOSE_TILE;
+    for (size_t j0 = first * TILE; j0 < std::min(cols, last * TILE); j0 += TILE) {
+        const size_t j1 = std::min(cols, j0 + TILE);
+        for (size_t i0 = 0; i0 < rows; i0 += TILE) {
+            const size_t i1 = std::min(rows, i0 + TILE);
+            for (size_t j = j0; j < j1; ++j)
+                for (size_t i = i0; i < i1; ++i)
+                    out[j * ldOut + i] = in[i * ldIn + j];
+        }
+    }
+}
+
+// a = a^T for a of n x n, pairs of tiles above and below the diagonal in tile rows [first, last)
+template <typename T>
+void transposeInPlace(T* a, const size_t& n, const size_t& first, const size_t& last) {
+    constexpr size_t TILE = TRANSPOSE_TILE;
+    for (size_t i0 = first * TILE; i0 < std::min(n, last * TILE); i0 += TILE) {
+        const size_t i1 = std::min(n, i0 + TILE);
+        for (size_t j0 = i0; j0 < n; j0 += TILE) {
+            const size_t j1 = std::min(n, j0 + TILE);
+            for (size_t i = i0; i < i1; ++i)
+                for (size_t j = std::max(j0, i + 1); j < j1; ++j)
+                    std::swap(a[i * n + j], a[j * n + i]);
+        }
+    }
+}
+
+}
+
+// heap matrix filled with value by the ranges of policy, the ranges the operations below split it into
+// its memory is left untouched before, so on a NUMA machine with first-touch placement the pages
+// land on the nodes of the pool threads that take the ranges instead of the node of the caller
+template <typename T, size_t ROW, size_t COL, execution::Policy P>
+std::unique_ptr<Mat<T, ROW, COL>> allocate(const P& policy, const T& value = T{}) {
+    std::unique_ptr<Mat<T, ROW, COL>> res{new Mat<T, ROW, COL>(uninitialized)};
+    T* data = res->data();
+    detail::forRanges(policy, ROW * COL, [&](const size_t& first, const size_t& last) {
+        std::fill(data + first, data + last, value);
+    });
+    return res;
+}
+
+// out(i, j) = func(in(i, j)), out may be in
+template <execution::Policy P, typename T, typename U, size_t ROW, size_t COL, typename F>
+void transform(const P& policy, const Basic_Matrix<T, ROW, COL>& in, Basic_Matrix<U, ROW, COL>& out, F func) {
+    const T* x = in.data();
+    U* y = out.data();
+    detail::forRanges(policy, ROW * COL, [&](const size_t& first, const size_t& last) {
+        auto element = [&](const size_t& i) { y[i] = func(x[i]); };
+        detail::elementLoop<P>(first, last, element);
+    });
+}
+
+// out(i, j) = func(lhs(i, j), rhs(i, j)), out may be either operand
+template <execution::Policy P, typename T, typename U, typename V, size_t ROW, size_t COL, typename F>
+void transform(const P& policy, const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<U, ROW, COL>& rhs, Basic_Matrix<V, ROW, COL>& out, F func) {
+    const T* x = lhs.data();
+    const U* y = rhs.data();
+    V* z = out.data();
+    detail::forRanges(policy, ROW * COL, [&](const size_t& first, const size_t& last) {
+        auto element = [&](const size_t& i) { z[i] = func(x[i], y[i]); };
+        detail::elementLoop<P>(first, last, element);
+    });
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+void add(const P& policy, const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs, Basic_Matrix<T, ROW, COL>& out) {
+    transform(policy, lhs, rhs, out, [](const T& x, const T& y) { return x + y; });
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+void subtract(const P& policy, const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs, Basic_Matrix<T, ROW, COL>& out) {
+    transform(policy, lhs, rhs, out, [](const T& x, const T& y) { return x - y; });
+}
+
+// out = lhs * scalar
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+void scale(const P& policy, const Basic_Matrix<T, ROW, COL>& lhs, const T& scalar, Basic_Matrix<T, ROW, COL>& out) {
+    transform(policy, lhs, out, [&scalar](const T& x) { return x * scalar; });
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+void fill(const P& policy, Basic_Matrix<T, ROW, COL>& m, const T& value) {
+    T* data = m.data();
+    detail::forRanges(policy, ROW * COL, [&](const size_t& first, const size_t& last) {
+        std::fill(data + first, data + last, value);
+    });
+}
+
+// m = I, split by rows
+template <execution::Policy P, typename T, size_t N>
+Mat<T, N, N>& identity(const P& policy, Mat<T, N, N>& m) {
+    T* data = m.data();
+    const size_t rowGrain = std::max<size_t>(detail::policyGrain(policy) / N, 1);
+    auto rows = [&](const size_t& first, const size_t& last) {
+        std::fill(data + first * N, data + last * N, T{0});
+        for (size_t i = first; i < last; ++i)
+            data[i * N + i] = T{1};
+    };
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        rows(0, N);
+    else
+        ThreadPool::shared().parallelFor(0, N, rowGrain, rows);
+    return m;
+}
+
+// lhs == rhs, ranges stop early once a difference has been found anywhere
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+bool equal(const P& policy, const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
+    const T* x = lhs.data();
+    const T* y = rhs.data();
+    std::atomic<bool> differ{false};
+    detail::forRanges(policy, ROW * COL, [&](const size_t& first, const size_t& last) {
+        if (differ.load(std::memory_order_relaxed))
+            return;
+        if (!std::equal(x + first, x + last, y + first))
+            differ.store(true, std::memory_order_relaxed);
+    });
+    return !differ.load();
+}
+
+// op(... op(op(init, m(0, 0)), m(0, 1)) ...) with the elements regrouped in a fixed tree of ranges,
+// op must be associative; for par and par_unseq it is also applied to partial results of two ranges
+template <execution::Policy P, typename T, size_t ROW, size_t COL, typename U, typename Op>
+U reduce(const P& policy, const Basic_Matrix<T, ROW, COL>& m, U init, Op op) {
+    const T* data = m.data();
+    auto leaf = [&](const size_t& first, const size_t& last) {
+        U res = data[first];
+        for (size_t i = first + 1; i < last; ++i)
+            res = op(res, data[i]);
+        return res;
+    };
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>) {
+        for (size_t i = 0; i < ROW * COL; ++i)
+            init = op(init, data[i]);
+        return init;
+    } else {
+        return op(init, detail::reduceRange<U>(0, ROW * COL, policy.grain, op, leaf));
+    }
+}
+
+// out = in^T by square tiles, out may be in when the matrix is square
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+void transpose(const P& policy, const Basic_Matrix<T, ROW, COL>& in, Basic_Matrix<T, COL, ROW>& out) {
+    constexpr size_t TILE = detail::TRANSPOSE_TILE;
+    const T* x = in.data();
+    T* y = out.data();
+    bool inPlace = false;
+    if constexpr (ROW == COL)
+        inPlace = x == y;
+    // a task takes about grain elements: tile rows of out, or tile rows above the diagonal in place
+    const size_t tiles = (COL + TILE - 1) / TILE;
+    auto run = [&](const size_t& first, const size_t& last) {
+        if (inPlace)
+            detail::transposeInPlace(y, ROW, first, last);
+        else
+            detail::transposeTiles(x, COL, y, ROW, ROW, COL, first, last);
+    };
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        run(0, tiles);
+    else
+        ThreadPool::shared().parallelFor(0, tiles, std::max<size_t>(policy.grain / (TILE * ROW), 1), run);
+}
+
+}
+
+#endif /* Execution_hpp */
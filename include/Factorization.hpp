@@ -0,0 +1,333 @@
+#ifndef Factorization_hpp
+#define Factorization_hpp
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "Structured.hpp"
+#include "Semiring.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace detail {
+
+// both factorizations work on panels of this many columns, everything right of the panel
+// is updated at once by matrix products (level-3) on the kernels of Semiring.hpp instead of
+// one column at a time
+constexpr size_t FACTORIZATION_BLOCK = 48;
+
+// columns of the trailing matrix per task of the QR update, rows per block of the Cholesky update
+constexpr size_t UPDATE_COLUMNS = 256;
+constexpr size_t UPDATE_ROWS = 32;
+
+// in-place lower Cholesky factor of the n x n row-major a, the upper triangle is overwritten
+// right-looking: factor a diagonal block, solve the panel under it, then subtract the panel
+// times its transpose from the trailing lower triangle
+template <typename T>
+void choleskyInPlace(T* a, const size_t& n) {
+    std::vector<T> left, right;
+    for (size_t k0 = 0; k0 < n; k0 += FACTORIZATION_BLOCK) {
+        const size_t k1 = std::min(n, k0 + FACTORIZATION_BLOCK), kb = k1 - k0;
+
+        // diagonal block, row by row with contiguous dot products
+        for (size_t i = k0; i < k1; ++i) {
+            for (size_t j = k0; j <= i; ++j) {
+                T sum = a[i * n + j];
+                for (size_t p = k0; p < j; ++p)
+                    sum -= a[i * n + p] * a[j * n + p];
+                a[i * n + j] = i == j ? checkedSqrt(sum) : sum / a[j * n + j];
+            }
+        }
+        if (k1 == n)
+            break;
+
+        // panel below: every row solves against the transposed diagonal block on its own
+        ThreadPool::shared().parallelFor(k1, n, UPDATE_ROWS, [&](const size_t& first, const size_t& last) {
+            for (size_t i = first; i < last; ++i) {
+                for (size_t j = k0; j < k1; ++j) {
+                    T sum = a[i * n + j];
+                    for (size_t p = k0; p < j; ++p)
+                        sum -= a[i * n + p] * a[j * n + p];
+                    a[i * n + j] = sum / a[j * n + j];
+                }
+            }
+        });
+
+        // trailing matrix -= panel * panel^T, a block of rows stops at its last diagonal entry
+        const size_t rest = n - k1;
+        left.resize(rest * kb);
+        right.resize(kb * rest);
+        for (size_t i = 0; i < rest; ++i) {
+            for (size_t p = 0; p < kb; ++p) {
+                left[i * kb + p] = a[(k1 + i) * n + k0 + p];
+                right[p * rest + i] = left[i * kb + p];
+            }
+        }
+        ThreadPool::shared().parallelFor(0, rest, UPDATE_ROWS, [&](const size_t& first, const size_t& last) {
+            for (size_t i = first; i < last; i += UPDATE_ROWS) {
+                const size_t end = std::min(last, i + UPDATE_ROWS);
+                semiringAccumulate<ProductUpdate<T, true>>(left.data(), kb, right.data(), rest, a + k1 * n + k1, n, i, end, kb, end);
+            }
+        });
+    }
+}
+
+// Householder QR in place for the m x n row-major a with m >= n, as LAPACK geqrf: R on and
+// above the diagonal, the vectors v of the reflectors H = I - tau v v^T below it (v has a
+// unit leading entry that is not stored)
+// a panel is reduced column by column, then the block of its reflectors H = I - Y T Y^T
+// (compact WY form) is applied to the trailing columns by two matrix products
+template <typename T>
+void householderInPlace(T* a, const size_t& m, const size_t& n, T* tau) {
+    using std::sqrt;
+    std::vector<T> w, y, yt, t(FACTORIZATION_BLOCK * FACTORIZATION_BLOCK);
+    for (size_t k0 = 0; k0 < n; k0 += FACTORIZATION_BLOCK) {
+        const size_t k1 = std::min(n, k0 + FACTORIZATION_BLOCK), kb = k1 - k0;
+
+        for (size_t j = k0; j < k1; ++j) {
+            // reflector zeroing a[j + 1 .. m)[j]
+            const T alpha = a[j * n + j];
+            T sigma{};
+            for (size_t i = j + 1; i < m; ++i)
+                sigma += a[i * n + j] * a[i * n + j];
+            if (sigma == T{}) {
+                tau[j] = T{};
+                continue;
+            }
+            const T norm = sqrt(alpha * alpha + sigma);
+            const T beta = alpha < T{} ? norm : -norm;
+            tau[j] = (beta - alpha) / beta;
+            const T scale = T{1} / (alpha - beta);
+            for (size_t i = j + 1; i < m; ++i)
+                a[i * n + j] *= scale;
+            a[j * n + j] = beta;
+
+            // the rest of the panel, w = v^T A then A -= tau v w, both row by row
+            const size_t width = k1 - j - 1;
+            if (width == 0)
+                continue;
+            w.assign(a + j * n + j + 1, a + j * n + k1);
+            for (size_t i = j + 1; i < m; ++i)
+                for (size_t c = 0; c < width; ++c)
+                    w[c] += a[i * n + j] * a[i * n + j + 1 + c];
+            for (size_t c = 0; c < width; ++c)
+                a[j * n + j + 1 + c] -= tau[j] * w[c];
+            for (size_t i = j + 1; i < m; ++i)
+                for (size_t c = 0; c < width; ++c)
+                    a[i * n + j + 1 + c] -= tau[j] * a[i * n + j] * w[c];
+        }
+        if (k1 == n)
+            break;
+
+        // Y, rows k0 .. m of the panel reflectors with their unit entries, and its transpose
+        const size_t height = m - k0;
+        y.assign(height * kb, T{});
+        yt.assign(kb * height, T{});
+        for (size_t i = 0; i < height; ++i) {
+            for (size_t p = 0; p < kb && p <= i; ++p) {
+                y[i * kb + p] = i == p ? T{1} : a[(k0 + i) * n + k0 + p];
+                yt[p * height + i] = y[i * kb + p];
+            }
+        }
+
+        // upper triangular T (LAPACK larft): T[p][p] = tau_p and
+        // T[0 .. p)[p] = -tau_p T[0 .. p)[0 .. p) Y[.][0 .. p)^T y_p
+        for (size_t p = 0; p < kb; ++p) {
+            std::array<T, FACTORIZATION_BLOCK> dots{};
+            for (size_t i = p; i < height; ++i)
+                for (size_t q = 0; q < p; ++q)
+                    dots[q] += y[i * kb + q] * y[i * kb + p];
+            for (size_t q = 0; q < p; ++q) {
+                T sum{};
+                for (size_t r = q; r < p; ++r)
+                    sum += t[q * FACTORIZATION_BLOCK + r] * dots[r];
+                t[q * FACTORIZATION_BLOCK + p] = -tau[k0 + p] * sum;
+            }
+            t[p * FACTORIZATION_BLOCK + p] = tau[k0 + p];
+        }
+
+        // trailing columns C = a[k0 .. m)[k1 .. n): C -= Y (T^T (Y^T C)), columns are independent
+        ThreadPool::shared().parallelFor(0, n - k1, UPDATE_COLUMNS, [&](const size_t& first, const size_t& last) {
+            const size_t width = last - first;
+            T* c = a + k0 * n + k1 + first;
+            std::vector<T> ytc(kb * width, T{}), tytc(kb * width, T{});
+            semiringAccumulate<ProductUpdate<T, false>>(yt.data(), height, c, n, ytc.data(), width, 0, kb, height, width);
+            for (size_t p = 0; p < kb; ++p)
+                for (size_t q = 0; q <= p; ++q)
+                    for (size_t col = 0; col < width; ++col)
+                        tytc[p * width + col] += t[q * FACTORIZATION_BLOCK + p] * ytc[q * width + col];
+            semiringAccumulate<ProductUpdate<T, true>>(y.data(), kb, tytc.data(), width, c, n, 0, height, kb, width);
+        });
+    }
+}
+
+// b = Q^T b for the reflectors of householderInPlace, b is m x k row-major
+template <typename T>
+void applyHouseholderTransposed(const T* a, const size_t& m, const size_t& n, const T* tau, T* b, const size_t& k) {
+    std::vector<T> w(k);
+    for (size_t j = 0; j < n; ++j) {
+        if (tau[j] == T{})
+            continue;
+        std::copy(b + j * k, b + j * k + k, w.begin());
+        for (size_t i = j + 1; i < m; ++i)
+            for (size_t c = 0; c < k; ++c)
+                w[c] += a[i * n + j] * b[i * k + c];
+        for (size_t c = 0; c < k; ++c)
+            b[j * k + c] -= tau[j] * w[c];
+        for (size_t i = j + 1; i < m; ++i)
+            for (size_t c = 0; c < k; ++c)
+                b[i * k + c] -= tau[j] * a[i * n + j] * w[c];
+    }
+}
+
+}
+
+// A = L L^T for a symmetric positive definite A (only its lower triangle is read),
+// blocked right-looking, about n^3 / 3 multiply-adds, half of LU
+template <typename T, size_t N>
+class Cholesky {
+private:
+
+    // L, zero above the diagonal
+    Mat<T, N, N> _factor;
+
+public:
+
+    explicit Cholesky(const Basic_Matrix<T, N, N>& a) {
+        T* l = _factor.data();
+        std::copy(a.data(), a.data() + N * N, l);
+        detail::choleskyInPlace(l, N);
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = i + 1; j < N; ++j)
+                _factor(i, j) = T{};
+    }
+
+    const Mat<T, N, N>& factor() const noexcept {
+        return _factor;
+    }
+
+    // X such that A X = B, forward then back substitution on whole rows of X
+    template <size_t K>
+    Mat<T, N, K> solve(const Basic_Matrix<T, N, K>& b) const {
+        Mat<T, N, K> x;
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t c = 0; c < K; ++c)
+                x(i, c) = b(i, c);
+            for (size_t p = 0; p < i; ++p)
+                for (size_t c = 0; c < K; ++c)
+                    x(i, c) -= _factor(i, p) * x(p, c);
+            for (size_t c = 0; c < K; ++c)
+                x(i, c) /= _factor(i, i);
+        }
+        // L^T x = y: once row i is final it is subtracted from the rows above
+        for (size_t i = N; i-- > 0; ) {
+            for (size_t c = 0; c < K; ++c)
+                x(i, c) /= _factor(i, i);
+            for (size_t p = 0; p < i; ++p)
+                for (size_t c = 0; c < K; ++c)
+                    x(p, c) -= _factor(i, p) * x(i, c);
+        }
+        return x;
+    }
+
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        Mat<T, N, 1> column;
+        for (size_t i = 0; i < N; ++i)
+            column(i, 0) = b(i);
+        Mat<T, N, 1> x = solve(column);
+        Vec<T, N> res;
+        for (size_t i = 0; i < N; ++i)
+            res(i) = x(i, 0);
+        return res;
+    }
+
+    T determinant() const {
+        T res = _factor(0, 0) * _factor(0, 0);
+        for (size_t i = 1; i < N; ++i)
+            res *= _factor(i, i) * _factor(i, i);
+        return res;
+    }
+};
+
+// A = Q R for a ROW x COL matrix with ROW >= COL, blocked Householder
+// solve gives the least squares solution of an overdetermined system of full column rank
+template <typename T, size_t ROW, size_t COL>
+class QR {
+
+    static_assert(ROW >= COL, "QR needs at least as many rows as columns");
+
+private:
+
+    // R and the Householder vectors, see detail::householderInPlace
+    Mat<T, ROW, COL> _factors;
+    std::array<T, COL> _tau{};
+
+public:
+
+    explicit QR(const Basic_Matrix<T, ROW, COL>& a) {
+        std::copy(a.data(), a.data() + ROW * COL, _factors.data());
+        detail::householderInPlace(_factors.data(), ROW, COL, _tau.data());
+    }
+
+    Mat<T, COL, COL> r() const {
+        Mat<T, COL, COL> res;
+        for (size_t i = 0; i < COL; ++i)
+            for (size_t j = i; j < COL; ++j)
+                res(i, j) = _factors(i, j);
+        return res;
+    }
+
+    // the first COL columns of Q
+    Mat<T, ROW, COL> q() const {
+        Mat<T, ROW, ROW> full;
+        for (size_t i = 0; i < ROW; ++i)
+            full(i, i) = T{1};
+        // Q^T I, the transpose of its first COL rows is the thin Q
+        detail::applyHouseholderTransposed(_factors.data(), ROW, COL, _tau.data(), full.data(), ROW);
+        Mat<T, ROW, COL> res;
+        for (size_t i = 0; i < ROW; ++i)
+            for (size_t j = 0; j < COL; ++j)
+                res(i, j) = full(j, i);
+        return res;
+    }
+
+    // X minimizing |A X - B| column by column: R X = (Q^T B) restricted to the first COL rows
+    template <size_t K>
+    Mat<T, COL, K> solve(const Basic_Matrix<T, ROW, K>& b) const {
+        std::vector<T> qb(b.data(), b.data() + ROW * K);
+        detail::applyHouseholderTransposed(_factors.data(), ROW, COL, _tau.data(), qb.data(), K);
+        Mat<T, COL, K> x;
+        for (size_t i = COL; i-- > 0; ) {
+            detail::checkPivot(_factors(i, i) == T{});
+            for (size_t c = 0; c < K; ++c) {
+                T sum = qb[i * K + c];
+                for (size_t j = i + 1; j < COL; ++j)
+                    sum -= _factors(i, j) * x(j, c);
+                x(i, c) = sum / _factors(i, i);
+            }
+        }
+        return x;
+    }
+
+    Vec<T, COL> solve(const Vec<T, ROW>& b) const {
+        Mat<T, ROW, 1> column;
+        for (size_t i = 0; i < ROW; ++i)
+            column(i, 0) = b(i);
+        Mat<T, COL, 1> x = solve(column);
+        Vec<T, COL> res;
+        for (size_t i = 0; i < COL; ++i)
+            res(i) = x(i, 0);
+        return res;
+    }
+};
+
+}
+
+#endif /* Factorization_hpp */
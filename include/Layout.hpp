@@ -0,0 +1,224 @@
+#ifndef Layout_hpp
+#define Layout_hpp
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <optional>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "Matrix.hpp"
+#include "Semiring.hpp"
+#include "Execution.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+// storage layouts of LayoutMat
+//     RowMajor           rows one after the other, as Mat
+//     ColumnMajor        columns one after the other
+//     PaddedRowMajor     rows start on 64-byte boundaries, one cache line more when the stride
+//     PaddedColumnMajor  would be a multiple of 4 KiB (the lines would compete for the same cache sets)
+namespace layout {
+
+enum class Order { row, column };
+
+template <Order ORDER, bool PADDED>
+struct Layout {
+    static constexpr Order order = ORDER;
+    static constexpr bool padded = PADDED;
+
+    // the same elements read as the transposed matrix
+    using Transposed = Layout<ORDER == Order::row ? Order::column : Order::row, PADDED>;
+};
+
+using RowMajor = Layout<Order::row, false>;
+using ColumnMajor = Layout<Order::column, false>;
+using PaddedRowMajor = Layout<Order::row, true>;
+using PaddedColumnMajor = Layout<Order::column, true>;
+
+}
+
+namespace detail {
+
+// every LayoutMat starts on a cache line
+inline constexpr size_t LAYOUT_ALIGNMENT = 64;
+
+// strides of padded layouts avoid multiples of this
+inline constexpr size_t LAYOUT_CRITICAL_STRIDE = 4096;
+
+template <typename T>
+struct AlignedAllocator {
+    using value_type = T;
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    constexpr AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(const size_t& n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{LAYOUT_ALIGNMENT}));
+    }
+
+    void deallocate(T* ptr, const size_t&) noexcept {
+        ::operator delete(ptr, std::align_val_t{LAYOUT_ALIGNMENT});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+// elements between the starts of two lines of length elements
+template <typename T, typename L>
+constexpr size_t leadingDimension(const size_t& length, const size_t& lines) noexcept {
+    if constexpr (!L::padded) {
+        return length;
+    } else {
+        constexpr size_t LINE = LAYOUT_ALIGNMENT / sizeof(T);
+        size_t res = (length + LINE - 1) / LINE * LINE;
+        if (lines > 1 && res > 0 && res * sizeof(T) % LAYOUT_CRITICAL_STRIDE == 0)
+            res += LINE;
+        return res;
+    }
+}
+
+// out = in for a rows x cols matrix stored by rows or by columns on either side, in one pass:
+// lines copied when the orders match, a tiled transpose otherwise, split on the shared pool
+template <typename T>
+void relayout(const T* in, const size_t& ldIn, const bool& inByRows, T* out, const size_t& ldOut, const bool& outByRows, const size_t& rows, const size_t& cols) {
+    constexpr size_t TILE = TRANSPOSE_TILE;
+    // in read as a row-major matrix of lines x length
+    const size_t lines = inByRows ? rows : cols, length = inByRows ? cols : rows;
+    if (lines == 0 || length == 0)
+        return;
+    if (inByRows == outByRows) {
+        ThreadPool::shared().parallelFor(0, lines, std::max<size_t>(execution::DEFAULT_GRAIN / length, 1), [&](const size_t& first, const size_t& last) {
+            for (size_t i = first; i < last; ++i)
+                std::copy(in + i * ldIn, in + i * ldIn + length, out + i * ldOut);
+        });
+    } else {
+        const size_t tiles = (length + TILE - 1) / TILE;
+        ThreadPool::shared().parallelFor(0, tiles, std::max<size_t>(execution::DEFAULT_GRAIN / (TILE * lines), 1), [&](const size_t& first, const size_t& last) {
+            transposeTiles(in, ldIn, out, ldOut, lines, length, first, last);
+        });
+    }
+}
+
+}
+
+// ROW x COL matrix on the heap in layout L (see layout above), 64-byte aligned
+// the padding elements are T{} and never read; Mat and the other layouts convert to and from it
+// in one blocked pass, so an algorithm can take its operands in the layout it reads sequentially
+template <typename T, size_t ROW, size_t COL, typename L = layout::RowMajor>
+class LayoutMat final {
+private:
+    static_assert(!L::padded || detail::LAYOUT_ALIGNMENT % sizeof(T) == 0, "Padded layouts need elements dividing a cache line");
+
+    static constexpr bool BY_ROWS = L::order == layout::Order::row;
+    static constexpr size_t LINES = BY_ROWS ? ROW : COL;
+    static constexpr size_t LD = detail::leadingDimension<T, L>(BY_ROWS ? COL : ROW, LINES);
+
+    std::vector<T, detail::AlignedAllocator<T>> _data;
+
+    template <typename U, size_t R, size_t C, typename M>
+    friend class LayoutMat;
+
+    explicit LayoutMat(std::vector<T, detail::AlignedAllocator<T>>&& data) noexcept : _data { std::move(data) } {}
+
+public:
+    using Layout = L;
+
+    LayoutMat() : _data(LINES * LD) {}
+
+    explicit LayoutMat(const Basic_Matrix<T, ROW, COL>& m) : LayoutMat() {
+        detail::relayout(m.data(), COL, true, _data.data(), LD, BY_ROWS, ROW, COL);
+    }
+
+    template <typename M>
+    explicit LayoutMat(const LayoutMat<T, ROW, COL, M>& m) : LayoutMat() {
+        detail::relayout(m.data(), m.leadingDimension(), LayoutMat<T, ROW, COL, M>::BY_ROWS, _data.data(), LD, BY_ROWS, ROW, COL);
+    }
+
+    // elements between the starts of two rows (two columns for column-major layouts)
+    static constexpr size_t leadingDimension() noexcept {
+        return LD;
+    }
+
+    T* data() noexcept {
+        return _data.data();
+    }
+
+    const T* data() const noexcept {
+        return _data.data();
+    }
+
+    T& operator() (const size_t& row, const size_t& col) noexcept {
+        return BY_ROWS ? _data[row * LD + col] : _data[col * LD + row];
+    }
+
+    const T& operator() (const size_t& row, const size_t& col) const noexcept {
+        return BY_ROWS ? _data[row * LD + col] : _data[col * LD + row];
+    }
+
+    // out = this, back to the row-major Mat
+    void store(Basic_Matrix<T, ROW, COL>& out) const {
+        detail::relayout(_data.data(), LD, BY_ROWS, out.data(), COL, true, ROW, COL);
+    }
+
+    // the transpose without moving an element: the storage is taken over in the other order
+    LayoutMat<T, COL, ROW, typename L::Transposed> transpose() && noexcept {
+        return LayoutMat<T, COL, ROW, typename L::Transposed>(std::move(_data));
+    }
+};
+
+namespace detail {
+
+// data of m in the order ORDER, through a copy with the padding of L when m is in the other one
+// (padded layouts only take elements dividing a cache line, an unpadded operand may hold others)
+template <layout::Order ORDER, typename T, size_t ROW, size_t COL, typename L>
+const T* orderedData(const LayoutMat<T, ROW, COL, L>& m, std::optional<LayoutMat<T, ROW, COL, layout::Layout<ORDER, L::padded>>>& copy, size_t& ld) {
+    if constexpr (L::order == ORDER) {
+        ld = m.leadingDimension();
+        return m.data();
+    } else {
+        copy.emplace(m);
+        ld = copy->leadingDimension();
+        return copy->data();
+    }
+}
+
+}
+
+// out = lhs * rhs over a semiring for any layouts, out may be lhs or rhs
+// the kernel runs in the order of out: operands in the other order are converted first, so the
+// product costs one extra pass over them; a column-major product is the row-major out^T = rhs^T lhs^T
+template <typename T, size_t ROW, size_t COL, size_t U, typename L1, typename L2, typename L3, Semiring S = PlusTimes<T>>
+void multiply(const LayoutMat<T, ROW, COL, L1>& lhs, const LayoutMat<T, COL, U, L2>& rhs, LayoutMat<T, ROW, U, L3>& out, const S& semiring = S{}) {
+    static_assert(std::is_same_v<typename S::Element, T>, "Semiring must be over the matrix elements");
+    using K = std::conditional_t<std::is_same_v<S, PlusTimes<T>>, detail::ProductUpdate<T, false>, S>;
+    constexpr layout::Order ORDER = L3::order;
+
+    if (static_cast<const void*>(&out) == &lhs || static_cast<const void*>(&out) == &rhs) {
+        LayoutMat<T, ROW, U, L3> res;
+        multiply(lhs, rhs, res, semiring);
+        out = std::move(res);
+        return;
+    }
+
+    std::optional<LayoutMat<T, ROW, COL, layout::Layout<ORDER, L1::padded>>> lhsCopy;
+    std::optional<LayoutMat<T, COL, U, layout::Layout<ORDER, L2::padded>>> rhsCopy;
+    size_t lda = 0, ldb = 0;
+    const T* a = detail::orderedData<ORDER>(lhs, lhsCopy, lda);
+    const T* b = detail::orderedData<ORDER>(rhs, rhsCopy, ldb);
+    if constexpr (ORDER == layout::Order::row)
+        detail::semiringMultiply<K>(a, lda, b, ldb, out.data(), out.leadingDimension(), ROW, COL, U);
+    else
+        detail::semiringMultiply<K>(b, ldb, a, lda, out.data(), out.leadingDimension(), U, COL, ROW);
+}
+
+}
+
+#endif /* Layout_hpp */
@@ -2,7 +2,8 @@
 #define Matrix_hpp
 
 #include <iostream>
-#include <functional>
+#include <type_traits>
+#include <concepts>
 #include <array>
 #include <cstddef>
 #include <cassert>
@@ -10,6 +11,9 @@
 #include <bit>
 #include <algorithm>
 #include <stdexcept>
+#include <memory>
+#include "MatrixKernel.hpp"
+#include "Semiring.hpp"
 
 namespace vecxify {
 
@@ -30,11 +34,11 @@ namespace vecxify {
      
      // apply mapping to each element in the Basic_Matrix
      // func := (row index, col index, current element) -> T
-     // if using lambda function with mutable variable as the argument of this mapping function
-     // wrap it in a reference wrapper, use std::ref
-     Basic_Matrix<T, ROW, COL> map(const std::function<T(const size_t&, const size_t&, const T&)>& func);
+     template <typename F>
+     constexpr Basic_Matrix<T, ROW, COL> map(F&& func);
      
-     Basic_Matrix<T, ROW, COL> consume(const std::function<void(const size_t&, const size_t&, const T&)>& func) const;
+     template <typename F>
+     constexpr Basic_Matrix<T, ROW, COL> consume(F&& func) const;
  
      // return a Matrix same as the current Matrix but its size
      // is scaled to the required size, extra element are filled with 0
@@ -49,6 +53,8 @@ namespace vecxify {
      
      Basic_Matrix();
      
+     explicit Basic_Matrix(Uninitialized);
+     
      Basic_Matrix(const std::initializer_list<std::initializer_list<T>>& m);
      
      Basic_Matrix(const Basic_Matrix<T, ROW, COL>& m);
@@ -77,6 +83,11 @@ namespace vecxify {
      
      const T& at(const size_t& row, const size_t& col) const;
      
+     // the elements as one row-major array of ROW * COL
+     T* data() noexcept;
+     
+     const T* data() const noexcept;
+     
      Basic_Matrix<T, ROW, COL>& operator=(const Basic_Matrix<T, ROW, COL>& rhs);
      
      template <size_t U>
@@ -107,6 +118,12 @@ namespace vecxify {
 template <typename T, size_t ROW, size_t COL>
 class Basic_Matrix;
 
+// tag of the constructors that skip the initialization of the elements, their memory stays
+// untouched until the first write (see allocate in Execution.hpp)
+struct Uninitialized {};
+
+inline constexpr Uninitialized uninitialized{};
+
 template <typename T, size_t ROW, size_t COL>
 class Mat;
 
@@ -115,34 +132,34 @@ template <typename T, size_t N>
 class Mat<T, N, N>;
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator*(const Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
+constexpr Basic_Matrix<T, ROW, COL> operator*(const Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator*(const T& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
+constexpr Basic_Matrix<T, ROW, COL> operator*(const T& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator+(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
+constexpr Basic_Matrix<T, ROW, COL> operator+(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator-(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
+constexpr Basic_Matrix<T, ROW, COL> operator-(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL>& operator+=(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
+constexpr Basic_Matrix<T, ROW, COL>& operator+=(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL>& operator-=(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
+constexpr Basic_Matrix<T, ROW, COL>& operator-=(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
+constexpr Basic_Matrix<T, ROW, COL>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
 
 template <typename T, size_t ROW, size_t COL, size_t N>
-Basic_Matrix<T, ROW, N>& operator*=(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, COL, N>& rhs);
+constexpr Basic_Matrix<T, ROW, N>& operator*=(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, COL, N>& rhs);
 
 template <typename T1, size_t R1, size_t C1, typename T2, size_t R2, size_t C2>
-bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
+constexpr bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
 
 template <typename T1, size_t R1, size_t C1, typename T2, size_t R2, size_t C2>
-bool operator!=(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
+constexpr bool operator!=(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
 
 template <typename T, size_t ROW, size_t COL>
 std::ostream& operator<< (std::ostream& out, const Basic_Matrix<T, ROW, COL>& rhs);
@@ -157,7 +174,7 @@ private:
     // multiplication for strassen algorithms
     // both matrix has to be power of 2
     template <size_t N>
-    static Basic_Matrix<T, N, N> multiply(const Basic_Matrix<T, N, N>& lhs, const Basic_Matrix<T, N, N>& rhs) {
+    constexpr static Basic_Matrix<T, N, N> multiply(const Basic_Matrix<T, N, N>& lhs, const Basic_Matrix<T, N, N>& rhs) {
         static_assert(std::popcount(N) == 1);
         Basic_Matrix<T, N, N> res;
         
@@ -199,14 +216,18 @@ private:
     }
     
 protected:
+    // matrices up to this size in every dimension have unrolled kernels
+    static constexpr size_t SMALL_DIMENSION = 4;
+    
     // store the element of the Basic_Matrix
-    std::array<std::array<T, COL>, ROW> _data{};
+    // every constructor but the Uninitialized one value-initializes or copies it
+    std::array<std::array<T, COL>, ROW> _data;
     
     // apply mapping to each element in the Basic_Matrix
     // func := (row index, col index, current element) -> T
-    // if using lambda function with mutable variable as the argument of this mapping function
-    // wrap it in a reference wrapper, use std::ref
-    Basic_Matrix<T, ROW, COL> map(const std::function<T(const size_t&, const size_t&, const T&)>& func) {
+    // func is taken by reference, a lambda with mutable state keeps it across elements
+    template <typename F>
+    constexpr Basic_Matrix<T, ROW, COL> map(F&& func) {
         for (size_t row = 0; row < ROW; ++row) {
             for (size_t col = 0; col < COL; ++col) {
                 _data[row][col] = func(row, col, _data[row][col]);
@@ -215,7 +236,8 @@ protected:
         return *this;
     }
     
-    Basic_Matrix<T, ROW, COL> consume(const std::function<void(const size_t&, const size_t&, const T&)>& func) const {
+    template <typename F>
+    constexpr Basic_Matrix<T, ROW, COL> consume(F&& func) const {
         for (size_t row = 0; row < ROW; ++row) {
             for (size_t col = 0; col < COL; ++col) {
                 func(row, col, _data[row][col]);
@@ -227,11 +249,11 @@ protected:
     // return a Matrix same as the current Matrix but its size
     // is scaled to the required size, extra element are filled with 0
     template <size_t N, size_t M>
-    Basic_Matrix<T, N, M> scaleMatrix() const {
+    constexpr Basic_Matrix<T, N, M> scaleMatrix() const {
         static_assert(N > 0 && M > 0);
         Mat<T, N, M> res{};
         res.map(
-                [&](const size_t& row, const size_t& col, const size_t& element) -> T{
+                [&](const size_t& row, const size_t& col, const T& element) -> T{
                     if (row >= ROW || col >= COL)
                         return 0;
                     else return operator()(row, col);
@@ -240,9 +262,30 @@ protected:
         return res;
     }
     
+    // product of matrices of at most SMALL_DIMENSION x SMALL_DIMENSION without padding or recursion:
+    // every loop is unrolled and a row of the result is a sum of scaled rows of rhs,
+    // which vectorizes across the row
+    template <size_t N>
+    constexpr Basic_Matrix<T, ROW, N> smallMultiply(const Basic_Matrix<T, COL, N>& rhs) const {
+        Basic_Matrix<T, ROW, N> res;
+#pragma GCC unroll 4
+        for (size_t i = 0; i < ROW; ++i) {
+#pragma GCC unroll 4
+            for (size_t j = 0; j < N; ++j)
+                res._data[i][j] = _data[i][0] * rhs._data[0][j];
+#pragma GCC unroll 4
+            for (size_t p = 1; p < COL; ++p) {
+#pragma GCC unroll 4
+                for (size_t j = 0; j < N; ++j)
+                    res._data[i][j] += _data[i][p] * rhs._data[p][j];
+            }
+        }
+        return res;
+    }
+    
     // strassen algorithm for matrix multiplication
     template <size_t N>
-    Basic_Matrix<T, ROW, N> strassenMultiply(const Basic_Matrix<T, COL, N>& rhs) const {
+    constexpr Basic_Matrix<T, ROW, N> strassenMultiply(const Basic_Matrix<T, COL, N>& rhs) const {
         constexpr size_t dim = std::max(std::bit_ceil(ROW), std::max(std::bit_ceil(COL), std::bit_ceil(N)));
         // scale the matrix to the closest power of 2
         auto scaledLhs = scaleMatrix<dim, dim>();
@@ -251,15 +294,12 @@ protected:
         return res.template scaleMatrix<ROW, N>();
     }
     
-    Basic_Matrix() {
-        map(
-            [&](const size_t& row, const size_t& col, const T& element) -> T {
-                return T{};
-            }
-        );
-    }
+    constexpr Basic_Matrix() : _data{} {}
+    
+    // elements are default-initialized, left indeterminate for arithmetic types
+    constexpr explicit Basic_Matrix(Uninitialized) {}
     
-    Basic_Matrix(const std::initializer_list<std::initializer_list<T>>& m) {
+    constexpr Basic_Matrix(const std::initializer_list<std::initializer_list<T>>& m) : _data{} {
         if (m.size() != ROW)
             throw std::invalid_argument("Row number must match");
         
@@ -274,12 +314,12 @@ protected:
         }
     }
     
-    explicit Basic_Matrix(const std::array<std::array<T, COL>, ROW>& m) : _data{ m } {}
+    constexpr explicit Basic_Matrix(const std::array<std::array<T, COL>, ROW>& m) : _data{ m } {}
     
 public:
     
     // set all element in the Basic_Matrix to be val
-    void set(T val) {
+    constexpr void set(T val) {
         map(
             [&](const size_t& row, const size_t& col, const T& element) -> T {
                 return val;
@@ -287,7 +327,7 @@ public:
         );
     }
     
-    Basic_Matrix<T, COL, ROW> transpose() const {
+    constexpr Basic_Matrix<T, COL, ROW> transpose() const {
         Basic_Matrix<T, COL, ROW> res;
         res.map(
                 [&](const size_t& row, const size_t& col, const T& element) -> T {
@@ -299,7 +339,7 @@ public:
     
     // return a submatrix
     template <size_t R, size_t C>
-    Basic_Matrix<T, R, C> submat(const size_t& row, const size_t& col) const {
+    constexpr Basic_Matrix<T, R, C> submat(const size_t& row, const size_t& col) const {
         if (!(row + R <= ROW && col + C <= COL))
             throw std::out_of_range("Submatrix out-of-range");
             
@@ -312,7 +352,7 @@ public:
         return res;
     }
     
-    bool isSquareMatrix() const noexcept {
+    constexpr bool isSquareMatrix() const noexcept {
         if constexpr (ROW == COL) {
             return true;
         } else {
@@ -320,43 +360,67 @@ public:
         }
     }
     
-    T& operator() (const size_t& row, const size_t& col) noexcept {
+    constexpr T& operator() (const size_t& row, const size_t& col) noexcept {
         assert(row < ROW && row >= 0 && col < COL && col >= 0 && "Matrix index out of range");
         return _data[row][col];
     }
     
-    const T& operator() (const size_t& row, const size_t& col) const noexcept {
+    constexpr const T& operator() (const size_t& row, const size_t& col) const noexcept {
         assert(row < ROW && row >= 0 && col < COL && col >= 0 && "Matrix index out of range");
         return _data[row][col];
     }
     
-    T& at(const size_t& row, const size_t& col) {
+    constexpr T& at(const size_t& row, const size_t& col) {
         if (!(row < ROW && row >= 0 && col < COL && col >= 0))
             throw std::out_of_range("Matrix index out-of-range");
         return _data[row][col];
     }
     
-    const T& at(const size_t& row, const size_t& col) const {
+    constexpr const T& at(const size_t& row, const size_t& col) const {
         if (!(row < ROW && row >= 0 && col < COL && col >= 0))
             throw std::out_of_range("Matrix index out-of-range");
         return _data[row][col];
     }
     
-    Basic_Matrix<T, ROW, COL>& operator=(const Basic_Matrix<T, ROW, COL>& rhs) {
+    // the elements as one row-major array of ROW * COL, for kernels working on raw memory
+    // the rows are std::arrays stored back to back without padding, so the whole of _data is
+    // addressed as one array rather than indexing past the end of its first row
+    T* data() noexcept {
+        static_assert(sizeof(_data) == sizeof(T) * ROW * COL, "Rows must be contiguous");
+        return reinterpret_cast<T*>(&_data);
+    }
+    
+    const T* data() const noexcept {
+        static_assert(sizeof(_data) == sizeof(T) * ROW * COL, "Rows must be contiguous");
+        return reinterpret_cast<const T*>(&_data);
+    }
+    
+    constexpr Basic_Matrix<T, ROW, COL>& operator=(const Basic_Matrix<T, ROW, COL>& rhs) {
         _data = rhs._data;
         return *this;
     }
     
     template <size_t U>
-    Basic_Matrix<T, ROW, U> operator*(const Basic_Matrix<T, COL, U>& rhs) const {
+    constexpr Basic_Matrix<T, ROW, U> operator*(const Basic_Matrix<T, COL, U>& rhs) const {
+        if constexpr (ROW <= SMALL_DIMENSION && COL <= SMALL_DIMENSION && U <= SMALL_DIMENSION) {
+            return smallMultiply(rhs);
+        } else if constexpr (MatrixKernel<T>::enabled) {
+            // the kernels work on raw memory, constant evaluation takes the generic path
+            if (!std::is_constant_evaluated()) {
+                Basic_Matrix<T, ROW, U> res;
+                MatrixKernel<T>::multiply(data(), rhs.data(), res.data(), ROW, COL, U);
+                return res;
+            }
+        }
         return strassenMultiply(rhs);
     }
     
     template<typename U, size_t R, size_t C>
     friend class Basic_Matrix;
     
-    friend Basic_Matrix<T, ROW, COL> operator* <>(const Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
-    friend Basic_Matrix<T, ROW, COL> operator* <>(const T& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
+    // qualified, an unqualified operator* <> would find the member template above
+    friend Basic_Matrix<T, ROW, COL> vecxify::operator* <>(const Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
+    friend Basic_Matrix<T, ROW, COL> vecxify::operator* <>(const T& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
     friend Basic_Matrix<T, ROW, COL> operator+ <>(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
     friend Basic_Matrix<T, ROW, COL> operator- <>(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
     friend Basic_Matrix<T, ROW, COL>& operator+= <>(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs);
@@ -364,10 +428,10 @@ public:
     friend Basic_Matrix<T, ROW, COL>& operator*= <>(Basic_Matrix<T, ROW, COL>& lhs, const T& rhs);
     
     template <typename T1, size_t R1, size_t C1, typename T2, size_t R2, size_t C2>
-    friend bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
+    friend constexpr bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
     
     template <typename T1, size_t R1, size_t C1, typename T2, size_t R2, size_t C2>
-    friend bool operator!=(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
+    friend constexpr bool operator!=(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs);
     
     friend std::ostream& operator<< <T, ROW, COL>(std::ostream& out, const Basic_Matrix<T, ROW, COL>& rhs);
     
@@ -378,27 +442,131 @@ class Mat : public Basic_Matrix<T, R, C> {
 private:
     
 public:
-    Mat() : Basic_Matrix<T, R, C>(){}
+    constexpr Mat() : Basic_Matrix<T, R, C>(){}
+    
+    constexpr explicit Mat(Uninitialized tag) : Basic_Matrix<T, R, C>(tag) {}
     
-    Mat(const std::initializer_list<std::initializer_list<T>>& m) : Basic_Matrix<T, R, C>(m) {}
+    constexpr Mat(const std::initializer_list<std::initializer_list<T>>& m) : Basic_Matrix<T, R, C>(m) {}
     
-    explicit Mat(const std::array<std::array<T, C>, R>& m) : Basic_Matrix<T, R, C>(m) {}
+    constexpr explicit Mat(const std::array<std::array<T, C>, R>& m) : Basic_Matrix<T, R, C>(m) {}
     
 };
 
+namespace detail {
+
+// partial pivoting keeps the entry of largest magnitude for floating point types,
+// exact types (ModNum, BigInt, ...) only need a nonzero one
+template <typename T>
+constexpr bool betterPivot(const T& candidate, const T& current) {
+    if constexpr (std::is_floating_point_v<T>)
+        return (candidate < T{} ? -candidate : candidate) > (current < T{} ? -current : current);
+    else
+        return current == T{} && candidate != T{};
+}
+
+// elements with a reciprocal: floating point types and field elements with inv() (ModNum, ...)
+// integers would truncate 1 / x to 0 or +-1, so they are left out
+template <typename T>
+concept Invertible = std::is_floating_point_v<T> || requires (const T& x) { { x.inv() } -> std::convertible_to<T>; };
+
+// x^-1, one inversion for field elements
+template <Invertible T>
+constexpr T reciprocal(const T& x) {
+    if constexpr (requires { x.inv(); })
+        return x.inv();
+    else
+        return T{1} / x;
+}
+
+}
+
 template <typename T, size_t N>
 class Mat<T, N, N> : public Basic_Matrix<T, N, N> {
 private:
+    
+    using Basic_Matrix<T, N, N>::SMALL_DIMENSION;
+    
+    // closed-form cofactor expansion for N <= SMALL_DIMENSION: the adjugate goes to adj unless it is null,
+    // the determinant is returned
+    // the 4 x 4 form shares the 2 x 2 minors of the top two rows (s) and of the bottom two rows (c)
+    constexpr T adjugate(Mat<T, N, N>* adj) const {
+        static_assert(N <= SMALL_DIMENSION);
+        const Mat<T, N, N>& a = *this;
+        if constexpr (N == 1) {
+            if (adj)
+                (*adj)(0, 0) = T{1};
+            return a(0, 0);
+        } else if constexpr (N == 2) {
+            if (adj) {
+                Mat<T, N, N>& b = *adj;
+                b(0, 0) = a(1, 1), b(0, 1) = -a(0, 1);
+                b(1, 0) = -a(1, 0), b(1, 1) = a(0, 0);
+            }
+            return a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+        } else if constexpr (N == 3) {
+            const T c00 = a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1);
+            const T c10 = a(1, 2) * a(2, 0) - a(1, 0) * a(2, 2);
+            const T c20 = a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0);
+            if (adj) {
+                Mat<T, N, N>& b = *adj;
+                b(0, 0) = c00;
+                b(0, 1) = a(0, 2) * a(2, 1) - a(0, 1) * a(2, 2);
+                b(0, 2) = a(0, 1) * a(1, 2) - a(0, 2) * a(1, 1);
+                b(1, 0) = c10;
+                b(1, 1) = a(0, 0) * a(2, 2) - a(0, 2) * a(2, 0);
+                b(1, 2) = a(0, 2) * a(1, 0) - a(0, 0) * a(1, 2);
+                b(2, 0) = c20;
+                b(2, 1) = a(0, 1) * a(2, 0) - a(0, 0) * a(2, 1);
+                b(2, 2) = a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+            }
+            return a(0, 0) * c00 + a(0, 1) * c10 + a(0, 2) * c20;
+        } else {
+            const T s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1);
+            const T s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2);
+            const T s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3);
+            const T s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2);
+            const T s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3);
+            const T s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3);
+            const T c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+            const T c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2);
+            const T c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3);
+            const T c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2);
+            const T c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3);
+            const T c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3);
+            if (adj) {
+                Mat<T, N, N>& b = *adj;
+                b(0, 0) = a(1, 1) * c5 - a(1, 2) * c4 + a(1, 3) * c3;
+                b(0, 1) = a(0, 2) * c4 - a(0, 1) * c5 - a(0, 3) * c3;
+                b(0, 2) = a(3, 1) * s5 - a(3, 2) * s4 + a(3, 3) * s3;
+                b(0, 3) = a(2, 2) * s4 - a(2, 1) * s5 - a(2, 3) * s3;
+                b(1, 0) = a(1, 2) * c2 - a(1, 0) * c5 - a(1, 3) * c1;
+                b(1, 1) = a(0, 0) * c5 - a(0, 2) * c2 + a(0, 3) * c1;
+                b(1, 2) = a(3, 2) * s2 - a(3, 0) * s5 - a(3, 3) * s1;
+                b(1, 3) = a(2, 0) * s5 - a(2, 2) * s2 + a(2, 3) * s1;
+                b(2, 0) = a(1, 0) * c4 - a(1, 1) * c2 + a(1, 3) * c0;
+                b(2, 1) = a(0, 1) * c2 - a(0, 0) * c4 - a(0, 3) * c0;
+                b(2, 2) = a(3, 0) * s4 - a(3, 1) * s2 + a(3, 3) * s0;
+                b(2, 3) = a(2, 1) * s2 - a(2, 0) * s4 - a(2, 3) * s0;
+                b(3, 0) = a(1, 1) * c1 - a(1, 0) * c3 - a(1, 2) * c0;
+                b(3, 1) = a(0, 0) * c3 - a(0, 1) * c1 + a(0, 2) * c0;
+                b(3, 2) = a(3, 1) * s1 - a(3, 0) * s3 - a(3, 2) * s0;
+                b(3, 3) = a(2, 0) * s3 - a(2, 1) * s1 + a(2, 2) * s0;
+            }
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        }
+    }
 
 public:
     
-    Mat() : Basic_Matrix<T, N, N>(){}
+    constexpr Mat() : Basic_Matrix<T, N, N>(){}
     
-    Mat(const std::initializer_list<std::initializer_list<T>>& m) : Basic_Matrix<T, N, N>(m) {}
+    constexpr explicit Mat(Uninitialized tag) : Basic_Matrix<T, N, N>(tag) {}
     
-    explicit Mat(const std::array<std::array<T, N>, N>& m) : Basic_Matrix<T, N, N>(m) {}
+    constexpr Mat(const std::initializer_list<std::initializer_list<T>>& m) : Basic_Matrix<T, N, N>(m) {}
     
-    Mat<T, N, N>& identity() {
+    constexpr explicit Mat(const std::array<std::array<T, N>, N>& m) : Basic_Matrix<T, N, N>(m) {}
+    
+    constexpr Mat<T, N, N>& identity() {
         Basic_Matrix<T, N, N>::map(
             [&](const size_t& row, const size_t& col, const T& element) -> T {
                 if (row == col) return 1;
@@ -408,7 +576,10 @@ public:
         return *this;
     }
     
-    T determinant() const {
+    constexpr T determinant() const {
+        if constexpr (N <= SMALL_DIMENSION)
+            return adjugate(nullptr);
+        
         auto copy = *this;
         T res{1};
         
@@ -424,27 +595,80 @@ public:
             // make sure copy(row, col) are non-zero
             if (copy(i, i) == T{0}) {
                 size_t next = i + 1;
-                while(next < N && copy(next, i) == 0)
+                while(next < N && copy(next, i) == T{0})
                     next++;
                 if (next == N) // all entry below current row are zero, hence the determinant is zero
                     return T{0};
-                else
+                else {
+                    // a row swap flips the sign of the determinant
                     std::swap(copy._data[i], copy._data[next]);
+                    res = -res;
+                }
             }
             
-            for (size_t j = i + 1; j < N; ++j) {
-                eliminate(i, j, -copy(j, i) / copy(i, i));
+            if constexpr (requires (const T& x) { x.inv(); }) {
+                // field elements: one inversion per pivot instead of one division per row
+                const T pivotInverse = copy(i, i).inv();
+                for (size_t j = i + 1; j < N; ++j) {
+                    eliminate(i, j, -copy(j, i) * pivotInverse);
+                }
+            } else {
+                for (size_t j = i + 1; j < N; ++j) {
+                    eliminate(i, j, -copy(j, i) / copy(i, i));
+                }
             }
             
             res *= copy(i, i);
         }
         return res;
     }
+    
+    // inverse over a field or of a floating-point matrix, throws std::domain_error when it is singular
+    // adjugate over determinant up to SMALL_DIMENSION, Gauss-Jordan elimination beyond
+    constexpr Mat<T, N, N> inverse() const requires detail::Invertible<T> {
+        Mat<T, N, N> res;
+        if constexpr (N <= SMALL_DIMENSION) {
+            const T det = adjugate(&res);
+            if (det == T{})
+                throw std::domain_error("Matrix is singular");
+            res *= detail::reciprocal(det);
+        } else {
+            auto copy = *this;
+            res.identity();
+            for (size_t i = 0; i < N; ++i) {
+                size_t pivot = i;
+                for (size_t row = i + 1; row < N; ++row) {
+                    if (detail::betterPivot(copy(row, i), copy(pivot, i)))
+                        pivot = row;
+                }
+                if (copy(pivot, i) == T{})
+                    throw std::domain_error("Matrix is singular");
+                std::swap(copy._data[i], copy._data[pivot]);
+                std::swap(res._data[i], res._data[pivot]);
+                
+                const T scale = detail::reciprocal(copy(i, i));
+                for (size_t col = 0; col < N; ++col) {
+                    copy(i, col) *= scale;
+                    res(i, col) *= scale;
+                }
+                for (size_t row = 0; row < N; ++row) {
+                    const T multiply = copy(row, i);
+                    if (row == i || multiply == T{})
+                        continue;
+                    for (size_t col = 0; col < N; ++col) {
+                        copy(row, col) -= multiply * copy(i, col);
+                        res(row, col) -= multiply * res(i, col);
+                    }
+                }
+            }
+        }
+        return res;
+    }
   
 };
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator* (const Basic_Matrix<T, ROW, COL>& lhs, const T& rhs) {
+constexpr Basic_Matrix<T, ROW, COL> operator* (const Basic_Matrix<T, ROW, COL>& lhs, const T& rhs) {
     Basic_Matrix<T, ROW, COL> res;
     res.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
@@ -455,7 +679,7 @@ Basic_Matrix<T, ROW, COL> operator* (const Basic_Matrix<T, ROW, COL>& lhs, const
 }
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator* (const T& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
+constexpr Basic_Matrix<T, ROW, COL> operator* (const T& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
     Basic_Matrix<T, ROW, COL> res;
     res.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
@@ -466,7 +690,7 @@ Basic_Matrix<T, ROW, COL> operator* (const T& lhs, const Basic_Matrix<T, ROW, CO
 }
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator+ (const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
+constexpr Basic_Matrix<T, ROW, COL> operator+ (const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
     Basic_Matrix<T, ROW, COL> res;
     res.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
@@ -477,7 +701,7 @@ Basic_Matrix<T, ROW, COL> operator+ (const Basic_Matrix<T, ROW, COL>& lhs, const
 }
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL> operator- (const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
+constexpr Basic_Matrix<T, ROW, COL> operator- (const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
     Basic_Matrix<T, ROW, COL> res;
     res.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
@@ -488,7 +712,7 @@ Basic_Matrix<T, ROW, COL> operator- (const Basic_Matrix<T, ROW, COL>& lhs, const
 }
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL>& operator+= (Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
+constexpr Basic_Matrix<T, ROW, COL>& operator+= (Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
     lhs.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
             return element + rhs(row, col);
@@ -498,7 +722,7 @@ Basic_Matrix<T, ROW, COL>& operator+= (Basic_Matrix<T, ROW, COL>& lhs, const Bas
 }
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL>& operator-= (Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
+constexpr Basic_Matrix<T, ROW, COL>& operator-= (Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, ROW, COL>& rhs) {
     lhs.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
             return element - rhs(row, col);
@@ -508,7 +732,7 @@ Basic_Matrix<T, ROW, COL>& operator-= (Basic_Matrix<T, ROW, COL>& lhs, const Bas
 }
 
 template <typename T, size_t ROW, size_t COL>
-Basic_Matrix<T, ROW, COL>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const T& rhs) {
+constexpr Basic_Matrix<T, ROW, COL>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const T& rhs) {
     lhs.map(
         [&](const size_t& row, const size_t& col, const T& element) -> T {
             return element * rhs;
@@ -518,12 +742,12 @@ Basic_Matrix<T, ROW, COL>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const T& r
 }
 
 template <typename T, size_t ROW, size_t COL, size_t N>
-Basic_Matrix<T, ROW, N>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, COL, N>& rhs) {
+constexpr Basic_Matrix<T, ROW, N>& operator*=(Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, COL, N>& rhs) {
     return lhs = lhs*rhs;
 }
 
 template <typename T1, size_t R1, size_t C1, typename T2, size_t R2, size_t C2>
-bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs) {
+constexpr bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs) {
     if constexpr (R1 != R2 || C1 != C2) {
         return false;
     } else {
@@ -537,7 +761,7 @@ bool operator==(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2,
 }
 
 template <typename T1, size_t R1, size_t C1, typename T2, size_t R2, size_t C2>
-bool operator!=(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs) {
+constexpr bool operator!=(const Basic_Matrix<T1, R1, C1>& lhs, const Basic_Matrix<T2, R2, C2>& rhs) {
     return !(lhs == rhs);
 }
 
@@ -559,20 +783,96 @@ std::ostream& operator<< (std::ostream& out, const Basic_Matrix<T, ROW, COL>& rh
 }
 
 template <typename T, size_t R, size_t C>
-Basic_Matrix<T, C, R> transpose(const Basic_Matrix<T, R, C>& x) {
+constexpr Basic_Matrix<T, C, R> transpose(const Basic_Matrix<T, R, C>& x) {
     return x.transpose();
 }
 
 template <typename T, size_t N>
-T determinant(const Mat<T, N, N>& x) {
+constexpr T determinant(const Mat<T, N, N>& x) {
     return x.determinant();
 }
 
+template <detail::Invertible T, size_t N>
+constexpr Mat<T, N, N> inverse(const Mat<T, N, N>& x) {
+    return x.inverse();
+}
+
 template <typename T, size_t N>
-Mat<T, N, N> identity(const Mat<T, N, N>& x) {
+constexpr Mat<T, N, N> identity(const Mat<T, N, N>& x) {
     auto copy = x;
     return copy.identity();
 }
 
+namespace detail {
+
+// out = lhs * rhs over S for contiguous row-major lhs (n x k), rhs (k x m) and out (n x m), out
+// distinct from the operands; the ordinary product takes the element kernel when there is one,
+// the vector kernels of Semiring.hpp otherwise, nothing goes through the stack
+template <typename T, Semiring S = PlusTimes<T>>
+void denseProduct(const T* lhs, const T* rhs, T* out, const size_t& n, const size_t& k, const size_t& m) {
+    if constexpr (!std::is_same_v<S, PlusTimes<T>>)
+        semiringMultiply<S>(lhs, rhs, out, n, k, m);
+    else if constexpr (MatrixKernel<T>::enabled)
+        MatrixKernel<T>::multiply(lhs, rhs, out, n, k, m);
+    else
+        semiringMultiply<ProductUpdate<T, false>>(lhs, rhs, out, n, k, m);
+}
+
+}
+
+// out = lhs * rhs over a semiring (see Semiring.hpp), out may be lhs or rhs
+// every semiring runs on the operands in place with a blocked kernel in parallel, so large
+// matrices are better kept on the heap and multiplied with this form rather than operator*
+template <typename T, size_t ROW, size_t COL, size_t U, Semiring S = PlusTimes<T>>
+void multiply(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, COL, U>& rhs, Basic_Matrix<T, ROW, U>& out, [[maybe_unused]] const S& semiring = S{}) {
+    static_assert(std::is_same_v<typename S::Element, T>, "Semiring must be over the matrix elements");
+    if (static_cast<const void*>(&out) == &lhs || static_cast<const void*>(&out) == &rhs) {
+        std::unique_ptr<T[]> res = std::make_unique<T[]>(ROW * U);
+        detail::denseProduct<T, S>(lhs.data(), rhs.data(), res.get(), ROW, COL, U);
+        std::copy(res.get(), res.get() + ROW * U, out.data());
+    } else {
+        detail::denseProduct<T, S>(lhs.data(), rhs.data(), out.data(), ROW, COL, U);
+    }
+}
+
+template <typename T, size_t ROW, size_t COL, size_t U, Semiring S = PlusTimes<T>>
+Mat<T, ROW, U> multiply(const Basic_Matrix<T, ROW, COL>& lhs, const Basic_Matrix<T, COL, U>& rhs, const S& semiring = S{}) {
+    Mat<T, ROW, U> res;
+    multiply(lhs, rhs, res, semiring);
+    return res;
+}
+
+// out = base^exp over a semiring by repeated squaring, base^0 has one() on the diagonal and zero() elsewhere
+// min-plus powers of a weighted adjacency matrix with zero diagonal are shortest path lengths
+template <typename T, size_t N, Semiring S = PlusTimes<T>>
+void power(const Basic_Matrix<T, N, N>& base, const unsigned long long& exp, Basic_Matrix<T, N, N>& out, [[maybe_unused]] const S& semiring = S{}) {
+    static_assert(std::is_same_v<typename S::Element, T>, "Semiring must be over the matrix elements");
+    if (exp == 0) {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                out(i, j) = i == j ? T(S::one()) : T(S::zero());
+        return;
+    }
+    // the running power and the squares live on the heap, base may be out
+    std::unique_ptr<T[]> x = std::make_unique<T[]>(N * N), res = std::make_unique<T[]>(N * N), square = std::make_unique<T[]>(N * N);
+    std::copy(base.data(), base.data() + N * N, x.get());
+    std::copy(x.get(), x.get() + N * N, res.get());
+    for (int bit = std::bit_width(exp) - 2; bit >= 0; --bit) {
+        detail::denseProduct<T, S>(res.get(), res.get(), square.get(), N, N, N);
+        if ((exp >> bit) & 1)
+            detail::denseProduct<T, S>(square.get(), x.get(), res.get(), N, N, N);
+        else
+            res.swap(square);
+    }
+    std::copy(res.get(), res.get() + N * N, out.data());
+}
+
+template <typename T, size_t N, Semiring S = PlusTimes<T>>
+Mat<T, N, N> power(const Basic_Matrix<T, N, N>& base, const unsigned long long& exp, const S& semiring = S{}) {
+    Mat<T, N, N> res;
+    power(base, exp, res, semiring);
+    return res;
+}
+
 }
 #endif
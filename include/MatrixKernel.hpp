@@ -0,0 +1,21 @@
+#ifndef MatrixKernel_hpp
+#define MatrixKernel_hpp
+
+#include <cstddef>
+
+namespace vecxify {
+
+// extension point for element types that have a faster matrix product than the generic
+// Strassen recursion of Basic_Matrix, a specialization provides
+//     static constexpr bool enabled = true;
+//     static void multiply(const T* lhs, const T* rhs, T* out, const size_t& n, const size_t& k, const size_t& m);
+// which computes out = lhs * rhs for row-major lhs (n x k), rhs (k x m) and out (n x m)
+// the specialization must be visible wherever the element type is complete, so it lives next to the type
+template <typename T>
+struct MatrixKernel {
+    static constexpr bool enabled = false;
+};
+
+}
+
+#endif /* MatrixKernel_hpp */
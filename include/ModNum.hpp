@@ -2,121 +2,241 @@
 #define ModNum_hpp
 
 #include <iostream>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
+#include "Reduction.hpp"
+#include "MatrixKernel.hpp"
+#include "ThreadPool.hpp"
 
 namespace vecxify {
 
 template <typename T, T N>
 class ModNum;
 
+// element-wise loops over arrays of a residue type, see ModNumBulk.hpp
+template <typename T>
+struct BulkKernel;
+
 template <typename T, T N>
 std::ostream& operator<< (std::ostream& out, const ModNum<T, N>& m) {
     out << m.get();
     return out;
 }
 
+// residue modulo N, any modulus below 2^63, usable in constant expressions
+// the value is kept in the form of the reduction engine chosen from N (see Reduction.hpp):
+// Montgomery form for odd N, plain value with Barrett reduction otherwise
 template <typename T, T N>
 class ModNum final {
 private:
+    static_assert(std::is_integral_v<T>, "ModNum needs an integral type");
+    static_assert(N > 0 && static_cast<uint64_t>(N) < (uint64_t{1} << 63), "ModNum modulus must be in [1, 2^63)");
+
+    static constexpr Reduction<static_cast<uint64_t>(N)> engine{static_cast<uint64_t>(N)};
+
     T _data;
+
+    friend struct MatrixKernel<ModNum<T, N>>;
+    friend struct BulkKernel<ModNum<T, N>>;
+
+    static constexpr T fromValue(const T& m) noexcept {
+        uint64_t res;
+        if constexpr (std::is_signed_v<T>) {
+            T rem = m % N;
+            res = static_cast<uint64_t>(rem < 0 ? rem + N : rem);
+        } else {
+            res = static_cast<uint64_t>(m % N);
+        }
+        return static_cast<T>(engine.toForm(res));
+    }
+
+    static constexpr ModNum<T, N> fromForm(const uint64_t& x) noexcept {
+        ModNum<T, N> res{};
+        res._data = static_cast<T>(x);
+        return res;
+    }
+
+    constexpr uint64_t form() const noexcept {
+        return static_cast<uint64_t>(_data);
+    }
+
 public:
-    
-    ModNum() : _data {} {}
-    
-    ModNum(const T& m) : _data { m % N } {};
-    
-    ModNum<T, N>& operator= (const T& m) {
-        _data = m % N;
+
+    constexpr ModNum() : _data {} {}
+
+    // negative values are mapped into [0, N)
+    constexpr ModNum(const T& m) : _data { fromValue(m) } {};
+
+    constexpr ModNum<T, N>& operator= (const T& m) {
+        _data = fromValue(m);
         return *this;
     }
-    
-    const T& get() const noexcept {
-        return _data;
+
+    // the value in [0, N)
+    constexpr T get() const noexcept {
+        return static_cast<T>(engine.fromForm(form()));
     }
-    
-    ModNum<T, N> operator+(const ModNum<T, N>& rhs) const {
-        return (_data + rhs.get()) % N;
+
+    constexpr ModNum<T, N> operator+(const ModNum<T, N>& rhs) const {
+        return fromForm(engine.add(form(), rhs.form()));
     }
-    
-    ModNum<T, N> operator-(const ModNum<T, N>& rhs) const {
-        return (_data - rhs.get() + N) % N;
+
+    constexpr ModNum<T, N> operator-(const ModNum<T, N>& rhs) const {
+        return fromForm(engine.sub(form(), rhs.form()));
     }
-    
-    ModNum<T, N> operator-() const {
-        return (N - _data) % N;
+
+    constexpr ModNum<T, N> operator-() const {
+        return fromForm(engine.neg(form()));
     }
-    
-    ModNum<T, N> operator*(const ModNum<T, N>& rhs) const {
-        return (_data * rhs.get()) % N;
+
+    constexpr ModNum<T, N> operator*(const ModNum<T, N>& rhs) const {
+        return fromForm(engine.mul(form(), rhs.form()));
     }
-    
-    ModNum<T, N>& operator+=(const ModNum<T, N>& rhs) {
-        _data = (_data + rhs.get()) % N;
+
+    constexpr ModNum<T, N>& operator+=(const ModNum<T, N>& rhs) {
+        _data = static_cast<T>(engine.add(form(), rhs.form()));
         return *this;
     }
-    
-    ModNum<T, N>& operator-=(const ModNum<T, N>& rhs) {
-        _data = (_data - rhs.get() + N) % N;
+
+    constexpr ModNum<T, N>& operator-=(const ModNum<T, N>& rhs) {
+        _data = static_cast<T>(engine.sub(form(), rhs.form()));
         return *this;
     }
-    
-    ModNum<T, N>& operator*=(const ModNum<T, N>& rhs) {
-        _data = (_data * rhs.get()) % N;
+
+    constexpr ModNum<T, N>& operator*=(const ModNum<T, N>& rhs) {
+        _data = static_cast<T>(engine.mul(form(), rhs.form()));
         return *this;
     }
-    
-    ModNum<T, N>& operator++() {
-        _data++;
-        _data %= N;
+
+    // multiplicative inverse, throws std::domain_error when gcd(value, N) != 1
+    constexpr ModNum<T, N> inv() const {
+        return fromForm(engine.toForm(inverseMod(engine.fromForm(form()), static_cast<uint64_t>(N))));
+    }
+
+    constexpr ModNum<T, N> operator/(const ModNum<T, N>& rhs) const {
+        return *this * rhs.inv();
+    }
+
+    constexpr ModNum<T, N>& operator/=(const ModNum<T, N>& rhs) {
+        return *this *= rhs.inv();
+    }
+
+    // fixed-window exponentiation
+    constexpr ModNum<T, N> pow(const unsigned long long& exp) const {
+        return windowPower(*this, exp, fromForm(engine.toForm(1 % N)));
+    }
+
+    constexpr ModNum<T, N>& operator++() {
+        _data = static_cast<T>(engine.add(form(), engine.toForm(1 % N)));
         return *this;
     }
-    ModNum<T, N>& operator--() {
-        _data--, _data += N;
-        _data %= N;
+    constexpr ModNum<T, N>& operator--() {
+        _data = static_cast<T>(engine.sub(form(), engine.toForm(1 % N)));
         return *this;
     }
-    
-    ModNum<T, N> operator++(int) {
+
+    constexpr ModNum<T, N> operator++(int) {
         ModNum<T, N> copy{ *this };
         ++(*this);
         return copy;
     }
-    
-    ModNum<T, N> operator--(int) {
+
+    constexpr ModNum<T, N> operator--(int) {
         ModNum<T, N> copy{ *this };
         --(*this);
         return copy;
     }
-    
-    bool operator==(const ModNum<T, N>& rhs) const {
-        return _data == rhs.get();
+
+    constexpr bool operator==(const ModNum<T, N>& rhs) const {
+        return _data == rhs._data;
     }
-    
-    bool operator!=(const ModNum<T, N>& rhs) const {
+
+    constexpr bool operator!=(const ModNum<T, N>& rhs) const {
         return !(*this == rhs);
     }
-    
-    bool operator>(const ModNum<T, N>& rhs) const {
-        return _data > rhs.get();
+
+    constexpr bool operator>(const ModNum<T, N>& rhs) const {
+        return get() > rhs.get();
     }
-    
-    bool operator<(const ModNum<T, N> &rhs) const {
+
+    constexpr bool operator<(const ModNum<T, N> &rhs) const {
         return (!(*this > rhs)) && (*this != rhs);
     }
-    
-    bool operator>=(const ModNum<T, N> &rhs) const {
+
+    constexpr bool operator>=(const ModNum<T, N> &rhs) const {
         return (*this > rhs) || (*this == rhs);
     }
-    
-    bool operator<=(const ModNum<T, N> &rhs) const {
+
+    constexpr bool operator<=(const ModNum<T, N> &rhs) const {
         return (!(*this > rhs));
     }
-    
-    operator bool() const {
-        return _data > 0;
+
+    // zero is zero in every form
+    constexpr operator bool() const {
+        return _data != 0;
     }
-    
+
 };
 
 
+// lazy-reduction matrix product: raw products of residues are summed without reduction in
+// 64-bit accumulators (moduli up to 2^32, the inner loop vectorizes to 32x32->64 lane multiplies)
+// or 128-bit ones, and reduced once per block of the inner dimension
+// the engine reduction of a sum of products of forms is the form of the sum, see Reduction.hpp
+template <typename T, T N>
+struct MatrixKernel<ModNum<T, N>> {
+    static constexpr bool enabled = true;
+
+    // products with at least this many multiply-adds split their rows across the shared pool
+    static constexpr size_t PARALLEL_WORK = size_t{1} << 18;
+
+    static void multiply(const ModNum<T, N>* lhs, const ModNum<T, N>* rhs, ModNum<T, N>* out, const size_t& n, const size_t& k, const size_t& m) {
+        constexpr auto& engine = ModNum<T, N>::engine;
+        constexpr uint64_t mod = static_cast<uint64_t>(N);
+        constexpr unsigned __int128 maxProduct = static_cast<unsigned __int128>(mod - 1) * (mod - 1);
+        constexpr bool narrow = mod <= (uint64_t{1} << 32);
+        using Word = std::conditional_t<narrow, uint32_t, uint64_t>;
+        using Accumulator = std::conditional_t<narrow, uint64_t, unsigned __int128>;
+        // number of products an accumulator takes before it has to be reduced
+        constexpr unsigned __int128 limit = narrow ? ~uint64_t{0} : engine.reduceLimit();
+        constexpr unsigned __int128 terms = maxProduct ? limit / maxProduct : limit;
+        const size_t block = static_cast<size_t>(std::min<unsigned __int128>(terms, k ? k : 1));
+
+        std::vector<Word> b(k * m);
+        for (size_t i = 0; i < k * m; ++i)
+            b[i] = static_cast<Word>(rhs[i].form());
+
+        auto rows = [&](const size_t& first, const size_t& last) {
+            std::vector<Accumulator> acc(m);
+            std::vector<uint64_t> res(m);
+            for (size_t i = first; i < last; ++i) {
+                std::fill(res.begin(), res.end(), 0);
+                for (size_t p0 = 0; p0 < k; p0 += block) {
+                    std::fill(acc.begin(), acc.end(), 0);
+                    for (size_t p = p0; p < std::min(k, p0 + block); ++p) {
+                        const Word a = static_cast<Word>(lhs[i * k + p].form());
+                        if (a == 0)
+                            continue;
+                        const Word* row = b.data() + p * m;
+                        for (size_t j = 0; j < m; ++j)
+                            acc[j] += static_cast<Accumulator>(a) * row[j];
+                    }
+                    for (size_t j = 0; j < m; ++j)
+                        res[j] = engine.add(res[j], engine.reduce(acc[j]));
+                }
+                for (size_t j = 0; j < m; ++j)
+                    out[i * m + j] = ModNum<T, N>::fromForm(res[j]);
+            }
+        };
+
+        if (n * k * m >= PARALLEL_WORK)
+            ThreadPool::shared().parallelFor(0, n, std::max<size_t>(1, PARALLEL_WORK / std::max<size_t>(k * m, 1)), rows);
+        else
+            rows(0, n);
+    }
+};
+
 }
 #endif
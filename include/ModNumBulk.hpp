@@ -0,0 +1,543 @@
+#ifndef ModNumBulk_hpp
+#define ModNumBulk_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <ranges>
+#include <type_traits>
+#include <stdexcept>
+#include "ModNum.hpp"
+#include "Simd.hpp"
+
+namespace vecxify {
+
+namespace detail {
+
+enum class BulkOp { add, sub, mul, scale };
+
+template <typename T>
+struct IsModNum : std::false_type {};
+
+template <typename T, T N>
+struct IsModNum<ModNum<T, N>> : std::true_type {};
+
+}
+
+// loops over contiguous arrays of ModNum, see the bulk functions below
+// the vector versions handle moduli up to 2^32 with residues stored in 32 or 64 bits,
+// one residue per 64-bit lane: add and sub for every such modulus, products for odd ones,
+// other moduli and the tails that do not fill a vector use the scalar engine of ModNum
+// every version returns exactly the residues the ModNum operators compute
+template <typename T, T N>
+struct BulkKernel<ModNum<T, N>> {
+    using Element = ModNum<T, N>;
+    using Op = detail::BulkOp;
+
+    static_assert(sizeof(Element) == sizeof(T), "ModNum must be laid out as its residue");
+
+    static constexpr uint64_t mod = static_cast<uint64_t>(N);
+    static constexpr bool narrow = mod <= (uint64_t{1} << 32);
+    static constexpr bool vectorizable = narrow && (sizeof(T) == 4 || sizeof(T) == 8);
+
+    // a Montgomery form x * 2^64 of an odd modulus below 2^32 is reduced by two 32-bit steps,
+    // each needs only 32x32->64 multiplies, which every vector lane has
+    static constexpr bool montgomery32 = vectorizable && mod % 2 == 1;
+
+    // -m^-1 mod 2^32
+    static constexpr uint32_t negInv32 = []() {
+        uint32_t m = static_cast<uint32_t>(mod), inv = m;
+        for (int i = 0; i < 4; ++i)
+            inv *= 2 - m * inv;
+        return static_cast<uint32_t>(0 - inv);
+    }();
+
+    // products of residues dot sums before the accumulator has to be reduced
+    static constexpr size_t DOT_BLOCK = []() {
+        constexpr unsigned __int128 maxProduct = static_cast<unsigned __int128>(mod - 1) * (mod - 1);
+        constexpr unsigned __int128 limit = narrow ? ~uint64_t{0} : Element::engine.reduceLimit();
+        constexpr unsigned __int128 terms = maxProduct ? limit / maxProduct : limit;
+        return static_cast<size_t>(std::min<unsigned __int128>(terms, std::numeric_limits<size_t>::max()));
+    }();
+
+    // independent chains of prefixProduct and evaluate, one AVX-512 vector
+    static constexpr size_t LANES = 8;
+    using Lanes = std::array<uint64_t, LANES>;
+
+    // length of the LANES blocks prefixProduct scans at once, at most PREFIX_CHUNK so they stay in cache
+    static constexpr size_t PREFIX_BLOCK = 16;
+    static constexpr size_t PREFIX_CHUNK = 512;
+
+    static uint64_t form(const Element& x) noexcept {
+        return static_cast<uint64_t>(x._data);
+    }
+
+    static void assign(Element& x, const uint64_t& form) noexcept {
+        x._data = static_cast<T>(form);
+    }
+
+    static uint64_t unit() noexcept {
+        return Element::engine.toForm(1 % mod);
+    }
+
+    template <Op op>
+    static uint64_t apply(const uint64_t& lhs, const uint64_t& rhs) noexcept {
+        if constexpr (op == Op::add)
+            return Element::engine.add(lhs, rhs);
+        else if constexpr (op == Op::sub)
+            return Element::engine.sub(lhs, rhs);
+        else
+            return Element::engine.mul(lhs, rhs);
+    }
+
+    static void hornerScalar(const Element* coefficients, const size_t& full, const uint64_t& step, Lanes& acc) noexcept {
+        for (size_t first = full; first > 0; ) {
+            first -= LANES;
+            for (size_t lane = 0; lane < LANES; ++lane)
+                acc[lane] = Element::engine.add(Element::engine.mul(acc[lane], step), form(coefficients[first + lane]));
+        }
+    }
+
+#if VECXIFY_SIMD_DISPATCH
+    struct Avx2 {
+        static constexpr size_t WIDTH = 4;
+
+        VECXIFY_SIMD_AVX2 static __m256i load(const Element* p) noexcept {
+            if constexpr (sizeof(T) == 8)
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+            else
+                return _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        }
+
+        VECXIFY_SIMD_AVX2 static void store(Element* p, const __m256i& x) noexcept {
+            if constexpr (sizeof(T) == 8) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+            } else {
+                const __m256i packed = _mm256_permutevar8x32_epi32(x, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+            }
+        }
+
+        // p[index[0]], ..., p[index[3]]
+        VECXIFY_SIMD_AVX2 static __m256i gather(const Element* p, const __m256i& index) noexcept {
+            if constexpr (sizeof(T) == 8)
+                return _mm256_i64gather_epi64(reinterpret_cast<const long long*>(p), index, 8);
+            else
+                return _mm256_cvtepu32_epi64(_mm256_i64gather_epi32(reinterpret_cast<const int*>(p), index, 4));
+        }
+
+        // x < 2m to x mod m, the lanes are below 2^33 and compare as signed
+        VECXIFY_SIMD_AVX2 static __m256i reduceOnce(const __m256i& x) noexcept {
+            const __m256i m = _mm256_set1_epi64x(static_cast<long long>(mod));
+            return _mm256_sub_epi64(x, _mm256_andnot_si256(_mm256_cmpgt_epi64(m, x), m));
+        }
+
+        // t * 2^-32 mod m for t < m * 2^32: the low halves of t and q * m add up to 0 or 2^32
+        VECXIFY_SIMD_AVX2 static __m256i montgomery(const __m256i& t) noexcept {
+            const __m256i q = _mm256_mul_epu32(t, _mm256_set1_epi64x(negInv32));
+            const __m256i qm = _mm256_mul_epu32(q, _mm256_set1_epi64x(static_cast<long long>(mod)));
+            const __m256i low = _mm256_and_si256(t, _mm256_set1_epi64x(0xffffffffll));
+            // 1 for a non-zero low half, the comparison is -1 for a zero one
+            const __m256i carry = _mm256_add_epi64(_mm256_set1_epi64x(1), _mm256_cmpeq_epi64(low, _mm256_setzero_si256()));
+            return reduceOnce(_mm256_add_epi64(_mm256_add_epi64(_mm256_srli_epi64(t, 32), _mm256_srli_epi64(qm, 32)), carry));
+        }
+
+        template <Op op>
+        VECXIFY_SIMD_AVX2 static __m256i apply(const __m256i& lhs, const __m256i& rhs) noexcept {
+            if constexpr (op == Op::add) {
+                return reduceOnce(_mm256_add_epi64(lhs, rhs));
+            } else if constexpr (op == Op::sub) {
+                const __m256i m = _mm256_set1_epi64x(static_cast<long long>(mod));
+                return _mm256_add_epi64(_mm256_sub_epi64(lhs, rhs), _mm256_and_si256(_mm256_cmpgt_epi64(rhs, lhs), m));
+            } else {
+                return montgomery(montgomery(_mm256_mul_epu32(lhs, rhs)));
+            }
+        }
+
+        // the number of elements done, the caller finishes the tail
+        template <Op op>
+        __attribute__((target("avx2"))) static size_t map(const Element* lhs, const Element* rhs, Element* out, const size_t& n) noexcept {
+            const __m256i factor = _mm256_set1_epi64x(static_cast<long long>(form(rhs[0])));
+            size_t i = 0;
+            for (; i + WIDTH <= n; i += WIDTH)
+                store(out + i, apply<op>(load(lhs + i), op == Op::scale ? factor : load(rhs + i)));
+            return i;
+        }
+
+        __attribute__((target("avx2"))) static uint64_t dot(const Element* lhs, const Element* rhs, const size_t& n) noexcept {
+            uint64_t res = 0;
+            for (size_t first = 0; first < n; first += std::min(DOT_BLOCK, n - first)) {
+                const size_t last = first + std::min(DOT_BLOCK, n - first);
+                __m256i acc = _mm256_setzero_si256();
+                size_t i = first;
+                for (; i + WIDTH <= last; i += WIDTH)
+                    acc = _mm256_add_epi64(acc, _mm256_mul_epu32(load(lhs + i), load(rhs + i)));
+                alignas(32) uint64_t lanes[WIDTH];
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+                uint64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+                for (; i < last; ++i)
+                    sum += form(lhs[i]) * form(rhs[i]);
+                res = Element::engine.add(res, Element::engine.reduce(sum));
+            }
+            return res;
+        }
+
+        // LANES blocks of length elements scanned side by side, two vectors of block lanes
+        __attribute__((target("avx2"))) static void scanBlocks(const Element* x, Element* out, const size_t& length, Lanes& acc) noexcept {
+            const long long stride = static_cast<long long>(length);
+            const __m256i index = _mm256_setr_epi64x(0, stride, 2 * stride, 3 * stride);
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.data()));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.data() + WIDTH));
+            alignas(32) uint64_t lanes[LANES];
+            for (size_t i = 0; i < length; ++i) {
+                low = apply<Op::mul>(low, gather(x + i, index));
+                high = apply<Op::mul>(high, gather(x + WIDTH * length + i, index));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), low);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(lanes + WIDTH), high);
+                for (size_t lane = 0; lane < LANES; ++lane)
+                    assign(out[lane * length + i], lanes[lane]);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc.data()), low);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc.data() + WIDTH), high);
+        }
+
+        // LANES chains as two vectors
+        __attribute__((target("avx2"))) static void horner(const Element* coefficients, const size_t& full, const uint64_t& step, Lanes& acc) noexcept {
+            const __m256i factor = _mm256_set1_epi64x(static_cast<long long>(step));
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.data()));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc.data() + WIDTH));
+            for (size_t first = full; first > 0; ) {
+                first -= LANES;
+                low = apply<Op::add>(apply<Op::mul>(low, factor), load(coefficients + first));
+                high = apply<Op::add>(apply<Op::mul>(high, factor), load(coefficients + first + WIDTH));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc.data()), low);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc.data() + WIDTH), high);
+        }
+    };
+
+// GCC 12 warns about the self-initialized placeholder vectors of its AVX-512 headers
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    struct Avx512 {
+        static constexpr size_t WIDTH = 8;
+
+        VECXIFY_SIMD_AVX512 static __m512i load(const Element* p) noexcept {
+            if constexpr (sizeof(T) == 8)
+                return _mm512_loadu_si512(p);
+            else
+                return _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        }
+
+        VECXIFY_SIMD_AVX512 static void store(Element* p, const __m512i& x) noexcept {
+            if constexpr (sizeof(T) == 8)
+                _mm512_storeu_si512(p, x);
+            else
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm512_cvtepi64_epi32(x));
+        }
+
+        // x < 2m to x mod m: x - m wraps around above x when x < m
+        VECXIFY_SIMD_AVX512 static __m512i reduceOnce(const __m512i& x) noexcept {
+            return _mm512_min_epu64(x, _mm512_sub_epi64(x, _mm512_set1_epi64(static_cast<long long>(mod))));
+        }
+
+        // t * 2^-32 mod m for t < m * 2^32, as in Avx2::montgomery
+        VECXIFY_SIMD_AVX512 static __m512i montgomery(const __m512i& t) noexcept {
+            const __m512i q = _mm512_mul_epu32(t, _mm512_set1_epi64(negInv32));
+            const __m512i qm = _mm512_mul_epu32(q, _mm512_set1_epi64(static_cast<long long>(mod)));
+            const __m512i res = _mm512_add_epi64(_mm512_srli_epi64(t, 32), _mm512_srli_epi64(qm, 32));
+            const __mmask8 carry = _mm512_test_epi64_mask(t, _mm512_set1_epi64(0xffffffffll));
+            return reduceOnce(_mm512_mask_add_epi64(res, carry, res, _mm512_set1_epi64(1)));
+        }
+
+        template <Op op>
+        VECXIFY_SIMD_AVX512 static __m512i apply(const __m512i& lhs, const __m512i& rhs) noexcept {
+            if constexpr (op == Op::add) {
+                return reduceOnce(_mm512_add_epi64(lhs, rhs));
+            } else if constexpr (op == Op::sub) {
+                const __m512i res = _mm512_sub_epi64(lhs, rhs);
+                return _mm512_mask_add_epi64(res, _mm512_cmplt_epu64_mask(lhs, rhs), res, _mm512_set1_epi64(static_cast<long long>(mod)));
+            } else {
+                return montgomery(montgomery(_mm512_mul_epu32(lhs, rhs)));
+            }
+        }
+
+        template <Op op>
+        __attribute__((target("avx512f"))) static size_t map(const Element* lhs, const Element* rhs, Element* out, const size_t& n) noexcept {
+            const __m512i factor = _mm512_set1_epi64(static_cast<long long>(form(rhs[0])));
+            size_t i = 0;
+            for (; i + WIDTH <= n; i += WIDTH)
+                store(out + i, apply<op>(load(lhs + i), op == Op::scale ? factor : load(rhs + i)));
+            return i;
+        }
+
+        __attribute__((target("avx512f"))) static uint64_t dot(const Element* lhs, const Element* rhs, const size_t& n) noexcept {
+            uint64_t res = 0;
+            for (size_t first = 0; first < n; first += std::min(DOT_BLOCK, n - first)) {
+                const size_t last = first + std::min(DOT_BLOCK, n - first);
+                __m512i acc = _mm512_setzero_si512();
+                size_t i = first;
+                for (; i + WIDTH <= last; i += WIDTH)
+                    acc = _mm512_add_epi64(acc, _mm512_mul_epu32(load(lhs + i), load(rhs + i)));
+                uint64_t sum = static_cast<uint64_t>(_mm512_reduce_add_epi64(acc));
+                for (; i < last; ++i)
+                    sum += form(lhs[i]) * form(rhs[i]);
+                res = Element::engine.add(res, Element::engine.reduce(sum));
+            }
+            return res;
+        }
+
+        __attribute__((target("avx512f"))) static void scanBlocks(const Element* x, Element* out, const size_t& length, Lanes& acc) noexcept {
+            const long long stride = static_cast<long long>(length);
+            const __m512i index = _mm512_setr_epi64(0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride, 6 * stride, 7 * stride);
+            __m512i res = _mm512_loadu_si512(acc.data());
+            for (size_t i = 0; i < length; ++i) {
+                if constexpr (sizeof(T) == 8) {
+                    res = apply<Op::mul>(res, _mm512_i64gather_epi64(index, x + i, 8));
+                    _mm512_i64scatter_epi64(out + i, index, res, 8);
+                } else {
+                    res = apply<Op::mul>(res, _mm512_cvtepu32_epi64(_mm512_i64gather_epi32(index, x + i, 4)));
+                    _mm512_i64scatter_epi32(out + i, index, _mm512_cvtepi64_epi32(res), 4);
+                }
+            }
+            _mm512_storeu_si512(acc.data(), res);
+        }
+
+        __attribute__((target("avx512f"))) static void horner(const Element* coefficients, const size_t& full, const uint64_t& step, Lanes& acc) noexcept {
+            const __m512i factor = _mm512_set1_epi64(static_cast<long long>(step));
+            __m512i res = _mm512_loadu_si512(acc.data());
+            for (size_t first = full; first > 0; ) {
+                first -= LANES;
+                res = apply<Op::add>(apply<Op::mul>(res, factor), load(coefficients + first));
+            }
+            _mm512_storeu_si512(acc.data(), res);
+        }
+    };
+#pragma GCC diagnostic pop
+#endif
+
+    // instruction set used for op on this modulus
+    template <Op op>
+    static detail::SimdIsa isa() noexcept {
+        if constexpr (op == Op::add || op == Op::sub)
+            return vectorizable ? detail::simdIsa() : detail::SimdIsa::scalar;
+        else
+            return montgomery32 ? detail::simdIsa() : detail::SimdIsa::scalar;
+    }
+
+    // out[i] = lhs[i] op rhs[i], or lhs[i] * rhs[0] for scale
+    template <Op op>
+    static void map(const Element* lhs, const Element* rhs, Element* out, const size_t& n) {
+        if (n == 0)
+            return;
+        size_t done = 0;
+#if VECXIFY_SIMD_DISPATCH
+        if constexpr (vectorizable) {
+            switch (isa<op>()) {
+                case detail::SimdIsa::avx512:
+                    done = Avx512::template map<op>(lhs, rhs, out, n);
+                    break;
+                case detail::SimdIsa::avx2:
+                    done = Avx2::template map<op>(lhs, rhs, out, n);
+                    break;
+                default:
+                    break;
+            }
+        }
+#endif
+        const uint64_t factor = form(rhs[0]);
+        for (size_t i = done; i < n; ++i)
+            assign(out[i], apply<op>(form(lhs[i]), op == Op::scale ? factor : form(rhs[i])));
+    }
+
+    // raw products summed without reduction as in the matrix kernel, reduced once per block
+    static Element dot(const Element* lhs, const Element* rhs, const size_t& n) {
+        Element res{};
+#if VECXIFY_SIMD_DISPATCH
+        if constexpr (vectorizable) {
+            switch (isa<Op::add>()) {
+                case detail::SimdIsa::avx512:
+                    assign(res, Avx512::dot(lhs, rhs, n));
+                    return res;
+                case detail::SimdIsa::avx2:
+                    assign(res, Avx2::dot(lhs, rhs, n));
+                    return res;
+                default:
+                    break;
+            }
+        }
+#endif
+        using Accumulator = std::conditional_t<narrow, uint64_t, unsigned __int128>;
+        uint64_t sum = 0;
+        for (size_t first = 0; first < n; first += std::min(DOT_BLOCK, n - first)) {
+            const size_t last = first + std::min(DOT_BLOCK, n - first);
+            Accumulator acc = 0;
+            for (size_t i = first; i < last; ++i)
+                acc += static_cast<Accumulator>(form(lhs[i])) * form(rhs[i]);
+            sum = Element::engine.add(sum, Element::engine.reduce(acc));
+        }
+        assign(res, sum);
+        return res;
+    }
+
+    // inclusive prefix products, a chunk at a time so both passes stay in cache: LANES blocks
+    // of the chunk are scanned side by side, then each block is scaled by the product of the
+    // blocks before it, the first block starts from the product of the previous chunks
+    static void prefixProduct(const Element* x, Element* out, const size_t& n) {
+        uint64_t carry = unit();
+        size_t first = 0;
+#if VECXIFY_SIMD_DISPATCH
+        if constexpr (montgomery32) {
+            const detail::SimdIsa target = isa<Op::mul>();
+            while (target != detail::SimdIsa::scalar && n - first >= LANES * PREFIX_BLOCK) {
+                const size_t length = std::min(n - first, LANES * PREFIX_CHUNK) / LANES;
+                Element* res = out + first;
+                Lanes acc{};
+                acc.fill(unit());
+                acc[0] = carry;
+                if (target == detail::SimdIsa::avx512)
+                    Avx512::scanBlocks(x + first, res, length, acc);
+                else
+                    Avx2::scanBlocks(x + first, res, length, acc);
+
+                Element before{};
+                assign(before, acc[0]);
+                for (size_t lane = 1; lane < LANES; ++lane) {
+                    map<Op::scale>(res + lane * length, &before, res + lane * length, length);
+                    Element block{};
+                    assign(block, acc[lane]);
+                    before *= block;
+                }
+                carry = form(before);
+                first += LANES * length;
+            }
+        }
+#endif
+        for (; first < n; ++first) {
+            carry = Element::engine.mul(carry, form(x[first]));
+            assign(out[first], carry);
+        }
+    }
+
+    // p(x) = sum over lanes j of x^j q_j(x^LANES), q_j holding the coefficients j, j + LANES, ...
+    // the LANES Horner chains in x^LANES are independent (second-order Horner / Estrin split)
+    static Element evaluate(const Element* coefficients, const size_t& n, const Element& point) {
+        const uint64_t x = form(point);
+        Lanes powers{};
+        powers[0] = unit();
+        for (size_t lane = 1; lane < LANES; ++lane)
+            powers[lane] = Element::engine.mul(powers[lane - 1], x);
+        const uint64_t step = Element::engine.mul(powers[LANES - 1], x);
+
+        // the chains start from the coefficients past the last full group
+        const size_t full = n / LANES * LANES;
+        Lanes acc{};
+        for (size_t i = full; i < n; ++i)
+            acc[i - full] = form(coefficients[i]);
+
+        switch (isa<Op::mul>()) {
+#if VECXIFY_SIMD_DISPATCH
+            case detail::SimdIsa::avx512:
+                if constexpr (montgomery32)
+                    Avx512::horner(coefficients, full, step, acc);
+                break;
+            case detail::SimdIsa::avx2:
+                if constexpr (montgomery32)
+                    Avx2::horner(coefficients, full, step, acc);
+                break;
+#endif
+            default:
+                hornerScalar(coefficients, full, step, acc);
+                break;
+        }
+
+        uint64_t sum = 0;
+        for (size_t lane = 0; lane < LANES; ++lane)
+            sum = Element::engine.add(sum, Element::engine.mul(acc[lane], powers[lane]));
+        Element res{};
+        assign(res, sum);
+        return res;
+    }
+};
+
+namespace detail {
+
+template <typename R>
+using BulkKernelOf = BulkKernel<std::remove_cv_t<std::ranges::range_value_t<R>>>;
+
+template <typename... R>
+void checkBulkSizes(const size_t& n, const R&... ranges) {
+    if (((std::ranges::size(ranges) != n) || ...))
+        throw std::invalid_argument("Ranges must have the same size");
+}
+
+template <BulkOp op, typename L, typename R, typename O>
+void bulkMap(const L& lhs, const R& rhs, O& out) {
+    checkBulkSizes(std::ranges::size(out), lhs, rhs);
+    BulkKernelOf<O>::template map<op>(std::ranges::data(lhs), std::ranges::data(rhs), std::ranges::data(out), std::ranges::size(out));
+}
+
+}
+
+namespace bulk {
+
+// contiguous range of ModNum: std::vector, std::array, std::span, ...
+template <typename R>
+concept ModNumRange = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+    detail::IsModNum<std::remove_cv_t<std::ranges::range_value_t<R>>>::value;
+
+// out[i] = lhs[i] + rhs[i], out may be one of the inputs
+template <ModNumRange L, ModNumRange R, ModNumRange O>
+void add(const L& lhs, const R& rhs, O&& out) {
+    detail::bulkMap<detail::BulkOp::add>(lhs, rhs, out);
+}
+
+// out[i] = lhs[i] - rhs[i], out may be one of the inputs
+template <ModNumRange L, ModNumRange R, ModNumRange O>
+void sub(const L& lhs, const R& rhs, O&& out) {
+    detail::bulkMap<detail::BulkOp::sub>(lhs, rhs, out);
+}
+
+// out[i] = lhs[i] * rhs[i], out may be one of the inputs
+template <ModNumRange L, ModNumRange R, ModNumRange O>
+void mul(const L& lhs, const R& rhs, O&& out) {
+    detail::bulkMap<detail::BulkOp::mul>(lhs, rhs, out);
+}
+
+// out[i] = x[i] * factor, out may be x
+template <ModNumRange X, ModNumRange O>
+void scale(const X& x, const std::ranges::range_value_t<X>& factor, O&& out) {
+    detail::checkBulkSizes(std::ranges::size(out), x);
+    // factor may be an element of out
+    const std::remove_cv_t<std::ranges::range_value_t<X>> copy{ factor };
+    detail::BulkKernelOf<O>::template map<detail::BulkOp::scale>(std::ranges::data(x), &copy, std::ranges::data(out), std::ranges::size(out));
+}
+
+// sum of lhs[i] * rhs[i]
+template <ModNumRange L, ModNumRange R>
+auto dot(const L& lhs, const R& rhs) {
+    detail::checkBulkSizes(std::ranges::size(lhs), rhs);
+    return detail::BulkKernelOf<L>::dot(std::ranges::data(lhs), std::ranges::data(rhs), std::ranges::size(lhs));
+}
+
+// out[i] = x[0] * ... * x[i], out may be x
+template <ModNumRange X, ModNumRange O>
+void prefixProduct(const X& x, O&& out) {
+    detail::checkBulkSizes(std::ranges::size(out), x);
+    detail::BulkKernelOf<O>::prefixProduct(std::ranges::data(x), std::ranges::data(out), std::ranges::size(out));
+}
+
+// coefficients[0] + coefficients[1] * x + coefficients[2] * x^2 + ...
+template <ModNumRange C>
+auto evaluate(const C& coefficients, const std::ranges::range_value_t<C>& x) {
+    return detail::BulkKernelOf<C>::evaluate(std::ranges::data(coefficients), std::ranges::size(coefficients), x);
+}
+
+}
+
+}
+
+#endif /* ModNumBulk_hpp */
@@ -0,0 +1,280 @@
+#ifndef OutOfCore_hpp
+#define OutOfCore_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <future>
+#include <tuple>
+#include <utility>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "Semiring.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace detail {
+
+// file opened for positioned reads and writes, see OutOfCore.cpp
+// reads and writes at distinct offsets may run from several threads at once
+// failures throw std::system_error
+class File final {
+private:
+    int _fd;
+
+public:
+    // create truncates an existing file
+    File(const std::string& path, const bool& create);
+
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    File(File&& other) noexcept;
+    File& operator=(File&& other) noexcept;
+
+    ~File();
+
+    uint64_t size() const;
+
+    void resize(const uint64_t& bytes);
+
+    void read(const uint64_t& offset, void* data, const size_t& bytes) const;
+
+    void write(const uint64_t& offset, const void* data, const size_t& bytes);
+};
+
+}
+
+// row-major matrix of rows x cols elements stored in a file without header, it is never held
+// in memory: blocks are read and written on demand
+template <typename T>
+class FileMatrix final {
+private:
+    static_assert(std::is_trivially_copyable_v<T>, "File matrices hold trivially copyable elements");
+
+    detail::File _file;
+    size_t _rows;
+    size_t _cols;
+
+    FileMatrix(detail::File&& file, const size_t& rows, const size_t& cols) : _file { std::move(file) }, _rows { rows }, _cols { cols } {}
+
+    void checkBlock(const size_t& row, const size_t& col, const size_t& height, const size_t& width) const {
+        if (row + height > _rows || col + width > _cols)
+            throw std::out_of_range("Block out-of-range");
+    }
+
+public:
+
+    // new file of zero elements, an existing one is overwritten
+    static FileMatrix create(const std::string& path, const size_t& rows, const size_t& cols) {
+        detail::File file{path, true};
+        file.resize(static_cast<uint64_t>(rows) * cols * sizeof(T));
+        return FileMatrix{std::move(file), rows, cols};
+    }
+
+    // existing file, its size must be rows * cols elements
+    static FileMatrix open(const std::string& path, const size_t& rows, const size_t& cols) {
+        detail::File file{path, false};
+        if (file.size() != static_cast<uint64_t>(rows) * cols * sizeof(T))
+            throw std::invalid_argument("File size does not match the dimensions");
+        return FileMatrix{std::move(file), rows, cols};
+    }
+
+    size_t rows() const noexcept {
+        return _rows;
+    }
+
+    size_t cols() const noexcept {
+        return _cols;
+    }
+
+    // block of height x width at (row, col) into out with leading dimension ld
+    void read(const size_t& row, const size_t& col, const size_t& height, const size_t& width, T* out, const size_t& ld) const {
+        checkBlock(row, col, height, width);
+        if (width == _cols && ld == _cols) {
+            _file.read((static_cast<uint64_t>(row) * _cols) * sizeof(T), out, height * width * sizeof(T));
+            return;
+        }
+        for (size_t i = 0; i < height; ++i)
+            _file.read((static_cast<uint64_t>(row + i) * _cols + col) * sizeof(T), out + i * ld, width * sizeof(T));
+    }
+
+    void write(const size_t& row, const size_t& col, const size_t& height, const size_t& width, const T* in, const size_t& ld) {
+        checkBlock(row, col, height, width);
+        if (width == _cols && ld == _cols) {
+            _file.write((static_cast<uint64_t>(row) * _cols) * sizeof(T), in, height * width * sizeof(T));
+            return;
+        }
+        for (size_t i = 0; i < height; ++i)
+            _file.write((static_cast<uint64_t>(row + i) * _cols + col) * sizeof(T), in + i * ld, width * sizeof(T));
+    }
+};
+
+// what an out-of-core product did
+struct OutOfCoreStats {
+    // side of the square tiles
+    size_t tile;
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    // time of the tile products, and time the products waited for reads and writes
+    double computeSeconds;
+    double ioWaitSeconds;
+};
+
+namespace detail {
+
+// tiles of a side multiple of this, and no smaller
+inline constexpr size_t OUT_OF_CORE_ALIGN = 16;
+
+// rows of a tile product per task of the shared pool
+inline constexpr size_t OUT_OF_CORE_ROWS = 32;
+
+}
+
+// out = lhs * rhs for operands that do not fit in memory
+// the product runs on square tiles: while one pair of tiles of lhs and rhs is multiplied on the
+// shared pool, the next pair is read on a background thread, and a finished tile of out is
+// written back the same way; the memory in use is the six tile buffers (two of each operand),
+// sized so they take at most memoryBudget bytes, whatever the size of the files
+// lhs is read cols(rhs) / tile times and rhs rows(lhs) / tile times, a larger budget means less I/O
+template <typename T>
+OutOfCoreStats multiply(const FileMatrix<T>& lhs, const FileMatrix<T>& rhs, FileMatrix<T>& out, const size_t& memoryBudget) {
+    using Clock = std::chrono::steady_clock;
+    using Product = detail::ProductUpdate<T, false>;
+    constexpr size_t ALIGN = detail::OUT_OF_CORE_ALIGN;
+
+    if (lhs.cols() != rhs.rows() || out.rows() != lhs.rows() || out.cols() != rhs.cols())
+        throw std::invalid_argument("Column number of lhs must match row number of rhs");
+    const size_t n = lhs.rows(), k = lhs.cols(), m = rhs.cols();
+
+    size_t tile = static_cast<size_t>(std::sqrt(static_cast<double>(memoryBudget / (6 * sizeof(T))))) / ALIGN * ALIGN;
+    if (tile == 0)
+        throw std::invalid_argument("Memory budget is too small for a tile");
+    tile = std::min(tile, (std::max({n, k, m}) + ALIGN - 1) / ALIGN * ALIGN);
+
+    OutOfCoreStats stats{tile, 0, 0, 0.0, 0.0};
+    if (n == 0 || m == 0)
+        return stats;
+
+    // a buffer remembers the tile it holds, so a tile shared by two consecutive steps is read once
+    struct Buffer {
+        std::vector<T> data;
+        size_t row = ~size_t{0};
+        size_t col = ~size_t{0};
+    };
+    Buffer a[2], b[2];
+    std::vector<T> c[2];
+    for (size_t s = 0; s < 2; ++s) {
+        a[s].data.resize(tile * tile);
+        b[s].data.resize(tile * tile);
+        c[s].resize(tile * tile);
+    }
+
+    // step (i0, j0, p0): out tile (i0, j0) += lhs tile (i0, p0) * rhs tile (p0, j0), p0 innermost
+    // the walk is a serpentine: p0 runs backwards on every other tile of out and j0 on every other
+    // row of tiles, so the last step of a tile of out and the first of the next one share their lhs
+    // tile (same i0) or their rhs tile (same j0)
+    const size_t tilesK = std::max<size_t>((k + tile - 1) / tile, 1), tilesM = (m + tile - 1) / tile;
+    struct Step {
+        size_t i0, j0, p0;
+        bool first, last;
+    };
+    std::vector<Step> steps;
+    bool backwards = false;
+    for (size_t i0 = 0; i0 < n; i0 += tile) {
+        for (size_t t = 0; t < tilesM; ++t) {
+            const size_t j0 = (i0 / tile % 2 ? tilesM - 1 - t : t) * tile;
+            for (size_t q = 0; q < tilesK; ++q)
+                steps.push_back({i0, j0, (backwards ? tilesK - 1 - q : q) * tile, q == 0, q + 1 == tilesK});
+            backwards = !backwards;
+        }
+    }
+
+    // slots of the tiles of a step, the other slot of each operand is free for the next step
+    size_t slotA = 0, slotB = 0;
+    auto load = [&](Buffer& buffer, const FileMatrix<T>& matrix, const size_t& row, const size_t& col, uint64_t& bytes) {
+        if (buffer.row == row && buffer.col == col)
+            return;
+        const size_t height = std::min(tile, matrix.rows() - row), width = std::min(tile, matrix.cols() - col);
+        matrix.read(row, col, height, width, buffer.data.data(), tile);
+        buffer.row = row, buffer.col = col;
+        bytes += static_cast<uint64_t>(height) * width * sizeof(T);
+    };
+    // pick the slots of step s and read its tiles, the current slots are left alone
+    auto prefetch = [&](const size_t& s, uint64_t& bytes) {
+        const Step& step = steps[s];
+        const size_t nextA = a[slotA].row == step.i0 && a[slotA].col == step.p0 ? slotA : 1 - slotA;
+        const size_t nextB = b[slotB].row == step.p0 && b[slotB].col == step.j0 ? slotB : 1 - slotB;
+        return std::async(std::launch::async, [&, nextA, nextB, s]() {
+            if (k > 0) {
+                load(a[nextA], lhs, steps[s].i0, steps[s].p0, bytes);
+                load(b[nextB], rhs, steps[s].p0, steps[s].j0, bytes);
+            }
+            return std::pair<size_t, size_t>{nextA, nextB};
+        });
+    };
+
+    uint64_t readBytes[2] = {0, 0};
+    std::future<std::pair<size_t, size_t>> pending = prefetch(0, readBytes[0]);
+    // write of the tile last held by each buffer of out
+    std::future<void> writing[2];
+    size_t slotC = 0;
+    for (size_t s = 0; s < steps.size(); ++s) {
+        const Step& step = steps[s];
+        const size_t height = std::min(tile, n - step.i0), width = std::min(tile, m - step.j0);
+        const size_t depth = k > step.p0 ? std::min(tile, k - step.p0) : 0;
+
+        Clock::time_point start = Clock::now();
+        std::tie(slotA, slotB) = pending.get();
+        if (step.first) {
+            // the buffer of the tile before the previous one is free once its write finished
+            if (writing[slotC].valid())
+                writing[slotC].get();
+            std::fill(c[slotC].begin(), c[slotC].end(), T{});
+        }
+        stats.ioWaitSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        stats.bytesRead += readBytes[s % 2];
+        readBytes[s % 2] = 0;
+
+        if (s + 1 < steps.size())
+            pending = prefetch(s + 1, readBytes[(s + 1) % 2]);
+
+        start = Clock::now();
+        const T* x = a[slotA].data.data();
+        const T* y = b[slotB].data.data();
+        T* z = c[slotC].data();
+        if (depth > 0) {
+            ThreadPool::shared().parallelFor(0, height, detail::OUT_OF_CORE_ROWS, [&](const size_t& first, const size_t& last) {
+                for (size_t i = first; i < last; i += detail::OUT_OF_CORE_ROWS) {
+                    const size_t end = std::min(last, i + detail::OUT_OF_CORE_ROWS);
+                    detail::semiringAccumulate<Product>(x, tile, y, tile, z, tile, i, end, depth, width);
+                }
+            });
+        }
+        stats.computeSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (step.last) {
+            writing[slotC] = std::async(std::launch::async, [&out, z, step, height, width, tile]() {
+                out.write(step.i0, step.j0, height, width, z, tile);
+            });
+            stats.bytesWritten += static_cast<uint64_t>(height) * width * sizeof(T);
+            slotC = 1 - slotC;
+        }
+    }
+    const Clock::time_point start = Clock::now();
+    for (std::future<void>& write : writing) {
+        if (write.valid())
+            write.get();
+    }
+    stats.ioWaitSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+}
+
+#endif /* OutOfCore_hpp */
@@ -0,0 +1,504 @@
+#ifndef Poly_hpp
+#define Poly_hpp
+
+#include <iostream>
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+#include <span>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <initializer_list>
+#include "ModNum.hpp"
+#include "ModNumBulk.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace detail {
+
+// primitive 2^k-th root of unity modulo the prime p, 2^k the largest power of two dividing p - 1:
+// the odd part of p - 1 as power of a quadratic non-residue
+constexpr uint64_t rootOfUnity(const uint64_t& p) noexcept {
+    if (p == 2)
+        return 1;
+    for (uint64_t x = 2; ; ++x) {
+        if (powModConstant(x, (p - 1) / 2, p) == p - 1)
+            return powModConstant(x, (p - 1) >> std::countr_zero(p - 1), p);
+    }
+}
+
+}
+
+template <typename T>
+class Poly;
+
+template <typename T, T P>
+std::ostream& operator<< (std::ostream& out, const Poly<ModNum<T, P>>& p);
+
+// polynomial over the prime field ModNum<T, P>, coefficients from the constant term up
+// products use schoolbook, Karatsuba or a number theoretic transform by size, the transform
+// needs a power of two dividing P - 1 at least as large as the product (998244353 = 119 * 2^23 + 1
+// reaches 2^23 coefficients), larger products fall back to Karatsuba
+// series inverse, log and exp work modulo x^n, division and multipoint evaluation build on them
+template <typename T, T P>
+class Poly<ModNum<T, P>> final {
+public:
+    using Element = ModNum<T, P>;
+
+private:
+    static_assert(isPrime(static_cast<uint64_t>(P)), "Poly needs a prime modulus");
+
+    // transforms up to 2^ADICITY coefficients, ROOT has order 2^ADICITY
+    static constexpr int ADICITY = std::countr_zero(static_cast<uint64_t>(P) - 1);
+    static constexpr uint64_t ROOT = detail::rootOfUnity(static_cast<uint64_t>(P));
+
+    // below these sizes (coefficients of the shorter factor) the simpler algorithm is faster
+    static constexpr size_t KARATSUBA_THRESHOLD = 32;
+    static constexpr size_t NTT_THRESHOLD = 192;
+
+    // divisors and quotients shorter than this are handled by long division
+    static constexpr size_t DIVISION_THRESHOLD = 64;
+
+    // multipoint evaluation evaluates remainders by Horner on at most this many points
+    static constexpr size_t EVALUATION_LEAF = 32;
+
+    // transforms with at least twice this many coefficients split their butterfly passes across the shared pool
+    static constexpr size_t PARALLEL_NTT_GRAIN = size_t{1} << 14;
+
+    // subproduct and remainder trees fork their halves from this many points
+    static constexpr size_t PARALLEL_EVALUATION_THRESHOLD = 1 << 12;
+
+    // no trailing zero, the zero polynomial is empty
+    std::vector<Element> _coefficients;
+
+    void normalize() noexcept {
+        while (!_coefficients.empty() && _coefficients.back() == Element{})
+            _coefficients.pop_back();
+    }
+
+    static std::vector<Element> schoolbook(const Element* lhs, const size_t& n, const Element* rhs, const size_t& m) {
+        std::vector<Element> res(n + m - 1), row(m);
+        for (size_t i = 0; i < n; ++i) {
+            if (lhs[i] == Element{})
+                continue;
+            bulk::scale(std::span<const Element>(rhs, m), lhs[i], row);
+            addInto(res, i, row);
+        }
+        return res;
+    }
+
+    static void addInto(std::vector<Element>& res, const size_t& offset, const std::vector<Element>& x) {
+        std::span<Element> target(res.data() + offset, x.size());
+        bulk::add(target, x, target);
+    }
+
+    static void subInto(std::vector<Element>& res, const size_t& offset, const std::vector<Element>& x) {
+        std::span<Element> target(res.data() + offset, x.size());
+        bulk::sub(target, x, target);
+    }
+
+    static std::vector<Element> karatsuba(const Element* lhs, const size_t& n, const Element* rhs, const size_t& m) {
+        if (n < m)
+            return karatsuba(rhs, m, lhs, n);
+        if (m < KARATSUBA_THRESHOLD)
+            return schoolbook(lhs, n, rhs, m);
+
+        std::vector<Element> res(n + m - 1);
+        if (n >= 2 * m) {
+            // unbalanced: pieces of the longer factor as long as the shorter one
+            for (size_t offset = 0; offset < n; offset += m)
+                addInto(res, offset, multiply(lhs + offset, std::min(m, n - offset), rhs, m));
+            return res;
+        }
+
+        // lhs = a0 + x^k a1, rhs = b0 + x^k b1, with k <= m
+        const size_t k = (n + 1) / 2;
+        std::vector<Element> a(lhs, lhs + k), b(rhs, rhs + k);
+        addInto(a, 0, std::vector<Element>(lhs + k, lhs + n));
+        addInto(b, 0, std::vector<Element>(rhs + k, rhs + m));
+        std::vector<Element> low = multiply(lhs, k, rhs, k);
+        std::vector<Element> high = m > k ? multiply(lhs + k, n - k, rhs + k, m - k) : std::vector<Element>{};
+        std::vector<Element> mid = multiply(a.data(), a.size(), b.data(), b.size());
+        subInto(mid, 0, low);
+        subInto(mid, 0, high);
+        addInto(res, 0, low);
+        addInto(res, 2 * k, high);
+        // the middle product may have trailing coefficients that cancel to zero beyond the result
+        mid.resize(std::min(mid.size(), res.size() - k));
+        addInto(res, k, mid);
+        return res;
+    }
+
+    // roots[half + j] = w^j, w a primitive (2 * half)-th root of unity or its inverse, for every power of two half below size
+    static std::vector<Element> rootTable(const size_t& size, const bool& inverse) {
+        std::vector<Element> roots(size);
+        for (size_t half = 1; half < size; half <<= 1) {
+            Element w = Element(static_cast<T>(ROOT)).pow(uint64_t{1} << (ADICITY - std::countr_zero(2 * half)));
+            if (inverse)
+                w = w.inv();
+            roots[half] = Element(1);
+            for (size_t j = 1; j < half; ++j)
+                roots[half + j] = roots[half + j - 1] * w;
+        }
+        return roots;
+    }
+
+    // one butterfly pass over blocks of 2 * half elements, butterflies [first, last) of size / 2
+    template <bool INVERSE>
+    static void butterflies(Element* a, const Element* roots, const size_t& half, const size_t& first, const size_t& last) noexcept {
+        for (size_t t = first; t < last; ) {
+            size_t block = t / half * 2 * half;
+            size_t j = t % half;
+            size_t end = std::min(last - t, half - j) + j;
+            for ( ; j < end; ++j, ++t) {
+                Element& x = a[block + j];
+                Element& y = a[block + j + half];
+                if constexpr (INVERSE) {
+                    // Cooley-Tukey
+                    Element u = x, v = y * roots[half + j];
+                    x = u + v;
+                    y = u - v;
+                } else {
+                    // Gentleman-Sande
+                    Element u = x, v = y;
+                    x = u + v;
+                    y = (u - v) * roots[half + j];
+                }
+            }
+        }
+    }
+
+    // forward transform takes natural order to bit-reversed order, the inverse takes it back
+    // so no permutation is ever needed, the inverse is not scaled by 1 / size
+    template <bool INVERSE>
+    static void transform(std::vector<Element>& a, const std::vector<Element>& roots) {
+        const size_t size = a.size();
+        auto pass = [&](const size_t& half) {
+            if (size >= 2 * PARALLEL_NTT_GRAIN) {
+                ThreadPool::shared().parallelFor(0, size / 2, PARALLEL_NTT_GRAIN, [&](const size_t& first, const size_t& last) {
+                    butterflies<INVERSE>(a.data(), roots.data(), half, first, last);
+                });
+            } else {
+                butterflies<INVERSE>(a.data(), roots.data(), half, 0, size / 2);
+            }
+        };
+        if constexpr (INVERSE) {
+            for (size_t half = 1; half < size; half <<= 1)
+                pass(half);
+        } else {
+            for (size_t half = size / 2; half >= 1; half >>= 1)
+                pass(half);
+        }
+    }
+
+    static std::vector<Element> nttMultiply(const Element* lhs, const size_t& n, const Element* rhs, const size_t& m) {
+        const size_t size = std::bit_ceil(n + m - 1);
+        const std::vector<Element> roots = rootTable(size, false);
+        std::vector<Element> a(size), b{};
+        std::copy(lhs, lhs + n, a.begin());
+        transform<false>(a, roots);
+        if (lhs == rhs && n == m) {
+            bulk::mul(a, a, a);
+        } else {
+            b.resize(size);
+            std::copy(rhs, rhs + m, b.begin());
+            transform<false>(b, roots);
+            bulk::mul(a, b, a);
+        }
+        transform<true>(a, rootTable(size, true));
+        a.resize(n + m - 1);
+        bulk::scale(a, Element(static_cast<T>(size)).inv(), a);
+        return a;
+    }
+
+    static std::vector<Element> multiply(const Element* lhs, const size_t& n, const Element* rhs, const size_t& m) {
+        if (n == 0 || m == 0)
+            return {};
+        if (std::min(n, m) >= NTT_THRESHOLD && n + m - 1 <= (size_t{1} << std::min(ADICITY, 62)))
+            return nttMultiply(lhs, n, rhs, m);
+        return karatsuba(lhs, n, rhs, m);
+    }
+
+    // coefficients in reverse order, padded with zeros to n first
+    Poly<Element> reversed(const size_t& n) const {
+        std::vector<Element> res(_coefficients);
+        res.resize(std::max(n, res.size()));
+        std::reverse(res.begin(), res.end());
+        return Poly<Element>(std::move(res));
+    }
+
+    std::pair<Poly<Element>, Poly<Element>> longDivision(const Poly<Element>& rhs) const {
+        const size_t m = rhs.size();
+        std::vector<Element> rem(_coefficients);
+        std::vector<Element> quotient(size() - m + 1);
+        const Element lead = rhs._coefficients.back().inv();
+        for (size_t i = quotient.size(); i-- > 0; ) {
+            Element q = rem[i + m - 1] * lead;
+            quotient[i] = q;
+            if (q == Element{})
+                continue;
+            for (size_t j = 0; j < m; ++j)
+                rem[i + j] -= q * rhs._coefficients[j];
+        }
+        rem.resize(m - 1);
+        return { Poly<Element>(std::move(quotient)), Poly<Element>(std::move(rem)) };
+    }
+
+    // tree[node] = product of (x - points[i]) over the points of the node, children at 2 node and 2 node + 1
+    static void buildTree(std::vector<Poly<Element>>& tree, const size_t& node, const Element* points, const size_t& count) {
+        if (count <= EVALUATION_LEAF) {
+            Poly<Element> res{Element(1)};
+            for (size_t i = 0; i < count; ++i)
+                res *= Poly<Element>{-points[i], Element(1)};
+            tree[node] = std::move(res);
+            return;
+        }
+        const size_t half = count / 2;
+        auto left = [&]() { buildTree(tree, 2 * node, points, half); };
+        auto right = [&]() { buildTree(tree, 2 * node + 1, points + half, count - half); };
+        if (count >= PARALLEL_EVALUATION_THRESHOLD) {
+            ThreadPool::shared().invoke(left, right);
+        } else {
+            left();
+            right();
+        }
+        tree[node] = tree[2 * node] * tree[2 * node + 1];
+    }
+
+    static void evaluateTree(const std::vector<Poly<Element>>& tree, const size_t& node, const Poly<Element>& p, const Element* points, Element* out, const size_t& count) {
+        const Poly<Element> rem = p % tree[node];
+        if (count <= EVALUATION_LEAF) {
+            for (size_t i = 0; i < count; ++i)
+                out[i] = rem.evaluate(points[i]);
+            return;
+        }
+        const size_t half = count / 2;
+        auto left = [&]() { evaluateTree(tree, 2 * node, rem, points, out, half); };
+        auto right = [&]() { evaluateTree(tree, 2 * node + 1, rem, points + half, out + half, count - half); };
+        if (count >= PARALLEL_EVALUATION_THRESHOLD) {
+            ThreadPool::shared().invoke(left, right);
+        } else {
+            left();
+            right();
+        }
+    }
+
+public:
+
+    Poly() = default;
+
+    Poly(const std::initializer_list<Element>& coefficients) : _coefficients(coefficients) {
+        normalize();
+    }
+
+    explicit Poly(std::vector<Element> coefficients) : _coefficients(std::move(coefficients)) {
+        normalize();
+    }
+
+    // number of coefficients up to the leading one, 0 for the zero polynomial
+    size_t size() const noexcept {
+        return _coefficients.size();
+    }
+
+    // -1 for the zero polynomial
+    long long degree() const noexcept {
+        return static_cast<long long>(_coefficients.size()) - 1;
+    }
+
+    // coefficient of x^i, zero past the leading one
+    Element operator[](const size_t& i) const {
+        return i < _coefficients.size() ? _coefficients[i] : Element{};
+    }
+
+    const std::vector<Element>& coefficients() const noexcept {
+        return _coefficients;
+    }
+
+    Poly<Element> operator+(const Poly<Element>& rhs) const {
+        const Poly<Element>& longer = size() >= rhs.size() ? *this : rhs;
+        const Poly<Element>& shorter = size() >= rhs.size() ? rhs : *this;
+        std::vector<Element> res(longer._coefficients);
+        addInto(res, 0, shorter._coefficients);
+        return Poly<Element>(std::move(res));
+    }
+
+    Poly<Element> operator-(const Poly<Element>& rhs) const {
+        std::vector<Element> res(_coefficients);
+        res.resize(std::max(size(), rhs.size()));
+        subInto(res, 0, rhs._coefficients);
+        return Poly<Element>(std::move(res));
+    }
+
+    Poly<Element> operator-() const {
+        return Poly<Element>{} - *this;
+    }
+
+    Poly<Element> operator*(const Poly<Element>& rhs) const {
+        return Poly<Element>(multiply(_coefficients.data(), size(), rhs._coefficients.data(), rhs.size()));
+    }
+
+    Poly<Element> operator*(const Element& rhs) const {
+        std::vector<Element> res(size());
+        bulk::scale(_coefficients, rhs, res);
+        return Poly<Element>(std::move(res));
+    }
+
+    // quotient and remainder, throws std::domain_error when rhs is zero
+    std::pair<Poly<Element>, Poly<Element>> divmod(const Poly<Element>& rhs) const {
+        if (rhs.size() == 0)
+            throw std::domain_error("Division by the zero polynomial");
+        if (size() < rhs.size())
+            return { Poly<Element>{}, *this };
+        const size_t length = size() - rhs.size() + 1;
+        if (rhs.size() < DIVISION_THRESHOLD || length < DIVISION_THRESHOLD)
+            return longDivision(rhs);
+
+        // reversing turns the quotient into the first terms of a power series quotient
+        Poly<Element> quotient = (reversed(size()).truncated(length) * rhs.reversed(rhs.size()).inverse(length)).truncated(length).reversed(length);
+        Poly<Element> rem = (*this - rhs * quotient).truncated(rhs.size() - 1);
+        return { std::move(quotient), std::move(rem) };
+    }
+
+    Poly<Element> operator/(const Poly<Element>& rhs) const {
+        return divmod(rhs).first;
+    }
+
+    Poly<Element> operator%(const Poly<Element>& rhs) const {
+        return divmod(rhs).second;
+    }
+
+    Poly<Element>& operator+=(const Poly<Element>& rhs) {
+        return *this = *this + rhs;
+    }
+
+    Poly<Element>& operator-=(const Poly<Element>& rhs) {
+        return *this = *this - rhs;
+    }
+
+    Poly<Element>& operator*=(const Poly<Element>& rhs) {
+        return *this = *this * rhs;
+    }
+
+    Poly<Element>& operator*=(const Element& rhs) {
+        return *this = *this * rhs;
+    }
+
+    Poly<Element>& operator/=(const Poly<Element>& rhs) {
+        return *this = *this / rhs;
+    }
+
+    Poly<Element>& operator%=(const Poly<Element>& rhs) {
+        return *this = *this % rhs;
+    }
+
+    bool operator==(const Poly<Element>& rhs) const {
+        return _coefficients == rhs._coefficients;
+    }
+
+    bool operator!=(const Poly<Element>& rhs) const {
+        return !(*this == rhs);
+    }
+
+    // the terms below x^n
+    Poly<Element> truncated(const size_t& n) const {
+        return Poly<Element>(std::vector<Element>(_coefficients.begin(), _coefficients.begin() + std::min(n, size())));
+    }
+
+    Poly<Element> derivative() const {
+        std::vector<Element> res(size() > 0 ? size() - 1 : 0);
+        for (size_t i = 1; i < size(); ++i)
+            res[i - 1] = _coefficients[i] * Element(static_cast<T>(i));
+        return Poly<Element>(std::move(res));
+    }
+
+    // antiderivative with zero constant term, throws std::domain_error when the degree reaches P - 1
+    Poly<Element> integral() const {
+        std::vector<Element> inverses(size());
+        for (size_t i = 0; i < size(); ++i)
+            inverses[i] = Element(static_cast<T>((i + 1) % static_cast<uint64_t>(P)));
+        batchInverse(inverses.begin(), inverses.end());
+        std::vector<Element> res(size() + 1);
+        std::span<Element> tail(res.data() + 1, size());
+        bulk::mul(_coefficients, inverses, tail);
+        return Poly<Element>(std::move(res));
+    }
+
+    // g with f g = 1 mod x^n by Newton iteration g <- g (2 - f g), the precision doubles every step
+    // throws std::domain_error when the constant term is zero
+    Poly<Element> inverse(const size_t& n) const {
+        if (n == 0)
+            return Poly<Element>{};
+        Poly<Element> res{(*this)[0].inv()};
+        for (size_t length = 1; length < n; ) {
+            length = std::min(2 * length, n);
+            Poly<Element> error = -(truncated(length) * res).truncated(length);
+            error += Poly<Element>{Element(2)};
+            res = (res * error).truncated(length);
+        }
+        return res;
+    }
+
+    // log f mod x^n as the integral of f' / f, the constant term must be 1
+    Poly<Element> log(const size_t& n) const {
+        if ((*this)[0] != Element(1))
+            throw std::domain_error("Logarithm needs a constant term of 1");
+        if (n == 0)
+            return Poly<Element>{};
+        return (derivative() * inverse(n)).truncated(n - 1).integral();
+    }
+
+    // exp f mod x^n by Newton iteration g <- g (1 - log g + f), the constant term must be 0
+    Poly<Element> exp(const size_t& n) const {
+        if ((*this)[0] != Element{})
+            throw std::domain_error("Exponential needs a constant term of 0");
+        if (n == 0)
+            return Poly<Element>{};
+        Poly<Element> res{Element(1)};
+        for (size_t length = 1; length < n; ) {
+            length = std::min(2 * length, n);
+            Poly<Element> step = truncated(length) - res.log(length);
+            step += Poly<Element>{Element(1)};
+            res = (res * step).truncated(length);
+        }
+        return res;
+    }
+
+    // value at x, LANES independent Horner chains (see bulk::evaluate)
+    Element evaluate(const Element& x) const {
+        return bulk::evaluate(_coefficients, x);
+    }
+
+    // values at every point: the polynomial is reduced modulo the subproduct tree of the points,
+    // O(n log^2 n) operations for n points and degree below n
+    std::vector<Element> evaluate(const std::vector<Element>& points) const {
+        std::vector<Element> res(points.size());
+        if (points.size() <= EVALUATION_LEAF) {
+            for (size_t i = 0; i < points.size(); ++i)
+                res[i] = evaluate(points[i]);
+            return res;
+        }
+        std::vector<Poly<Element>> tree(4 * points.size());
+        buildTree(tree, 1, points.data(), points.size());
+        evaluateTree(tree, 1, *this, points.data(), res.data(), points.size());
+        return res;
+    }
+
+    friend std::ostream& operator<< <T, P>(std::ostream& out, const Poly<Element>& p);
+};
+
+// coefficients from the constant term up, [] for the zero polynomial
+template <typename T, T P>
+std::ostream& operator<< (std::ostream& out, const Poly<ModNum<T, P>>& p) {
+    out << '[';
+    for (size_t i = 0; i < p.size(); ++i)
+        out << (i ? ", " : "") << p._coefficients[i];
+    out << ']';
+    return out;
+}
+
+}
+
+#endif /* Poly_hpp */
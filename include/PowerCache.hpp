@@ -0,0 +1,125 @@
+#ifndef PowerCache_hpp
+#define PowerCache_hpp
+
+#include <cstddef>
+#include <vector>
+#include <bit>
+#include <algorithm>
+#include <stdexcept>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+
+namespace vecxify {
+
+// M^n * v for one square matrix M and many exponents n
+// the powers M^(d * 2^(WINDOW * i)) for every digit d in [1, 2^WINDOW) are computed once, a query
+// then takes one matrix-vector product per nonzero digit of n in base 2^WINDOW: O(log n * N^2)
+// instead of the O(log n * N^3) of repeated squaring
+// powers are kept transposed, (M^n v)^T = v^T (M^T)^n turns a product with a vector into a sum
+// of scaled rows, and the vectors of a batch that need the same power into one matrix product
+// the cache is immutable once built, any number of threads may query it at the same time
+template <typename T, size_t N, size_t WINDOW = 1>
+class PowerCache final {
+private:
+    static_assert(WINDOW >= 1 && WINDOW <= 8, "Window must have 1 to 8 bits");
+
+    static constexpr size_t DIGITS = (size_t{1} << WINDOW) - 1;
+
+    // exponents below 2^(WINDOW * _levels) are covered
+    size_t _levels;
+
+    unsigned long long _maxExponent;
+
+    // (M^T)^(d * 2^(WINDOW * i)) at (i * DIGITS + d - 1) * N * N, row-major
+    std::vector<T> _powers;
+
+    const T* power(const size_t& level, const size_t& digit) const noexcept {
+        return _powers.data() + (level * DIGITS + digit - 1) * N * N;
+    }
+
+    T* power(const size_t& level, const size_t& digit) noexcept {
+        return _powers.data() + (level * DIGITS + digit - 1) * N * N;
+    }
+
+    static size_t digit(const unsigned long long& exp, const size_t& level) noexcept {
+        return static_cast<size_t>((exp >> (WINDOW * level)) & DIGITS);
+    }
+
+    void checkExponent(const unsigned long long& exp) const {
+        if (exp > _maxExponent)
+            throw std::out_of_range("Exponent exceeds the cache");
+    }
+
+public:
+
+    // the cache takes (2^WINDOW - 1) * ceil(bit_width(maxExponent) / WINDOW) matrices and as many products to build
+    explicit PowerCache(const Basic_Matrix<T, N, N>& base, const unsigned long long& maxExponent = ~0ull)
+        : _levels { (static_cast<size_t>(std::bit_width(maxExponent)) + WINDOW - 1) / WINDOW }, _maxExponent { maxExponent }, _powers(_levels * DIGITS * N * N) {
+        if (_levels == 0)
+            return;
+        T* first = power(0, 1);
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                first[j * N + i] = base(i, j);
+        for (size_t level = 0; level < _levels; ++level) {
+            // (M^T)^(2^(WINDOW * level)) = last digit of the previous level times its first one
+            if (level > 0)
+                detail::denseProduct(power(level - 1, DIGITS), power(level - 1, 1), power(level, 1), N, N, N);
+            for (size_t d = 2; d <= DIGITS; ++d)
+                detail::denseProduct(power(level, d - 1), power(level, 1), power(level, d), N, N, N);
+        }
+    }
+
+    unsigned long long maxExponent() const noexcept {
+        return _maxExponent;
+    }
+
+    // M^exp * v, v taken as a column; throws std::out_of_range when exp > maxExponent()
+    Vec<T, N> apply(const unsigned long long& exp, const Vec<T, N>& v) const {
+        checkExponent(exp);
+        Vec<T, N> res = v, next;
+        for (size_t level = 0; level < _levels && (exp >> (WINDOW * level)); ++level) {
+            const size_t d = digit(exp, level);
+            if (d == 0)
+                continue;
+            detail::denseProduct(&res(0), power(level, d), &next(0), 1, N, N);
+            std::copy(&next(0), &next(0) + N, &res(0));
+        }
+        return res;
+    }
+
+    // vectors[q] = M^exponents[q] * vectors[q] for every query q
+    // the queries with the same digit at a level are packed into the rows of one matrix
+    // and go through one product with the cached power, which is read once for all of them
+    void apply(const std::vector<unsigned long long>& exponents, std::vector<Vec<T, N>>& vectors) const {
+        if (exponents.size() != vectors.size())
+            throw std::invalid_argument("Every vector needs an exponent");
+        for (const unsigned long long& exp : exponents)
+            checkExponent(exp);
+
+        std::vector<size_t> group;
+        std::vector<T> packed, product;
+        for (size_t level = 0; level < _levels; ++level) {
+            for (size_t d = 1; d <= DIGITS; ++d) {
+                group.clear();
+                for (size_t q = 0; q < exponents.size(); ++q) {
+                    if (digit(exponents[q], level) == d)
+                        group.push_back(q);
+                }
+                if (group.empty())
+                    continue;
+                packed.resize(group.size() * N);
+                product.resize(group.size() * N);
+                for (size_t r = 0; r < group.size(); ++r)
+                    std::copy(&vectors[group[r]](0), &vectors[group[r]](0) + N, packed.begin() + r * N);
+                detail::denseProduct(packed.data(), power(level, d), product.data(), group.size(), N, N);
+                for (size_t r = 0; r < group.size(); ++r)
+                    std::copy(product.begin() + r * N, product.begin() + (r + 1) * N, &vectors[group[r]](0));
+            }
+        }
+    }
+};
+
+}
+
+#endif /* PowerCache_hpp */
@@ -0,0 +1,73 @@
+#ifndef Product_hpp
+#define Product_hpp
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include "BigInt.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace detail {
+
+// ranges with fewer elements are multiplied left to right
+constexpr size_t PRODUCT_LEAF = 8;
+
+// ranges with at least this many elements split their halves across the shared pool
+constexpr size_t PARALLEL_PRODUCT_THRESHOLD = 256;
+
+template <typename T, typename It>
+T productTree(It first, const size_t& count) {
+    if (count <= PRODUCT_LEAF) {
+        T res(1ll);
+        for (size_t i = 0; i < count; ++i, ++first)
+            res *= T(*first);
+        return res;
+    }
+
+    const size_t half = count / 2;
+    It mid = std::next(first, half);
+    std::optional<T> lhs{}, rhs{};
+    auto left = [&]() { lhs.emplace(productTree<T>(first, half)); };
+    auto right = [&]() { rhs.emplace(productTree<T>(mid, count - half)); };
+    if (count >= PARALLEL_PRODUCT_THRESHOLD) {
+        ThreadPool::shared().invoke(left, right);
+    } else {
+        left();
+        right();
+    }
+    *lhs *= *rhs;
+    return std::move(*lhs);
+}
+
+}
+
+// product of [first, last) as a balanced binary tree, T(1) for an empty range
+// operands of a multiplication have similar sizes, which is what the subquadratic
+// BigInt multiplication needs, and large subtrees run in parallel on the shared pool
+// T defaults to the value type of the range, each element is converted with T(*it)
+template <typename T = void, typename It>
+auto product(It first, It last) {
+    using Result = std::conditional_t<std::is_void_v<T>, typename std::iterator_traits<It>::value_type, T>;
+    return detail::productTree<Result>(first, static_cast<size_t>(std::distance(first, last)));
+}
+
+template <typename T = void, typename Range>
+auto product(const Range& range) {
+    return product<T>(std::begin(range), std::end(range));
+}
+
+// n! by prime swing: n! = (floor(n/2)!)^2 * swing(n), with the factorization of swing(n) multiplied as a product tree
+BigInt factorial(const unsigned long long& n);
+
+// n! / (k! (n - k)!) from its prime factorization, 0 when k > n
+BigInt binomial(const unsigned long long& n, const unsigned long long& k);
+
+// product of the primes not greater than n
+BigInt primorial(const unsigned long long& n);
+
+}
+
+#endif /* Product_hpp */
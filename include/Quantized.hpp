@@ -0,0 +1,144 @@
+#ifndef Quantized_hpp
+#define Quantized_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "Matrix.hpp"
+
+namespace vecxify {
+
+// element types of the quantized products, widened to 16 bits by the kernels
+template <typename T>
+concept QuantizedElement = std::is_same_v<T, int8_t> || std::is_same_v<T, uint8_t> || std::is_same_v<T, int16_t>;
+
+// affine quantization: a quantized q stands for the real scale * (q - zeroPoint)
+// a single entry applies to every row of lhs (or column of rhs and out), otherwise there is one per row (column)
+struct Quantization {
+    std::vector<float> scales;
+    std::vector<int32_t> zeroPoints;
+
+    float scale(const size_t& i) const noexcept {
+        return scales.size() == 1 ? scales[0] : scales[i];
+    }
+
+    int32_t zeroPoint(const size_t& i) const noexcept {
+        return zeroPoints.size() == 1 ? zeroPoints[0] : zeroPoints[i];
+    }
+};
+
+namespace detail {
+
+// out (n x m) = lhs * rhs on operands packed by pairs along the inner dimension, see Quantized.cpp
+// lhs row i holds (lhs[i][2q], lhs[i][2q + 1]) in its word q, as the low and high 16 bits
+// rhs holds the pairs of rows of the original interleaved: rhs[(q * m + j) * 2 + t] = original[2q + t][j]
+// an odd inner dimension is padded with a zero pair member
+void quantizedProduct(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& n, const size_t& pairs, const size_t& m);
+
+template <QuantizedElement T>
+std::vector<int32_t> packLhs(const T* lhs, const size_t& n, const size_t& k) {
+    const size_t pairs = (k + 1) / 2;
+    std::vector<int32_t> res(n * pairs);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t q = 0; q < pairs; ++q) {
+            const uint32_t low = static_cast<uint16_t>(static_cast<int16_t>(lhs[i * k + 2 * q]));
+            const uint32_t high = 2 * q + 1 < k ? static_cast<uint16_t>(static_cast<int16_t>(lhs[i * k + 2 * q + 1])) : 0;
+            res[i * pairs + q] = static_cast<int32_t>(low | (high << 16));
+        }
+    }
+    return res;
+}
+
+template <QuantizedElement T>
+std::vector<int16_t> packRhs(const T* rhs, const size_t& k, const size_t& m) {
+    const size_t pairs = (k + 1) / 2;
+    std::vector<int16_t> res(pairs * m * 2);
+    for (size_t p = 0; p < k; ++p)
+        for (size_t j = 0; j < m; ++j)
+            res[((p / 2) * m + j) * 2 + p % 2] = static_cast<int16_t>(rhs[p * m + j]);
+    return res;
+}
+
+// integer products of the quantized operands, with the row sums of lhs and column sums of rhs
+// that undo the zero points: sum (a - za)(b - zb) = sum ab - zb sum a - za sum b + k za zb
+template <QuantizedElement A, QuantizedElement B, size_t ROW, size_t COL, size_t U>
+void requantize(const Basic_Matrix<A, ROW, COL>& lhs, const Quantization& lhsQuantization, const Basic_Matrix<B, COL, U>& rhs, const Quantization& rhsQuantization, std::vector<int32_t>& product, std::vector<int64_t>& rowSums, std::vector<int64_t>& colSums) {
+    auto check = [](const Quantization& q, const size_t& count) {
+        if ((q.scales.size() != 1 && q.scales.size() != count) || (q.zeroPoints.size() != 1 && q.zeroPoints.size() != count))
+            throw std::invalid_argument("Quantization must have one entry or one per row / column");
+    };
+    check(lhsQuantization, ROW);
+    check(rhsQuantization, U);
+
+    const std::vector<int32_t> a = packLhs(lhs.data(), ROW, COL);
+    const std::vector<int16_t> b = packRhs(rhs.data(), COL, U);
+    product.resize(ROW * U);
+    quantizedProduct(a.data(), b.data(), product.data(), ROW, (COL + 1) / 2, U);
+
+    rowSums.assign(ROW, 0);
+    colSums.assign(U, 0);
+    for (size_t i = 0; i < ROW; ++i)
+        for (size_t p = 0; p < COL; ++p)
+            rowSums[i] += lhs(i, p);
+    for (size_t p = 0; p < COL; ++p)
+        for (size_t j = 0; j < U; ++j)
+            colSums[j] += rhs(p, j);
+}
+
+}
+
+// out = lhs * rhs with 32-bit accumulators, the operands are widened to 16 bits and the kernel
+// multiplies and adds pairs of them (vpmaddwd with AVX2)
+// sums of 8-bit products fit for an inner dimension up to 33025, 16-bit operands must leave room
+template <QuantizedElement A, QuantizedElement B, size_t ROW, size_t COL, size_t U>
+void multiply(const Basic_Matrix<A, ROW, COL>& lhs, const Basic_Matrix<B, COL, U>& rhs, Basic_Matrix<int32_t, ROW, U>& out) {
+    const std::vector<int32_t> a = detail::packLhs(lhs.data(), ROW, COL);
+    const std::vector<int16_t> b = detail::packRhs(rhs.data(), COL, U);
+    detail::quantizedProduct(a.data(), b.data(), out.data(), ROW, (COL + 1) / 2, U);
+}
+
+// real product of quantized operands: lhs quantized per row, rhs per column
+template <QuantizedElement A, QuantizedElement B, size_t ROW, size_t COL, size_t U>
+void multiply(const Basic_Matrix<A, ROW, COL>& lhs, const Quantization& lhsQuantization, const Basic_Matrix<B, COL, U>& rhs, const Quantization& rhsQuantization, Basic_Matrix<float, ROW, U>& out) {
+    std::vector<int32_t> product;
+    std::vector<int64_t> rowSums, colSums;
+    detail::requantize(lhs, lhsQuantization, rhs, rhsQuantization, product, rowSums, colSums);
+    for (size_t i = 0; i < ROW; ++i) {
+        const int64_t za = lhsQuantization.zeroPoint(i);
+        const float sa = lhsQuantization.scale(i);
+        for (size_t j = 0; j < U; ++j) {
+            const int64_t zb = rhsQuantization.zeroPoint(j);
+            const int64_t sum = product[i * U + j] - zb * rowSums[i] - za * colSums[j] + static_cast<int64_t>(COL) * za * zb;
+            out(i, j) = sa * rhsQuantization.scale(j) * static_cast<float>(sum);
+        }
+    }
+}
+
+// product of quantized operands requantized to int8 per column of out, rounded to nearest and saturated
+template <QuantizedElement A, QuantizedElement B, size_t ROW, size_t COL, size_t U>
+void multiply(const Basic_Matrix<A, ROW, COL>& lhs, const Quantization& lhsQuantization, const Basic_Matrix<B, COL, U>& rhs, const Quantization& rhsQuantization, Basic_Matrix<int8_t, ROW, U>& out, const Quantization& outQuantization) {
+    if ((outQuantization.scales.size() != 1 && outQuantization.scales.size() != U) || (outQuantization.zeroPoints.size() != 1 && outQuantization.zeroPoints.size() != U))
+        throw std::invalid_argument("Quantization must have one entry or one per row / column");
+    std::vector<int32_t> product;
+    std::vector<int64_t> rowSums, colSums;
+    detail::requantize(lhs, lhsQuantization, rhs, rhsQuantization, product, rowSums, colSums);
+    for (size_t i = 0; i < ROW; ++i) {
+        const int64_t za = lhsQuantization.zeroPoint(i);
+        const float sa = lhsQuantization.scale(i);
+        for (size_t j = 0; j < U; ++j) {
+            const int64_t zb = rhsQuantization.zeroPoint(j);
+            const int64_t sum = product[i * U + j] - zb * rowSums[i] - za * colSums[j] + static_cast<int64_t>(COL) * za * zb;
+            const float multiplier = sa * rhsQuantization.scale(j) / outQuantization.scale(j);
+            const long q = std::lrint(multiplier * static_cast<float>(sum)) + outQuantization.zeroPoint(j);
+            out(i, j) = static_cast<int8_t>(std::clamp<long>(q, INT8_MIN, INT8_MAX));
+        }
+    }
+}
+
+}
+
+#endif /* Quantized_hpp */
@@ -0,0 +1,256 @@
+#ifndef Reduction_hpp
+#define Reduction_hpp
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include <iterator>
+#include <array>
+#include <vector>
+#include <stdexcept>
+#include <bit>
+
+namespace vecxify {
+
+// modular arithmetic on residues below a 63-bit modulus, without hardware division
+// every engine keeps residues in its own form: toForm / fromForm convert from / to
+// the plain value, add / sub / neg / mul take and return residues in that form
+// all members are constexpr so an engine built from a template argument folds into constants
+
+class ModularBase {
+protected:
+    uint64_t _mod;
+
+public:
+    constexpr explicit ModularBase(const uint64_t& mod) noexcept : _mod { mod } {}
+
+    constexpr uint64_t modulus() const noexcept {
+        return _mod;
+    }
+
+    // lazy reduction: the sum of two residues is below 2 * mod, one conditional subtract is enough
+    constexpr uint64_t add(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        uint64_t res = lhs + rhs;
+        return res >= _mod ? res - _mod : res;
+    }
+
+    constexpr uint64_t sub(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        return lhs >= rhs ? lhs - rhs : lhs + _mod - rhs;
+    }
+
+    constexpr uint64_t neg(const uint64_t& x) const noexcept {
+        return x ? _mod - x : 0;
+    }
+};
+
+// Montgomery form x * 2^64 mod m, m odd
+class MontgomeryReduction final : public ModularBase {
+private:
+    // -m^-1 mod 2^64
+    uint64_t _negInv;
+    // 2^128 mod m
+    uint64_t _r2;
+
+public:
+    constexpr explicit MontgomeryReduction(const uint64_t& mod) noexcept : ModularBase { mod }, _negInv { 0 }, _r2 { 0 } {
+        // Newton iteration doubles the number of correct low bits, m is its own inverse mod 8
+        uint64_t inv = mod;
+        for (int i = 0; i < 5; ++i)
+            inv *= 2 - mod * inv;
+        _negInv = -inv;
+        unsigned __int128 r = (-mod) % mod;
+        _r2 = static_cast<uint64_t>(r * r % mod);
+    }
+
+    // t * 2^-64 mod m, requires t < m * 2^64
+    constexpr uint64_t reduce(const unsigned __int128& t) const noexcept {
+        uint64_t q = static_cast<uint64_t>(t) * _negInv;
+        // t + q * m < 2 * m * 2^64 <= 2^128 because m < 2^63
+        uint64_t res = static_cast<uint64_t>((t + static_cast<unsigned __int128>(q) * _mod) >> 64);
+        return res >= _mod ? res - _mod : res;
+    }
+
+    constexpr uint64_t mul(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        return reduce(static_cast<unsigned __int128>(lhs) * rhs);
+    }
+
+    // largest argument of reduce, reduce of a sum of products of forms is the form of the sum
+    constexpr unsigned __int128 reduceLimit() const noexcept {
+        return (static_cast<unsigned __int128>(_mod) << 64) - 1;
+    }
+
+    // x < m
+    constexpr uint64_t toForm(const uint64_t& x) const noexcept {
+        return mul(x, _r2);
+    }
+
+    constexpr uint64_t fromForm(const uint64_t& x) const noexcept {
+        return reduce(x);
+    }
+};
+
+// Barrett reduction with mu = floor((2^128 - 1) / m), residues are plain values
+class BarrettReduction final : public ModularBase {
+private:
+    unsigned __int128 _mu;
+
+    // high 128 bits of the 256-bit product
+    static constexpr unsigned __int128 mulHigh(const unsigned __int128& lhs, const unsigned __int128& rhs) noexcept {
+        using u128 = unsigned __int128;
+        const uint64_t l0 = static_cast<uint64_t>(lhs), l1 = static_cast<uint64_t>(lhs >> 64);
+        const uint64_t r0 = static_cast<uint64_t>(rhs), r1 = static_cast<uint64_t>(rhs >> 64);
+        u128 p00 = u128{l0} * r0, p01 = u128{l0} * r1, p10 = u128{l1} * r0, p11 = u128{l1} * r1;
+        u128 mid = (p00 >> 64) + static_cast<uint64_t>(p01) + static_cast<uint64_t>(p10);
+        return p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+    }
+
+public:
+    constexpr explicit BarrettReduction(const uint64_t& mod) noexcept : ModularBase { mod }, _mu { ~static_cast<unsigned __int128>(0) / mod } {}
+
+    // t mod m, the estimated quotient is at most 2 below the real one
+    constexpr uint64_t reduce(const unsigned __int128& t) const noexcept {
+        unsigned __int128 res = t - mulHigh(t, _mu) * _mod;
+        while (res >= _mod)
+            res -= _mod;
+        return static_cast<uint64_t>(res);
+    }
+
+    constexpr uint64_t mul(const uint64_t& lhs, const uint64_t& rhs) const noexcept {
+        return reduce(static_cast<unsigned __int128>(lhs) * rhs);
+    }
+
+    // largest argument of reduce
+    constexpr unsigned __int128 reduceLimit() const noexcept {
+        return ~static_cast<unsigned __int128>(0);
+    }
+
+    constexpr uint64_t toForm(const uint64_t& x) const noexcept {
+        return x;
+    }
+
+    constexpr uint64_t fromForm(const uint64_t& x) const noexcept {
+        return x;
+    }
+};
+
+// engine for a modulus known at compile time, Montgomery when it is odd
+template <uint64_t N>
+using Reduction = std::conditional_t<N % 2 == 1, MontgomeryReduction, BarrettReduction>;
+
+namespace detail {
+
+// plain modular arithmetic with a 128-bit product, for values computed at compile time
+constexpr uint64_t mulModConstant(const uint64_t& lhs, const uint64_t& rhs, const uint64_t& mod) noexcept {
+    return static_cast<uint64_t>(static_cast<unsigned __int128>(lhs) * rhs % mod);
+}
+
+constexpr uint64_t powModConstant(uint64_t base, uint64_t exp, const uint64_t& mod) noexcept {
+    uint64_t res = 1 % mod;
+    for (base %= mod; exp; exp >>= 1, base = mulModConstant(base, base, mod)) {
+        if (exp & 1)
+            res = mulModConstant(res, base, mod);
+    }
+    return res;
+}
+
+}
+
+// deterministic Miller-Rabin, the first 12 primes as bases are enough below 2^64
+constexpr bool isPrime(const uint64_t& n) noexcept {
+    if (n < 2)
+        return false;
+    constexpr uint64_t bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+    for (const uint64_t& p : bases) {
+        if (n % p == 0)
+            return n == p;
+    }
+    const int shift = std::countr_zero(n - 1);
+    const uint64_t odd = (n - 1) >> shift;
+    for (const uint64_t& a : bases) {
+        uint64_t x = detail::powModConstant(a, odd, n);
+        if (x == 1 || x == n - 1)
+            continue;
+        bool composite = true;
+        for (int i = 1; i < shift && composite; ++i) {
+            x = detail::mulModConstant(x, x, n);
+            composite = x != n - 1;
+        }
+        if (composite)
+            return false;
+    }
+    return true;
+}
+
+// x^-1 mod m by the extended Euclidean algorithm, x in [0, m)
+// throws std::domain_error when x and m are not coprime
+constexpr uint64_t inverseMod(const uint64_t& x, const uint64_t& mod) {
+    // remainders r0 = m, r1 = x, ... with r_i = s_i * x (mod m)
+    // the coefficients s_i alternate in sign, only their magnitudes are tracked
+    uint64_t a = mod, b = x;
+    uint64_t s = 0, t = 1;
+    bool odd = false;
+    while (b) {
+        uint64_t q = a / b;
+        uint64_t r = a - q * b;
+        a = b, b = r;
+        uint64_t next = s + q * t;
+        s = t, t = next;
+        odd = !odd;
+    }
+    if (a != 1)
+        throw std::domain_error("value is not invertible");
+    // after k steps a = r_k and s = |s_k|, s_k is positive iff k is odd
+    return odd ? s % mod : (mod - s % mod) % mod;
+}
+
+// base^exp for a residue type with a fixed 4-bit window: 15 precomputed powers,
+// then four squarings and at most one multiplication per window, one is the unit of base's ring
+template <typename T>
+constexpr T windowPower(const T& base, const unsigned long long& exp, const T& one) {
+    constexpr int WINDOW = 4;
+    std::array<T, (1 << WINDOW)> table{};
+    table[0] = one;
+    for (size_t i = 1; i < table.size(); ++i)
+        table[i] = table[i - 1] * base;
+
+    T res = one;
+    for (int shift = 64 - WINDOW; shift >= 0; shift -= WINDOW) {
+        if (res != one) {
+            for (int i = 0; i < WINDOW; ++i)
+                res *= res;
+        }
+        res *= table[(exp >> shift) & ((1 << WINDOW) - 1)];
+    }
+    return res;
+}
+
+// replace every element of [first, last) by its inverse with Montgomery's trick:
+// one inversion and 3(n - 1) multiplications, throws std::domain_error if an element is not invertible
+template <typename It>
+void batchInverse(It first, It last) {
+    using T = typename std::iterator_traits<It>::value_type;
+    const size_t n = static_cast<size_t>(std::distance(first, last));
+    if (n == 0)
+        return;
+
+    // prefix[i] = x0 * ... * xi
+    std::vector<T> prefix{};
+    prefix.reserve(n);
+    for (It it = first; it != last; ++it)
+        prefix.push_back(prefix.empty() ? *it : prefix.back() * *it);
+
+    T inverse = prefix.back().inv();
+    It it = last;
+    for (size_t i = n; i-- > 1; ) {
+        --it;
+        // (x0 ... xi)^-1 * (x0 ... xi-1) = xi^-1
+        T next = inverse * *it;
+        *it = inverse * prefix[i - 1];
+        inverse = next;
+    }
+    *first = inverse;
+}
+
+}
+
+#endif /* Reduction_hpp */
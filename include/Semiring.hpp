@@ -0,0 +1,353 @@
+#ifndef Semiring_hpp
+#define Semiring_hpp
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <concepts>
+#include <algorithm>
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+// a semiring for matrix products: add and mul over Element, zero is the identity of add and
+// absorbs under mul, one is the identity of mul
+// a custom semiring is any struct with these static members, see MinPlus below
+template <typename S>
+concept Semiring = requires (const typename S::Element& x) {
+    { S::zero() } -> std::convertible_to<typename S::Element>;
+    { S::one() } -> std::convertible_to<typename S::Element>;
+    { S::add(x, x) } -> std::convertible_to<typename S::Element>;
+    { S::mul(x, x) } -> std::convertible_to<typename S::Element>;
+};
+
+namespace detail {
+
+template <typename T>
+constexpr T positiveInfinity() noexcept {
+    if constexpr (std::numeric_limits<T>::has_infinity)
+        return std::numeric_limits<T>::infinity();
+    else
+        return std::numeric_limits<T>::max();
+}
+
+template <typename T>
+constexpr T negativeInfinity() noexcept {
+    if constexpr (std::numeric_limits<T>::has_infinity)
+        return -std::numeric_limits<T>::infinity();
+    else
+        return std::numeric_limits<T>::lowest();
+}
+
+// lhs + rhs where zero absorbs, integers have no infinity to do it by themselves
+template <typename T>
+constexpr T absorbingSum(const T& lhs, const T& rhs, const T& zero) noexcept {
+    if constexpr (std::numeric_limits<T>::has_infinity)
+        return lhs + rhs;
+    else
+        return lhs == zero || rhs == zero ? zero : static_cast<T>(lhs + rhs);
+}
+
+}
+
+// the built-in semirings below also have
+//     template <typename V> static void accumulate(V& acc, const V& lhs, const V& rhs);
+// computing acc = add(acc, mul(lhs, rhs)) lane-wise on GCC vectors of Lane, which the matrix
+// kernels use when vectorizable is true (arithmetic elements)
+// integers stand for the infinities with max() and lowest(), sums of finite values must not overflow
+
+// ordinary arithmetic, matrix products over it are the usual ones (MatrixKernel, Strassen)
+template <typename T>
+struct PlusTimes {
+    using Element = T;
+    static constexpr bool vectorizable = false;
+
+    static T zero() { return T{}; }
+    static T one() { return 1; }
+    static T add(const T& lhs, const T& rhs) { return lhs + rhs; }
+    static T mul(const T& lhs, const T& rhs) { return lhs * rhs; }
+};
+
+// tropical semiring (min, +): products are shortest paths
+template <typename T>
+struct MinPlus {
+    using Element = T;
+    using Lane = T;
+    static constexpr bool vectorizable = std::is_arithmetic_v<T>;
+
+    static constexpr T zero() noexcept { return detail::positiveInfinity<T>(); }
+    static constexpr T one() noexcept { return T{}; }
+    static constexpr T add(const T& lhs, const T& rhs) noexcept { return std::min(lhs, rhs); }
+    static constexpr T mul(const T& lhs, const T& rhs) noexcept { return detail::absorbingSum(lhs, rhs, zero()); }
+
+    template <typename V>
+    static void accumulate(V& acc, const V& lhs, const V& rhs) noexcept {
+        V sum;
+        if constexpr (std::numeric_limits<T>::has_infinity) {
+            sum = lhs + rhs;
+        } else {
+            // zero() is the largest value, one comparison tells if either term is zero(); such
+            // lanes add 0 instead so only sums of finite values are formed (no signed overflow)
+            const V z = V{} + zero();
+            const auto infinite = (lhs < rhs ? rhs : lhs) == z;
+            sum = infinite ? z : (infinite ? V{} : lhs) + (infinite ? V{} : rhs);
+        }
+        acc = sum < acc ? sum : acc;
+    }
+};
+
+// (max, +): products are longest paths
+template <typename T>
+struct MaxPlus {
+    using Element = T;
+    using Lane = T;
+    static constexpr bool vectorizable = std::is_arithmetic_v<T>;
+
+    static constexpr T zero() noexcept { return detail::negativeInfinity<T>(); }
+    static constexpr T one() noexcept { return T{}; }
+    static constexpr T add(const T& lhs, const T& rhs) noexcept { return std::max(lhs, rhs); }
+    static constexpr T mul(const T& lhs, const T& rhs) noexcept { return detail::absorbingSum(lhs, rhs, zero()); }
+
+    template <typename V>
+    static void accumulate(V& acc, const V& lhs, const V& rhs) noexcept {
+        V sum;
+        if constexpr (std::numeric_limits<T>::has_infinity) {
+            sum = lhs + rhs;
+        } else {
+            // as MinPlus, zero() is the smallest value
+            const V z = V{} + zero();
+            const auto infinite = (lhs < rhs ? lhs : rhs) == z;
+            sum = infinite ? z : (infinite ? V{} : lhs) + (infinite ? V{} : rhs);
+        }
+        acc = acc < sum ? sum : acc;
+    }
+};
+
+// (max, min): products are bottleneck (widest) paths
+template <typename T>
+struct MaxMin {
+    using Element = T;
+    using Lane = T;
+    static constexpr bool vectorizable = std::is_arithmetic_v<T>;
+
+    static constexpr T zero() noexcept { return detail::negativeInfinity<T>(); }
+    static constexpr T one() noexcept { return detail::positiveInfinity<T>(); }
+    static constexpr T add(const T& lhs, const T& rhs) noexcept { return std::max(lhs, rhs); }
+    static constexpr T mul(const T& lhs, const T& rhs) noexcept { return std::min(lhs, rhs); }
+
+    template <typename V>
+    static void accumulate(V& acc, const V& lhs, const V& rhs) noexcept {
+        const V low = lhs < rhs ? lhs : rhs;
+        acc = acc < low ? low : acc;
+    }
+};
+
+// (or, and): products are reachability, bool is handled as bytes of 0 and 1
+struct Boolean {
+    using Element = bool;
+    using Lane = uint8_t;
+    static constexpr bool vectorizable = sizeof(bool) == 1;
+
+    static constexpr bool zero() noexcept { return false; }
+    static constexpr bool one() noexcept { return true; }
+    static constexpr bool add(const bool& lhs, const bool& rhs) noexcept { return lhs || rhs; }
+    static constexpr bool mul(const bool& lhs, const bool& rhs) noexcept { return lhs && rhs; }
+
+    template <typename V>
+    static void accumulate(V& acc, const V& lhs, const V& rhs) noexcept {
+        acc |= lhs & rhs;
+    }
+};
+
+namespace detail {
+
+template <typename S>
+concept VectorSemiring = Semiring<S> && S::vectorizable;
+
+// products over a semiring: the vector kernel keeps a tile of SEMIRING_ROWS rows by
+// SEMIRING_VECTORS vectors of out in registers while it runs through a block of SEMIRING_DEPTH
+// terms, the blocks of rhs it reads are panels of about SEMIRING_PANEL_BYTES that stay in
+// cache across the rows
+constexpr size_t SEMIRING_ROWS = 4;
+constexpr size_t SEMIRING_VECTORS = 2;
+constexpr size_t SEMIRING_DEPTH = 256;
+constexpr size_t SEMIRING_PANEL_BYTES = size_t{1} << 17;
+
+// products with at least this many multiply-adds split their rows across the shared pool
+constexpr size_t PARALLEL_SEMIRING_WORK = size_t{1} << 18;
+
+template <typename S, size_t BYTES, size_t ROWS>
+[[gnu::always_inline]] inline void semiringTile(const typename S::Lane* lhs, const size_t& lda, const typename S::Lane* rhs, const size_t& ldb, typename S::Lane* out, const size_t& ldc, const size_t& p0, const size_t& p1) noexcept {
+    using Lane = typename S::Lane;
+    constexpr size_t WIDTH = BYTES / sizeof(Lane);
+    typedef Lane Vector __attribute__((vector_size(BYTES)));
+
+    Vector acc[ROWS][SEMIRING_VECTORS];
+    for (size_t r = 0; r < ROWS; ++r) {
+        for (size_t c = 0; c < SEMIRING_VECTORS; ++c)
+            std::memcpy(&acc[r][c], out + r * ldc + c * WIDTH, BYTES);
+    }
+    for (size_t p = p0; p < p1; ++p) {
+        Vector b[SEMIRING_VECTORS];
+        for (size_t c = 0; c < SEMIRING_VECTORS; ++c)
+            std::memcpy(&b[c], rhs + p * ldb + c * WIDTH, BYTES);
+        for (size_t r = 0; r < ROWS; ++r) {
+            const Vector a = Vector{} + lhs[r * lda + p];
+            for (size_t c = 0; c < SEMIRING_VECTORS; ++c)
+                S::accumulate(acc[r][c], a, b[c]);
+        }
+    }
+    for (size_t r = 0; r < ROWS; ++r) {
+        for (size_t c = 0; c < SEMIRING_VECTORS; ++c)
+            std::memcpy(out + r * ldc + c * WIDTH, &acc[r][c], BYTES);
+    }
+}
+
+// rows [first, last) of out (n x m) accumulate the product of lhs (n x k) and rhs (k x m),
+// all row-major with leading dimensions lda, ldb and ldc
+template <typename S, size_t BYTES>
+[[gnu::always_inline]] inline void semiringRows(const typename S::Lane* lhs, const size_t& lda, const typename S::Lane* rhs, const size_t& ldb, typename S::Lane* out, const size_t& ldc, const size_t& first, const size_t& last, const size_t& k, const size_t& m) noexcept {
+    using Lane = typename S::Lane;
+    constexpr size_t TILE = SEMIRING_VECTORS * BYTES / sizeof(Lane);
+    constexpr size_t PANEL = std::max(TILE, SEMIRING_PANEL_BYTES / (SEMIRING_DEPTH * sizeof(Lane)) / TILE * TILE);
+
+    for (size_t j0 = 0; j0 < m; j0 += PANEL) {
+        const size_t j1 = std::min(m, j0 + PANEL);
+        for (size_t p0 = 0; p0 < k; p0 += SEMIRING_DEPTH) {
+            const size_t p1 = std::min(k, p0 + SEMIRING_DEPTH);
+            for (size_t i = first; i < last; i += SEMIRING_ROWS) {
+                const size_t rows = std::min(SEMIRING_ROWS, last - i);
+                const Lane* a = lhs + i * lda;
+                Lane* c = out + i * ldc;
+                size_t j = j0;
+                for ( ; j + TILE <= j1; j += TILE) {
+                    switch (rows) {
+                        case 4: semiringTile<S, BYTES, 4>(a, lda, rhs + j, ldb, c + j, ldc, p0, p1); break;
+                        case 3: semiringTile<S, BYTES, 3>(a, lda, rhs + j, ldb, c + j, ldc, p0, p1); break;
+                        case 2: semiringTile<S, BYTES, 2>(a, lda, rhs + j, ldb, c + j, ldc, p0, p1); break;
+                        default: semiringTile<S, BYTES, 1>(a, lda, rhs + j, ldb, c + j, ldc, p0, p1); break;
+                    }
+                }
+                // columns that do not fill a tile
+                for (size_t r = 0; r < rows; ++r) {
+                    for (size_t p = p0; p < p1; ++p) {
+                        for (size_t t = j; t < j1; ++t)
+                            c[r * ldc + t] = S::add(c[r * ldc + t], S::mul(a[r * lda + p], rhs[p * ldb + t]));
+                    }
+                }
+            }
+        }
+    }
+}
+
+#if VECXIFY_SIMD_DISPATCH
+template <typename S>
+__attribute__((target("avx512f"))) void semiringRowsAvx512(const typename S::Lane* lhs, const size_t& lda, const typename S::Lane* rhs, const size_t& ldb, typename S::Lane* out, const size_t& ldc, const size_t& first, const size_t& last, const size_t& k, const size_t& m) noexcept {
+    semiringRows<S, 64>(lhs, lda, rhs, ldb, out, ldc, first, last, k, m);
+}
+
+template <typename S>
+__attribute__((target("avx2"))) void semiringRowsAvx2(const typename S::Lane* lhs, const size_t& lda, const typename S::Lane* rhs, const size_t& ldb, typename S::Lane* out, const size_t& ldc, const size_t& first, const size_t& last, const size_t& k, const size_t& m) noexcept {
+    semiringRows<S, 32>(lhs, lda, rhs, ldb, out, ldc, first, last, k, m);
+}
+#endif
+
+// any other semiring: one row of out at a time, terms equal to zero() skipped
+template <typename S>
+void semiringRowsGeneric(const typename S::Element* lhs, const size_t& lda, const typename S::Element* rhs, const size_t& ldb, typename S::Element* out, const size_t& ldc, const size_t& first, const size_t& last, const size_t& k, const size_t& m) {
+    using T = typename S::Element;
+    for (size_t i = first; i < last; ++i) {
+        for (size_t p = 0; p < k; ++p) {
+            const T& a = lhs[i * lda + p];
+            if constexpr (std::equality_comparable<T>) {
+                if (a == S::zero())
+                    continue;
+            }
+            for (size_t j = 0; j < m; ++j)
+                out[i * ldc + j] = S::add(out[i * ldc + j], S::mul(a, rhs[p * ldb + j]));
+        }
+    }
+}
+
+// out = add(out, lhs * rhs) on rows [first, last), with the widest kernel of this CPU
+// the operands are views with leading dimensions, see semiringRows
+template <Semiring S>
+void semiringAccumulate(const typename S::Element* lhs, const size_t& lda, const typename S::Element* rhs, const size_t& ldb, typename S::Element* out, const size_t& ldc, const size_t& first, const size_t& last, const size_t& k, const size_t& m) {
+    if constexpr (VectorSemiring<S>) {
+        using Lane = typename S::Lane;
+        static_assert(sizeof(Lane) == sizeof(typename S::Element), "Lane must be laid out as the element");
+        const Lane* a = reinterpret_cast<const Lane*>(lhs);
+        const Lane* b = reinterpret_cast<const Lane*>(rhs);
+        Lane* c = reinterpret_cast<Lane*>(out);
+        switch (simdIsa()) {
+#if VECXIFY_SIMD_DISPATCH
+            case SimdIsa::avx512:
+                semiringRowsAvx512<S>(a, lda, b, ldb, c, ldc, first, last, k, m);
+                return;
+            case SimdIsa::avx2:
+                semiringRowsAvx2<S>(a, lda, b, ldb, c, ldc, first, last, k, m);
+                return;
+#endif
+            default:
+                semiringRows<S, 16>(a, lda, b, ldb, c, ldc, first, last, k, m);
+                return;
+        }
+    } else {
+        semiringRowsGeneric<S>(lhs, lda, rhs, ldb, out, ldc, first, last, k, m);
+    }
+}
+
+// ordinary arithmetic for the kernels above: out += lhs * rhs, or out -= lhs * rhs when SUBTRACT
+// (mul is then the negated product), the level-3 updates of Factorization.hpp and the products of
+// PowerCache.hpp run on them
+template <typename T, bool SUBTRACT>
+struct ProductUpdate {
+    using Element = T;
+    using Lane = T;
+    static constexpr bool vectorizable = std::is_arithmetic_v<T>;
+
+    static T zero() { return T{}; }
+    static T one() { return 1; }
+    static T add(const T& lhs, const T& rhs) { return lhs + rhs; }
+    static T mul(const T& lhs, const T& rhs) { return SUBTRACT ? -(lhs * rhs) : lhs * rhs; }
+
+    template <typename V>
+    static void accumulate(V& acc, const V& lhs, const V& rhs) noexcept {
+        if constexpr (SUBTRACT)
+            acc -= lhs * rhs;
+        else
+            acc += lhs * rhs;
+    }
+};
+
+// out = lhs * rhs for row-major lhs (n x k), rhs (k x m) and out (n x m) with leading dimensions
+// lda, ldb and ldc, the elements of out past m in a row are left alone
+template <Semiring S>
+void semiringMultiply(const typename S::Element* lhs, const size_t& lda, const typename S::Element* rhs, const size_t& ldb, typename S::Element* out, const size_t& ldc, const size_t& n, const size_t& k, const size_t& m) {
+    for (size_t i = 0; i < n; ++i)
+        std::fill(out + i * ldc, out + i * ldc + m, typename S::Element(S::zero()));
+
+    auto rows = [&](const size_t& first, const size_t& last) {
+        semiringAccumulate<S>(lhs, lda, rhs, ldb, out, ldc, first, last, k, m);
+    };
+
+    if (n * k * m >= PARALLEL_SEMIRING_WORK)
+        ThreadPool::shared().parallelFor(0, n, std::max<size_t>(SEMIRING_ROWS, PARALLEL_SEMIRING_WORK / std::max<size_t>(k * m, 1)), rows);
+    else
+        rows(0, n);
+}
+
+// out = lhs * rhs for contiguous row-major lhs (n x k), rhs (k x m) and out (n x m)
+template <Semiring S>
+void semiringMultiply(const typename S::Element* lhs, const typename S::Element* rhs, typename S::Element* out, const size_t& n, const size_t& k, const size_t& m) {
+    semiringMultiply<S>(lhs, k, rhs, m, out, m, n, k, m);
+}
+
+}
+
+}
+
+#endif /* Semiring_hpp */
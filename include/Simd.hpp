@@ -0,0 +1,68 @@
+#ifndef Simd_hpp
+#define Simd_hpp
+
+#include <algorithm>
+#include <atomic>
+
+// on x86-64 GCC / Clang the vector kernels of the library have AVX2 and AVX-512 versions,
+// picked at runtime from the CPU the program runs on, every other build uses portable loops
+#if defined(__GNUC__) && defined(__x86_64__)
+#define VECXIFY_SIMD_DISPATCH 1
+#include <immintrin.h>
+#define VECXIFY_SIMD_AVX2 __attribute__((target("avx2"), always_inline))
+#define VECXIFY_SIMD_AVX512 __attribute__((target("avx512f"), always_inline))
+#else
+#define VECXIFY_SIMD_DISPATCH 0
+#endif
+
+namespace vecxify {
+
+namespace detail {
+
+enum class SimdIsa { scalar, avx2, avx512 };
+
+// widest instruction set of this CPU the vector kernels have a version for, detected once
+inline SimdIsa detectedSimdIsa() noexcept {
+#if VECXIFY_SIMD_DISPATCH
+    static const SimdIsa isa = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+            return SimdIsa::avx512;
+        if (__builtin_cpu_supports("avx2"))
+            return SimdIsa::avx2;
+        return SimdIsa::scalar;
+    }();
+    return isa;
+#else
+    return SimdIsa::scalar;
+#endif
+}
+
+// widest instruction set the kernels may dispatch to, lowered by SimdIsaScope
+inline std::atomic<SimdIsa> simdIsaLimit{SimdIsa::avx512};
+
+// instruction set the vector kernels dispatch to
+inline SimdIsa simdIsa() noexcept {
+    return std::min(detectedSimdIsa(), simdIsaLimit.load(std::memory_order_relaxed));
+}
+
+// caps the dispatched instruction set while alive, so tests reach the narrower kernels of a
+// CPU that has wider ones; not meant to be nested across threads
+class SimdIsaScope final {
+    SimdIsa _previous;
+    
+public:
+    explicit SimdIsaScope(const SimdIsa& limit) noexcept : _previous{simdIsaLimit.exchange(limit)} {}
+    
+    SimdIsaScope(const SimdIsaScope&) = delete;
+    SimdIsaScope& operator=(const SimdIsaScope&) = delete;
+    
+    ~SimdIsaScope() {
+        simdIsaLimit.store(_previous);
+    }
+};
+}
+
+}
+
+#endif /* Simd_hpp */
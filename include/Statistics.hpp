@@ -0,0 +1,480 @@
+#ifndef Statistics_hpp
+#define Statistics_hpp
+
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include "Simd.hpp"
+#include "Execution.hpp"
+
+namespace vecxify {
+
+// position of the smallest or largest element, the first one in row-major order on ties
+template <typename T>
+struct Extremum {
+    T value;
+    size_t row;
+    size_t col;
+};
+
+namespace detail {
+
+// the vector loops keep this many vectors of partial results, enough to hide the latency of an add
+inline constexpr size_t REDUCE_ACCUMULATORS = 4;
+
+// floating-point sums add blocks of this many elements (rows for column sums) in the vector loops,
+// then the block sums pairwise: the rounding error grows with log2(n / REDUCE_BLOCK) instead of n
+inline constexpr size_t REDUCE_BLOCK = 256;
+inline constexpr size_t REDUCE_ROWS = 64;
+
+// the min / max loops find the extreme value of a block first, the position only in a block that improves
+inline constexpr size_t EXTREMUM_BLOCK = 1024;
+
+template <typename T>
+concept VectorElement = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// terms of a sum: the elements, their absolute values or their squares
+enum class Term { value, magnitude, square };
+
+// acc += the term of x, on scalars and GCC vectors alike
+template <Term TERM, typename T, typename V>
+[[gnu::always_inline]] inline void addTerm(V& acc, const V& x) noexcept {
+    if constexpr (TERM == Term::square)
+        acc += x * x;
+    else if constexpr (TERM == Term::magnitude && std::is_signed_v<T>)
+        acc += x < 0 ? -x : x;
+    else
+        acc += x;
+}
+
+template <Term TERM, typename T, size_t BYTES>
+[[gnu::always_inline]] inline T sumBlock(const T* x, const size_t& n) noexcept {
+    constexpr size_t WIDTH = BYTES / sizeof(T), STEP = WIDTH * REDUCE_ACCUMULATORS;
+    typedef T Vector __attribute__((vector_size(BYTES)));
+
+    Vector acc[REDUCE_ACCUMULATORS] = {};
+    size_t i = 0;
+    for ( ; i + STEP <= n; i += STEP) {
+        for (size_t a = 0; a < REDUCE_ACCUMULATORS; ++a) {
+            Vector v;
+            std::memcpy(&v, x + i + a * WIDTH, BYTES);
+            addTerm<TERM, T>(acc[a], v);
+        }
+    }
+    for (size_t w = REDUCE_ACCUMULATORS / 2; w > 0; w /= 2)
+        for (size_t a = 0; a < w; ++a)
+            acc[a] += acc[a + w];
+    T lanes[WIDTH];
+    std::memcpy(lanes, &acc[0], BYTES);
+    for (size_t w = WIDTH / 2; w > 0; w /= 2)
+        for (size_t l = 0; l < w; ++l)
+            lanes[l] += lanes[l + w];
+    T res = lanes[0];
+    for ( ; i < n; ++i)
+        addTerm<TERM, T>(res, x[i]);
+    return res;
+}
+
+// block sums merged like the carries of a binary counter, so only sums of as many blocks are added
+template <Term TERM, typename T, size_t BYTES>
+[[gnu::always_inline]] inline T sumElements(const T* x, const size_t& n) noexcept {
+    if constexpr (!std::is_floating_point_v<T>) {
+        return sumBlock<TERM, T, BYTES>(x, n);
+    } else {
+        T partial[64];
+        size_t depth = 0, blocks = 0;
+        for (size_t i = 0; i < n; i += REDUCE_BLOCK, ++blocks) {
+            T s = sumBlock<TERM, T, BYTES>(x + i, std::min(REDUCE_BLOCK, n - i));
+            for (size_t c = blocks; c & 1; c >>= 1)
+                s = partial[--depth] + s;
+            partial[depth++] = s;
+        }
+        T res{};
+        while (depth > 0)
+            res = partial[--depth] + res;
+        return res;
+    }
+}
+
+// out[j] = sum of the terms of column j over rows [first, last), rows of cols elements
+template <Term TERM, typename T, size_t BYTES>
+[[gnu::always_inline]] inline void addRows(const T* x, const size_t& cols, const size_t& first, const size_t& last, T* out) noexcept {
+    constexpr size_t WIDTH = BYTES / sizeof(T);
+    typedef T Vector __attribute__((vector_size(BYTES)));
+
+    for (size_t i = first; i < last; ++i) {
+        const T* row = x + i * cols;
+        size_t j = 0;
+        for ( ; j + WIDTH <= cols; j += WIDTH) {
+            Vector v, acc;
+            std::memcpy(&v, row + j, BYTES);
+            std::memcpy(&acc, out + j, BYTES);
+            addTerm<TERM, T>(acc, v);
+            std::memcpy(out + j, &acc, BYTES);
+        }
+        for ( ; j < cols; ++j)
+            addTerm<TERM, T>(out[j], row[j]);
+    }
+}
+
+// column sums of rows [first, last) into out, pairwise over blocks of rows as sumElements
+template <Term TERM, typename T, size_t BYTES>
+[[gnu::always_inline]] inline void columnSums(const T* x, const size_t& cols, const size_t& first, const size_t& last, T* out) {
+    std::fill(out, out + cols, T{});
+    if constexpr (!std::is_floating_point_v<T>) {
+        addRows<TERM, T, BYTES>(x, cols, first, last, out);
+    } else {
+        std::vector<T> partial;
+        size_t depth = 0, blocks = 0;
+        for (size_t i = first; i < last; i += REDUCE_ROWS, ++blocks) {
+            partial.resize(std::max(partial.size(), (depth + 1) * cols));
+            T* s = partial.data() + depth * cols;
+            std::fill(s, s + cols, T{});
+            addRows<TERM, T, BYTES>(x, cols, i, std::min(last, i + REDUCE_ROWS), s);
+            for (size_t c = blocks; c & 1; c >>= 1) {
+                T* below = s - cols;
+                for (size_t j = 0; j < cols; ++j)
+                    below[j] += s[j];
+                s = below;
+                --depth;
+            }
+            ++depth;
+        }
+        while (depth > 0) {
+            --depth;
+            for (size_t j = 0; j < cols; ++j)
+                out[j] = partial[depth * cols + j] + out[j];
+        }
+    }
+}
+
+// smallest (largest when LARGEST) of n >= 1 elements
+template <bool LARGEST, typename T, size_t BYTES>
+[[gnu::always_inline]] inline T extremeBlock(const T* x, const size_t& n) noexcept {
+    constexpr size_t WIDTH = BYTES / sizeof(T), STEP = WIDTH * REDUCE_ACCUMULATORS;
+    typedef T Vector __attribute__((vector_size(BYTES)));
+
+    T res = x[0];
+    size_t i = 0;
+    if (n >= STEP) {
+        Vector acc[REDUCE_ACCUMULATORS];
+        for (size_t a = 0; a < REDUCE_ACCUMULATORS; ++a)
+            std::memcpy(&acc[a], x + a * WIDTH, BYTES);
+        for (i = STEP; i + STEP <= n; i += STEP) {
+            for (size_t a = 0; a < REDUCE_ACCUMULATORS; ++a) {
+                Vector v;
+                std::memcpy(&v, x + i + a * WIDTH, BYTES);
+                acc[a] = LARGEST ? (v > acc[a] ? v : acc[a]) : (v < acc[a] ? v : acc[a]);
+            }
+        }
+        for (size_t a = 1; a < REDUCE_ACCUMULATORS; ++a)
+            acc[0] = LARGEST ? (acc[a] > acc[0] ? acc[a] : acc[0]) : (acc[a] < acc[0] ? acc[a] : acc[0]);
+        T lanes[WIDTH];
+        std::memcpy(lanes, &acc[0], BYTES);
+        res = lanes[0];
+        for (size_t l = 1; l < WIDTH; ++l)
+            res = LARGEST ? std::max(res, lanes[l]) : std::min(res, lanes[l]);
+    }
+    for ( ; i < n; ++i)
+        res = LARGEST ? std::max(res, x[i]) : std::min(res, x[i]);
+    return res;
+}
+
+// extreme element of [first, last) and its first index, a block is searched for the position only
+// when its extreme value beats the best so far
+template <bool LARGEST, typename T, size_t BYTES>
+[[gnu::always_inline]] inline void extremeElements(const T* x, const size_t& first, const size_t& last, T& value, size_t& index) noexcept {
+    value = x[first];
+    index = first;
+    for (size_t i = first; i < last; i += EXTREMUM_BLOCK) {
+        const size_t end = std::min(last, i + EXTREMUM_BLOCK);
+        const T block = extremeBlock<LARGEST, T, BYTES>(x + i, end - i);
+        if (LARGEST ? block > value : block < value) {
+            value = block;
+            index = static_cast<size_t>(std::find(x + i, x + end, block) - x);
+        }
+    }
+}
+
+#if VECXIFY_SIMD_DISPATCH
+template <Term TERM, typename T>
+__attribute__((target("avx512f"))) T sumElementsAvx512(const T* x, const size_t& n) noexcept {
+    return sumElements<TERM, T, 64>(x, n);
+}
+
+template <Term TERM, typename T>
+__attribute__((target("avx2"))) T sumElementsAvx2(const T* x, const size_t& n) noexcept {
+    return sumElements<TERM, T, 32>(x, n);
+}
+
+template <Term TERM, typename T>
+__attribute__((target("avx512f"))) void columnSumsAvx512(const T* x, const size_t& cols, const size_t& first, const size_t& last, T* out) {
+    columnSums<TERM, T, 64>(x, cols, first, last, out);
+}
+
+template <Term TERM, typename T>
+__attribute__((target("avx2"))) void columnSumsAvx2(const T* x, const size_t& cols, const size_t& first, const size_t& last, T* out) {
+    columnSums<TERM, T, 32>(x, cols, first, last, out);
+}
+
+template <bool LARGEST, typename T>
+__attribute__((target("avx512f"))) void extremeElementsAvx512(const T* x, const size_t& first, const size_t& last, T& value, size_t& index) noexcept {
+    extremeElements<LARGEST, T, 64>(x, first, last, value, index);
+}
+
+template <bool LARGEST, typename T>
+__attribute__((target("avx2"))) void extremeElementsAvx2(const T* x, const size_t& first, const size_t& last, T& value, size_t& index) noexcept {
+    extremeElements<LARGEST, T, 32>(x, first, last, value, index);
+}
+#endif
+
+// the kernels above with the widest vectors of this CPU, plain loops for other elements
+template <Term TERM, typename T>
+T sumRange(const T* x, const size_t& n) {
+    if constexpr (VectorElement<T>) {
+        switch (simdIsa()) {
+#if VECXIFY_SIMD_DISPATCH
+            case SimdIsa::avx512:
+                return sumElementsAvx512<TERM, T>(x, n);
+            case SimdIsa::avx2:
+                return sumElementsAvx2<TERM, T>(x, n);
+#endif
+            default:
+                return sumElements<TERM, T, 16>(x, n);
+        }
+    } else {
+        static_assert(TERM == Term::value, "Norms need arithmetic elements");
+        T res{};
+        for (size_t i = 0; i < n; ++i)
+            res = res + x[i];
+        return res;
+    }
+}
+
+template <Term TERM, typename T>
+std::vector<T> columnSumRange(const T* x, const size_t& cols, const size_t& first, const size_t& last) {
+    std::vector<T> res(cols);
+    if constexpr (VectorElement<T>) {
+        switch (simdIsa()) {
+#if VECXIFY_SIMD_DISPATCH
+            case SimdIsa::avx512:
+                columnSumsAvx512<TERM, T>(x, cols, first, last, res.data());
+                break;
+            case SimdIsa::avx2:
+                columnSumsAvx2<TERM, T>(x, cols, first, last, res.data());
+                break;
+#endif
+            default:
+                columnSums<TERM, T, 16>(x, cols, first, last, res.data());
+                break;
+        }
+    } else {
+        static_assert(TERM == Term::value, "Norms need arithmetic elements");
+        for (size_t i = first; i < last; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                res[j] = res[j] + x[i * cols + j];
+    }
+    return res;
+}
+
+// extreme value and its index as one result of the reductions, ties go to the smaller index
+template <typename T>
+struct Candidate {
+    T value;
+    size_t index;
+};
+
+template <bool LARGEST, typename T>
+Candidate<T> extremeRange(const T* x, const size_t& first, const size_t& last) {
+    static_assert(VectorElement<T>, "Extrema need arithmetic elements");
+    Candidate<T> res{};
+    switch (simdIsa()) {
+#if VECXIFY_SIMD_DISPATCH
+        case SimdIsa::avx512:
+            extremeElementsAvx512<LARGEST, T>(x, first, last, res.value, res.index);
+            break;
+        case SimdIsa::avx2:
+            extremeElementsAvx2<LARGEST, T>(x, first, last, res.value, res.index);
+            break;
+#endif
+        default:
+            extremeElements<LARGEST, T, 16>(x, first, last, res.value, res.index);
+            break;
+    }
+    return res;
+}
+
+// leaf(first, last) over [0, n) in one range for seq, halves of fixed ranges merged by op otherwise
+template <typename U, execution::Policy P, typename Leaf, typename Op>
+U reduceElements(const P& policy, const size_t& n, Leaf leaf, Op op) {
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        return leaf(size_t{0}, n);
+    else
+        return reduceRange<U>(0, n, policy.grain, op, leaf);
+}
+
+template <bool LARGEST, execution::Policy P, typename T, size_t ROW, size_t COL>
+Extremum<T> extremum(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    static_assert(ROW * COL > 0, "Extrema need elements");
+    const T* x = m.data();
+    const Candidate<T> res = reduceElements<Candidate<T>>(policy, ROW * COL,
+        [x](const size_t& first, const size_t& last) { return extremeRange<LARGEST>(x, first, last); },
+        [](const Candidate<T>& lhs, const Candidate<T>& rhs) { return (LARGEST ? rhs.value > lhs.value : rhs.value < lhs.value) ? rhs : lhs; });
+    return Extremum<T>{res.value, res.index / COL, res.index % COL};
+}
+
+template <Term TERM, execution::Policy P, typename T, size_t ROW, size_t COL>
+T reduceSum(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    const T* x = m.data();
+    return reduceElements<T>(policy, ROW * COL,
+        [x](const size_t& first, const size_t& last) { return sumRange<TERM>(x + first, last - first); },
+        [](const T& lhs, const T& rhs) { return lhs + rhs; });
+}
+
+// out[i] = sum of the terms of row i, rows split by the policy
+template <Term TERM, execution::Policy P, typename T, size_t ROW, size_t COL>
+void reduceRows(const P& policy, const Basic_Matrix<T, ROW, COL>& m, T* out) {
+    const T* x = m.data();
+    auto rows = [&](const size_t& first, const size_t& last) {
+        for (size_t i = first; i < last; ++i)
+            out[i] = sumRange<TERM>(x + i * COL, COL);
+    };
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        rows(0, ROW);
+    else
+        ThreadPool::shared().parallelFor(0, ROW, std::max<size_t>(policyGrain(policy) / std::max<size_t>(COL, 1), 1), rows);
+}
+
+// sums of the terms of every column, ranges of rows merged pairwise
+template <Term TERM, execution::Policy P, typename T, size_t ROW, size_t COL>
+std::vector<T> reduceColumns(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    const T* x = m.data();
+    const size_t rowGrain = std::max<size_t>(policyGrain(policy) / std::max<size_t>(COL, 1), 1);
+    auto leaf = [x](const size_t& first, const size_t& last) { return columnSumRange<TERM>(x, COL, first, last); };
+    auto op = [](std::vector<T> lhs, const std::vector<T>& rhs) {
+        for (size_t j = 0; j < COL; ++j)
+            lhs[j] = lhs[j] + rhs[j];
+        return lhs;
+    };
+    if constexpr (std::is_same_v<P, execution::SequencedPolicy>)
+        return leaf(size_t{0}, ROW);
+    else
+        return reduceRange<std::vector<T>>(0, ROW, rowGrain, op, leaf);
+}
+
+}
+
+// the reductions below run multi-accumulator vector loops (AVX2 / AVX-512 when the CPU has them)
+// floating-point sums are pairwise over blocks, integer sums are taken in T and may overflow
+// every one takes an optional execution policy first (see Execution.hpp), par and par_unseq split
+// the elements in a fixed tree of ranges so the result does not depend on the threads
+// the order of elements does not matter to them, NaN elements give unspecified extrema
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+T sum(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    return detail::reduceSum<detail::Term::value>(policy, m);
+}
+
+template <typename T, size_t ROW, size_t COL>
+T sum(const Basic_Matrix<T, ROW, COL>& m) {
+    return sum(execution::seq, m);
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+Vec<T, ROW> rowSums(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    Vec<T, ROW> res;
+    detail::reduceRows<detail::Term::value>(policy, m, &res(0));
+    return res;
+}
+
+template <typename T, size_t ROW, size_t COL>
+Vec<T, ROW> rowSums(const Basic_Matrix<T, ROW, COL>& m) {
+    return rowSums(execution::seq, m);
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+Vec<T, COL> colSums(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    const std::vector<T> sums = detail::reduceColumns<detail::Term::value>(policy, m);
+    Vec<T, COL> res;
+    std::copy(sums.begin(), sums.end(), &res(0));
+    return res;
+}
+
+template <typename T, size_t ROW, size_t COL>
+Vec<T, COL> colSums(const Basic_Matrix<T, ROW, COL>& m) {
+    return colSums(execution::seq, m);
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+Extremum<T> min(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    return detail::extremum<false>(policy, m);
+}
+
+template <typename T, size_t ROW, size_t COL>
+Extremum<T> min(const Basic_Matrix<T, ROW, COL>& m) {
+    return min(execution::seq, m);
+}
+
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+Extremum<T> max(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    return detail::extremum<true>(policy, m);
+}
+
+template <typename T, size_t ROW, size_t COL>
+Extremum<T> max(const Basic_Matrix<T, ROW, COL>& m) {
+    return max(execution::seq, m);
+}
+
+// sqrt of the sum of squares, a double for integer elements
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+auto frobeniusNorm(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    return std::sqrt(detail::reduceSum<detail::Term::square>(policy, m));
+}
+
+template <typename T, size_t ROW, size_t COL>
+auto frobeniusNorm(const Basic_Matrix<T, ROW, COL>& m) {
+    return frobeniusNorm(execution::seq, m);
+}
+
+// largest sum of absolute values of a column
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+T norm1(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    const std::vector<T> sums = detail::reduceColumns<detail::Term::magnitude>(policy, m);
+    return *std::max_element(sums.begin(), sums.end());
+}
+
+template <typename T, size_t ROW, size_t COL>
+T norm1(const Basic_Matrix<T, ROW, COL>& m) {
+    return norm1(execution::seq, m);
+}
+
+// largest sum of absolute values of a row
+template <execution::Policy P, typename T, size_t ROW, size_t COL>
+T normInf(const P& policy, const Basic_Matrix<T, ROW, COL>& m) {
+    std::vector<T> sums(ROW);
+    detail::reduceRows<detail::Term::magnitude>(policy, m, sums.data());
+    return *std::max_element(sums.begin(), sums.end());
+}
+
+template <typename T, size_t ROW, size_t COL>
+T normInf(const Basic_Matrix<T, ROW, COL>& m) {
+    return normInf(execution::seq, m);
+}
+
+template <typename T, size_t N>
+T trace(const Basic_Matrix<T, N, N>& m) {
+    const T* x = m.data();
+    T res{};
+    for (size_t i = 0; i < N; ++i)
+        res = res + x[i * (N + 1)];
+    return res;
+}
+
+}
+
+#endif /* Statistics_hpp */
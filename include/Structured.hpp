@@ -0,0 +1,609 @@
+#ifndef Structured_hpp
+#define Structured_hpp
+
+#include <iostream>
+#include <array>
+#include <cstddef>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include "Matrix.hpp"
+#include "Vector.hpp"
+
+namespace vecxify {
+
+// square matrices that store only their structured part, with kernels whose cost follows
+// the stored entries: products with vectors, rank-k updates, triangular solves, banded
+// LU / Cholesky
+//     SymMat<T, N>            symmetric, lower triangle packed row by row, N (N + 1) / 2 entries
+//     TriMat<T, N, Triangle>  triangular, packed the same way (upper rows start at the diagonal)
+//     BandMat<T, N, KL, KU>   KL subdiagonals and KU superdiagonals in LAPACK band storage,
+//                             (KL + KU + 1) x N entries
+//     SymBandMat<T, N, K>     symmetric with K subdiagonals, lower band storage, (K + 1) x N entries
+
+enum class Triangle { lower, upper };
+
+template <typename T, size_t N, Triangle UPLO>
+class TriMat;
+
+template <typename T, size_t N, size_t KL, size_t KU>
+class BandLU;
+
+template <typename T, size_t N, size_t K>
+class BandCholesky;
+
+namespace detail {
+
+template <typename T>
+T checkedSqrt(const T& x) {
+    using std::sqrt;
+    if (!(x > T{}))
+        throw std::domain_error("Matrix is not positive definite");
+    return sqrt(x);
+}
+
+inline void checkPivot(const bool& zero) {
+    if (zero)
+        throw std::domain_error("Matrix is singular");
+}
+
+}
+
+template <typename T, size_t N, Triangle UPLO>
+class TriMat {
+
+    static_assert(N != 0, "Dimension of matrix must be positive");
+
+public:
+
+    static constexpr size_t SIZE = N * (N + 1) / 2;
+
+private:
+
+    std::array<T, SIZE> _data{};
+
+    // first entry of row i, the row runs from column 0 (lower) or column i (upper) to the diagonal / the end
+    static constexpr size_t rowStart(const size_t& i) noexcept {
+        if constexpr (UPLO == Triangle::lower)
+            return i * (i + 1) / 2;
+        else
+            return i * N - i * (i - 1) / 2;
+    }
+
+    static constexpr size_t index(const size_t& i, const size_t& j) noexcept {
+        return UPLO == Triangle::lower ? rowStart(i) + j : rowStart(i) + j - i;
+    }
+
+public:
+
+    TriMat() = default;
+
+    // the entries of m outside the triangle are ignored
+    explicit TriMat(const Basic_Matrix<T, N, N>& m) {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                if (contains(i, j))
+                    _data[index(i, j)] = m(i, j);
+    }
+
+    static constexpr bool contains(const size_t& i, const size_t& j) noexcept {
+        return UPLO == Triangle::lower ? j <= i : i <= j;
+    }
+
+    std::array<T, SIZE>& packed() noexcept {
+        return _data;
+    }
+
+    const std::array<T, SIZE>& packed() const noexcept {
+        return _data;
+    }
+
+    // only entries inside the triangle can be written
+    T& operator()(const size_t& i, const size_t& j) noexcept {
+        assert(i < N && j < N && contains(i, j) && "Entry outside the triangle");
+        return _data[index(i, j)];
+    }
+
+    T operator()(const size_t& i, const size_t& j) const noexcept {
+        assert(i < N && j < N && "Matrix index out of range");
+        return contains(i, j) ? _data[index(i, j)] : T{};
+    }
+
+    Mat<T, N, N> toMat() const {
+        Mat<T, N, N> res;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                res(i, j) = (*this)(i, j);
+        return res;
+    }
+
+    TriMat<T, N, UPLO == Triangle::lower ? Triangle::upper : Triangle::lower> transpose() const {
+        TriMat<T, N, UPLO == Triangle::lower ? Triangle::upper : Triangle::lower> res;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                if (contains(i, j))
+                    res(j, i) = _data[index(i, j)];
+        return res;
+    }
+
+    T determinant() const {
+        T res = _data[index(0, 0)];
+        for (size_t i = 1; i < N; ++i)
+            res *= _data[index(i, i)];
+        return res;
+    }
+
+    Vec<T, N> operator*(const Vec<T, N>& x) const {
+        Vec<T, N> res;
+        for (size_t i = 0; i < N; ++i) {
+            const T* row = _data.data() + rowStart(i);
+            const size_t first = UPLO == Triangle::lower ? 0 : i, last = UPLO == Triangle::lower ? i + 1 : N;
+            T sum{};
+            for (size_t j = first; j < last; ++j)
+                sum += row[j - (UPLO == Triangle::lower ? 0 : i)] * x(j);
+            res(i) = sum;
+        }
+        return res;
+    }
+
+    // x such that this * x = b, by forward (lower) or back (upper) substitution
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        Vec<T, N> x = b;
+        for (size_t step = 0; step < N; ++step) {
+            const size_t i = UPLO == Triangle::lower ? step : N - 1 - step;
+            const T* row = _data.data() + rowStart(i);
+            T sum = x(i);
+            if constexpr (UPLO == Triangle::lower) {
+                for (size_t j = 0; j < i; ++j)
+                    sum -= row[j] * x(j);
+            } else {
+                for (size_t j = i + 1; j < N; ++j)
+                    sum -= row[j - i] * x(j);
+            }
+            const T& diagonal = row[UPLO == Triangle::lower ? i : 0];
+            detail::checkPivot(diagonal == T{});
+            x(i) = sum / diagonal;
+        }
+        return x;
+    }
+
+    // X such that this * X = B, the rows of X are updated as a whole
+    template <size_t K>
+    Mat<T, N, K> solve(const Basic_Matrix<T, N, K>& b) const {
+        Mat<T, N, K> x;
+        for (size_t step = 0; step < N; ++step) {
+            const size_t i = UPLO == Triangle::lower ? step : N - 1 - step;
+            const T* row = _data.data() + rowStart(i);
+            for (size_t c = 0; c < K; ++c)
+                x(i, c) = b(i, c);
+            const size_t first = UPLO == Triangle::lower ? 0 : i + 1, last = UPLO == Triangle::lower ? i : N;
+            for (size_t j = first; j < last; ++j) {
+                const T& a = row[j - (UPLO == Triangle::lower ? 0 : i)];
+                for (size_t c = 0; c < K; ++c)
+                    x(i, c) -= a * x(j, c);
+            }
+            const T& diagonal = row[UPLO == Triangle::lower ? i : 0];
+            detail::checkPivot(diagonal == T{});
+            for (size_t c = 0; c < K; ++c)
+                x(i, c) /= diagonal;
+        }
+        return x;
+    }
+};
+
+template <typename T, size_t N>
+class SymMat {
+
+    static_assert(N != 0, "Dimension of matrix must be positive");
+
+public:
+
+    static constexpr size_t SIZE = N * (N + 1) / 2;
+
+private:
+
+    // lower triangle, row i holds columns 0 to i
+    std::array<T, SIZE> _data{};
+
+    static constexpr size_t index(const size_t& i, const size_t& j) noexcept {
+        return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i;
+    }
+
+public:
+
+    SymMat() = default;
+
+    // m is assumed symmetric, its lower triangle is kept
+    explicit SymMat(const Basic_Matrix<T, N, N>& m) {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j <= i; ++j)
+                _data[index(i, j)] = m(i, j);
+    }
+
+    std::array<T, SIZE>& packed() noexcept {
+        return _data;
+    }
+
+    const std::array<T, SIZE>& packed() const noexcept {
+        return _data;
+    }
+
+    // (i, j) and (j, i) are the same entry
+    T& operator()(const size_t& i, const size_t& j) noexcept {
+        assert(i < N && j < N && "Matrix index out of range");
+        return _data[index(i, j)];
+    }
+
+    const T& operator()(const size_t& i, const size_t& j) const noexcept {
+        assert(i < N && j < N && "Matrix index out of range");
+        return _data[index(i, j)];
+    }
+
+    Mat<T, N, N> toMat() const {
+        Mat<T, N, N> res;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                res(i, j) = (*this)(i, j);
+        return res;
+    }
+
+    // every stored entry is read once and used for both of its positions
+    Vec<T, N> operator*(const Vec<T, N>& x) const {
+        Vec<T, N> res;
+        for (size_t i = 0; i < N; ++i) {
+            const T* row = _data.data() + i * (i + 1) / 2;
+            T sum{};
+            for (size_t j = 0; j < i; ++j) {
+                sum += row[j] * x(j);
+                res(j) += row[j] * x(i);
+            }
+            res(i) += sum + row[i] * x(i);
+        }
+        return res;
+    }
+
+    // this += alpha * a * a^T, only the lower half of the product is computed
+    template <size_t K>
+    SymMat<T, N>& rankUpdate(const T& alpha, const Basic_Matrix<T, N, K>& a) {
+        for (size_t i = 0; i < N; ++i) {
+            T* row = _data.data() + i * (i + 1) / 2;
+            for (size_t j = 0; j <= i; ++j) {
+                T sum{};
+                for (size_t p = 0; p < K; ++p)
+                    sum += a(i, p) * a(j, p);
+                row[j] += alpha * sum;
+            }
+        }
+        return *this;
+    }
+
+    // this += alpha * x * x^T
+    SymMat<T, N>& rankUpdate(const T& alpha, const Vec<T, N>& x) {
+        for (size_t i = 0; i < N; ++i) {
+            T* row = _data.data() + i * (i + 1) / 2;
+            const T scaled = alpha * x(i);
+            for (size_t j = 0; j <= i; ++j)
+                row[j] += scaled * x(j);
+        }
+        return *this;
+    }
+
+    // lower L with this = L * L^T, the matrix must be positive definite
+    // L is packed like this, both rows of every dot product are contiguous
+    TriMat<T, N, Triangle::lower> cholesky() const {
+        TriMat<T, N, Triangle::lower> res;
+        T* l = res.packed().data();
+        for (size_t i = 0; i < N; ++i) {
+            T* rowI = l + i * (i + 1) / 2;
+            for (size_t j = 0; j <= i; ++j) {
+                const T* rowJ = l + j * (j + 1) / 2;
+                T sum = _data[index(i, j)];
+                for (size_t p = 0; p < j; ++p)
+                    sum -= rowI[p] * rowJ[p];
+                rowI[j] = i == j ? detail::checkedSqrt(sum) : sum / rowJ[j];
+            }
+        }
+        return res;
+    }
+
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        const TriMat<T, N, Triangle::lower> l = cholesky();
+        return l.transpose().solve(l.solve(b));
+    }
+};
+
+template <typename T, size_t N, size_t KL, size_t KU>
+class BandMat {
+
+    static_assert(N != 0, "Dimension of matrix must be positive");
+    static_assert(KL < N && KU < N, "Bandwidth must be below the dimension");
+
+public:
+
+    static constexpr size_t BANDS = KL + KU + 1;
+
+private:
+
+    // LAPACK band storage: entry (i, j) is _bands[KU + i - j][j], a diagonal is a contiguous row
+    std::array<std::array<T, N>, BANDS> _bands{};
+
+public:
+
+    BandMat() = default;
+
+    // the entries of m outside the band are ignored
+    explicit BandMat(const Basic_Matrix<T, N, N>& m) {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                if (contains(i, j))
+                    (*this)(i, j) = m(i, j);
+    }
+
+    static constexpr bool contains(const size_t& i, const size_t& j) noexcept {
+        return j <= i + KU && i <= j + KL;
+    }
+
+    // diagonal d is KU + i - j, diagonal KU is the main one
+    std::array<T, N>& band(const size_t& d) noexcept {
+        return _bands[d];
+    }
+
+    const std::array<T, N>& band(const size_t& d) const noexcept {
+        return _bands[d];
+    }
+
+    // only entries inside the band can be written
+    T& operator()(const size_t& i, const size_t& j) noexcept {
+        assert(i < N && j < N && contains(i, j) && "Entry outside the band");
+        return _bands[KU + i - j][j];
+    }
+
+    T operator()(const size_t& i, const size_t& j) const noexcept {
+        assert(i < N && j < N && "Matrix index out of range");
+        return contains(i, j) ? _bands[KU + i - j][j] : T{};
+    }
+
+    Mat<T, N, N> toMat() const {
+        Mat<T, N, N> res;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                res(i, j) = (*this)(i, j);
+        return res;
+    }
+
+    // one pass per diagonal, O(N (KL + KU))
+    Vec<T, N> operator*(const Vec<T, N>& x) const {
+        Vec<T, N> res;
+        for (size_t d = 0; d < BANDS; ++d) {
+            const T* band = _bands[d].data();
+            // entry (j + d - KU, j) for the columns j whose row is inside the matrix
+            const size_t first = d < KU ? KU - d : 0, last = d > KU ? N - (d - KU) : N;
+            for (size_t j = first; j < last; ++j)
+                res(j + d - KU) += band[j] * x(j);
+        }
+        return res;
+    }
+
+    BandLU<T, N, KL, KU> lu() const {
+        return BandLU<T, N, KL, KU>{*this};
+    }
+
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        return lu().solve(b);
+    }
+
+    T determinant() const {
+        return lu().determinant();
+    }
+};
+
+// P A = L U by Gaussian elimination with partial pivoting inside the band, O(N KL (KL + KU))
+// row swaps widen U to KL + KU superdiagonals, the multipliers of L stay below the diagonal
+template <typename T, size_t N, size_t KL, size_t KU>
+class BandLU {
+private:
+
+    static constexpr size_t UPPER = std::min(KL + KU, N - 1);
+
+    BandMat<T, N, KL, UPPER> _factors;
+    // row k was swapped with row _pivots[k] at step k
+    std::array<size_t, N> _pivots{};
+    bool _odd = false;
+
+public:
+
+    explicit BandLU(const BandMat<T, N, KL, KU>& a) {
+        for (size_t d = 0; d < BandMat<T, N, KL, KU>::BANDS; ++d)
+            _factors.band(UPPER - KU + d) = a.band(d);
+        BandMat<T, N, KL, UPPER>& f = _factors;
+
+        for (size_t k = 0; k < N; ++k) {
+            const size_t lastRow = std::min(N - 1, k + KL), lastCol = std::min(N - 1, k + UPPER);
+            size_t pivot = k;
+            for (size_t i = k + 1; i <= lastRow; ++i)
+                if (detail::betterPivot(f(i, k), f(pivot, k)))
+                    pivot = i;
+            detail::checkPivot(f(pivot, k) == T{});
+            _pivots[k] = pivot;
+            if (pivot != k) {
+                for (size_t j = k; j <= lastCol; ++j)
+                    std::swap(f(k, j), f(pivot, j));
+                _odd = !_odd;
+            }
+            for (size_t i = k + 1; i <= lastRow; ++i) {
+                const T multiplier = f(i, k) / f(k, k);
+                f(i, k) = multiplier;
+                for (size_t j = k + 1; j <= lastCol; ++j)
+                    f(i, j) -= multiplier * f(k, j);
+            }
+        }
+    }
+
+    const BandMat<T, N, KL, UPPER>& factors() const noexcept {
+        return _factors;
+    }
+
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        Vec<T, N> x = b;
+        for (size_t k = 0; k < N; ++k) {
+            std::swap(x(k), x(_pivots[k]));
+            for (size_t i = k + 1; i <= std::min(N - 1, k + KL); ++i)
+                x(i) -= _factors(i, k) * x(k);
+        }
+        for (size_t i = N; i-- > 0; ) {
+            T sum = x(i);
+            for (size_t j = i + 1; j <= std::min(N - 1, i + UPPER); ++j)
+                sum -= _factors(i, j) * x(j);
+            x(i) = sum / _factors(i, i);
+        }
+        return x;
+    }
+
+    T determinant() const {
+        T res = _factors(0, 0);
+        for (size_t i = 1; i < N; ++i)
+            res *= _factors(i, i);
+        return _odd ? -res : res;
+    }
+};
+
+template <typename T, size_t N, size_t K>
+class SymBandMat {
+
+    static_assert(N != 0, "Dimension of matrix must be positive");
+    static_assert(K < N, "Bandwidth must be below the dimension");
+
+private:
+
+    // entry (i, j) with i >= j is _bands[i - j][j]
+    std::array<std::array<T, N>, K + 1> _bands{};
+
+public:
+
+    SymBandMat() = default;
+
+    // m is assumed symmetric, its lower band is kept
+    explicit SymBandMat(const Basic_Matrix<T, N, N>& m) {
+        for (size_t d = 0; d <= K; ++d)
+            for (size_t j = 0; j + d < N; ++j)
+                _bands[d][j] = m(j + d, j);
+    }
+
+    static constexpr bool contains(const size_t& i, const size_t& j) noexcept {
+        return j <= i + K && i <= j + K;
+    }
+
+    // subdiagonal d
+    std::array<T, N>& band(const size_t& d) noexcept {
+        return _bands[d];
+    }
+
+    const std::array<T, N>& band(const size_t& d) const noexcept {
+        return _bands[d];
+    }
+
+    // (i, j) and (j, i) are the same entry, only entries inside the band can be written
+    T& operator()(const size_t& i, const size_t& j) noexcept {
+        assert(i < N && j < N && contains(i, j) && "Entry outside the band");
+        return i >= j ? _bands[i - j][j] : _bands[j - i][i];
+    }
+
+    T operator()(const size_t& i, const size_t& j) const noexcept {
+        assert(i < N && j < N && "Matrix index out of range");
+        if (!contains(i, j))
+            return T{};
+        return i >= j ? _bands[i - j][j] : _bands[j - i][i];
+    }
+
+    Mat<T, N, N> toMat() const {
+        Mat<T, N, N> res;
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < N; ++j)
+                res(i, j) = (*this)(i, j);
+        return res;
+    }
+
+    // every subdiagonal also stands for its mirrored superdiagonal, O(N K)
+    Vec<T, N> operator*(const Vec<T, N>& x) const {
+        Vec<T, N> res;
+        for (size_t j = 0; j < N; ++j)
+            res(j) = _bands[0][j] * x(j);
+        for (size_t d = 1; d <= K; ++d) {
+            const T* band = _bands[d].data();
+            for (size_t j = 0; j + d < N; ++j) {
+                res(j + d) += band[j] * x(j);
+                res(j) += band[j] * x(j + d);
+            }
+        }
+        return res;
+    }
+
+    BandCholesky<T, N, K> cholesky() const {
+        return BandCholesky<T, N, K>{*this};
+    }
+
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        return cholesky().solve(b);
+    }
+};
+
+// A = L L^T for a positive definite banded A, L keeps the K subdiagonals of A, O(N K^2)
+template <typename T, size_t N, size_t K>
+class BandCholesky {
+private:
+
+    BandMat<T, N, K, 0> _factor;
+
+public:
+
+    explicit BandCholesky(const SymBandMat<T, N, K>& a) {
+        BandMat<T, N, K, 0>& l = _factor;
+        for (size_t j = 0; j < N; ++j) {
+            const size_t first = j > K ? j - K : 0;
+            T diagonal = a(j, j);
+            for (size_t p = first; p < j; ++p)
+                diagonal -= l(j, p) * l(j, p);
+            l(j, j) = detail::checkedSqrt(diagonal);
+            for (size_t i = j + 1; i <= std::min(N - 1, j + K); ++i) {
+                T sum = a(i, j);
+                for (size_t p = i > K ? i - K : 0; p < j; ++p)
+                    sum -= l(i, p) * l(j, p);
+                l(i, j) = sum / l(j, j);
+            }
+        }
+    }
+
+    const BandMat<T, N, K, 0>& factor() const noexcept {
+        return _factor;
+    }
+
+    Vec<T, N> solve(const Vec<T, N>& b) const {
+        Vec<T, N> x = b;
+        for (size_t i = 0; i < N; ++i) {
+            T sum = x(i);
+            for (size_t p = i > K ? i - K : 0; p < i; ++p)
+                sum -= _factor(i, p) * x(p);
+            x(i) = sum / _factor(i, i);
+        }
+        for (size_t i = N; i-- > 0; ) {
+            T sum = x(i);
+            for (size_t p = i + 1; p <= std::min(N - 1, i + K); ++p)
+                sum -= _factor(p, i) * x(p);
+            x(i) = sum / _factor(i, i);
+        }
+        return x;
+    }
+
+    T determinant() const {
+        T res = _factor(0, 0) * _factor(0, 0);
+        for (size_t i = 1; i < N; ++i)
+            res *= _factor(i, i) * _factor(i, i);
+        return res;
+    }
+};
+
+}
+
+#endif /* Structured_hpp */
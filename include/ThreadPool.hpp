@@ -0,0 +1,140 @@
+#ifndef ThreadPool_hpp
+#define ThreadPool_hpp
+
+#include <cstddef>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <algorithm>
+
+namespace vecxify {
+
+// work-stealing pool for fork-join parallelism
+// every worker owns a deque, it pushes and pops its own tasks at the back
+// and steals from the front of the others when it runs out of work
+// a thread waiting for a forked task keeps executing other tasks, so nested
+// invoke / parallelFor never deadlock and never oversubscribe the machine
+class ThreadPool final {
+private:
+
+    struct Task {
+        void (*run)(void*);
+        void* data;
+        std::atomic<bool> done{false};
+        std::exception_ptr error{};
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task*> tasks;
+    };
+
+    std::vector<std::thread> _workers;
+
+    // one queue per worker, the last one receives tasks from outside threads
+    std::vector<std::unique_ptr<Queue>> _queues;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<size_t> _pending{0};
+    std::atomic<bool> _stop{false};
+
+    // index of the queue the calling thread pushes into
+    size_t localQueue() const noexcept;
+
+    void push(Task* task);
+
+    // remove the task if it is still at the back of the local queue
+    bool reclaim(Task* task);
+
+    // pop from the local queue or steal from another one
+    Task* take();
+
+    static void execute(Task* task) noexcept;
+
+    // run one pending task if there is any
+    bool runOne();
+
+    void workerLoop(const size_t& index);
+
+    void wait(Task& task);
+
+public:
+
+    // threads is the number of worker threads, the calling thread also works while waiting
+    explicit ThreadPool(const size_t& threads);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    // pool shared by the whole library, one worker per hardware thread minus the caller
+    static ThreadPool& shared();
+
+    // number of threads that can run tasks at the same time, including the caller
+    size_t concurrency() const noexcept;
+
+    // run lhs and rhs, possibly in parallel, and return once both finished
+    // an exception thrown by either is rethrown in the caller
+    // rhs runs with the pool policy of the executing thread (see Allocator.hpp), a container
+    // it fills must be constructed inside rhs, not assigned to one allocated by the caller
+    template <typename F, typename G>
+    void invoke(F&& lhs, G&& rhs) {
+        if (_workers.empty()) {
+            lhs();
+            rhs();
+            return;
+        }
+
+        auto call = [](void* data) { (*static_cast<std::remove_reference_t<G>*>(data))(); };
+        Task task{};
+        task.run = call;
+        task.data = static_cast<void*>(std::addressof(rhs));
+        push(&task);
+
+        std::exception_ptr error{};
+        try {
+            lhs();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        if (reclaim(&task))
+            execute(&task);
+        else
+            wait(task);
+
+        if (error)
+            std::rethrow_exception(error);
+        if (task.error)
+            std::rethrow_exception(task.error);
+    }
+
+    // call func(first, last) over sub-ranges of [begin, end) of at least grain elements
+    template <typename F>
+    void parallelFor(const size_t& begin, const size_t& end, const size_t& grain, F&& func) {
+        if (end <= begin)
+            return;
+        size_t size = end - begin;
+        if (size <= std::max<size_t>(grain, 1) || _workers.empty()) {
+            func(begin, end);
+            return;
+        }
+        size_t mid = begin + size / 2;
+        invoke(
+            [&]() { parallelFor(begin, mid, grain, func); },
+            [&]() { parallelFor(mid, end, grain, func); }
+        );
+    }
+};
+
+}
+
+#endif /* ThreadPool_hpp */
@@ -21,6 +21,30 @@ public:
     static void test7();
     static void test8();
     static void test9();
+    static void test10();
+    static void test11();
+    static void test12();
+    static void test13();
+    static void test14();
+    static void test15();
+    static void test16();
+    static void test17();
+    static void test18();
+    static void test19();
+    static void test20();
+    static void test21();
+    static void test22();
+    static void test23();
+    static void test24();
+    static void test25();
+    static void test26();
+    static void test27();
+    static void test28();
+    static void test29();
+    static void test30();
+    static void test31();
+    static void test32();
+    static void test33();
 };
 
 #endif /* UnitTest_hpp */
@@ -21,18 +21,18 @@ private:
     using Mat<T, 1, N>::operator*;
     
 public:
-    Vec() : Mat<T, 1, N>() {}
+    constexpr Vec() : Mat<T, 1, N>() {}
     
-    Vec(const std::initializer_list<T>& m) : Mat<T, 1, N>(std::initializer_list<std::initializer_list<T>>{m}) {}
+    constexpr Vec(const std::initializer_list<T>& m) : Mat<T, 1, N>(std::initializer_list<std::initializer_list<T>>{m}) {}
     
-    explicit Vec(const std::array<T, N>& m) : Mat<T, 1, N>(std::array<std::array<T, N>, 1>{m}) {}
+    constexpr explicit Vec(const std::array<T, N>& m) : Mat<T, 1, N>(std::array<std::array<T, N>, 1>{m}) {}
     
-    const T& operator() (const size_t& index) const {
+    constexpr const T& operator() (const size_t& index) const {
         assert(index >= 0 && index < N && "Vector index out of range");
         return Mat<T, 1, N>::operator()(0, index);
     }
     
-    T& operator() (const size_t& index) {
+    constexpr T& operator() (const size_t& index) {
         assert(index >= 0 && index < N && "Vector index out of range");
         return Mat<T, 1, N>::operator()(0, index);
     }
@@ -47,7 +47,7 @@ public:
         return std::sqrt(res);
     }
     
-    T operator*(const Vec<T, N>& rhs) const {
+    constexpr T operator*(const Vec<T, N>& rhs) const {
         T res{};
         for (size_t i = 0; i < N; ++i) {
             res += operator()(i) * rhs(i);
@@ -57,6 +57,20 @@ public:
     
 };
 
+// matrix-vector product, the vector taken as a column
+template <typename T, size_t ROW, size_t COL>
+constexpr Vec<T, ROW> operator*(const Basic_Matrix<T, ROW, COL>& lhs, const Vec<T, COL>& rhs) {
+    Vec<T, ROW> res;
+#pragma GCC unroll 4
+    for (size_t i = 0; i < ROW; ++i) {
+        T sum = lhs(i, 0) * rhs(0);
+#pragma GCC unroll 4
+        for (size_t j = 1; j < COL; ++j)
+            sum += lhs(i, j) * rhs(j);
+        res(i) = sum;
+    }
+    return res;
+}
 
 }
 
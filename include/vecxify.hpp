@@ -4,6 +4,20 @@
 #include "Matrix.hpp"
 #include "Vector.hpp"
 #include "ModNum.hpp"
+#include "DynModNum.hpp"
 #include "BigInt.hpp"
+#include "Product.hpp"
+#include "ModNumBulk.hpp"
+#include "Poly.hpp"
+#include "BitMatrix.hpp"
+#include "Structured.hpp"
+#include "Factorization.hpp"
+#include "Execution.hpp"
+#include "PowerCache.hpp"
+#include "OutOfCore.hpp"
+#include "Quantized.hpp"
+#include "Layout.hpp"
+#include "Distance.hpp"
+#include "Statistics.hpp"
 
 #endif
@@ -0,0 +1,169 @@
+#include "Allocator.hpp"
+
+#include <bit>
+#include <algorithm>
+#include <mutex>
+
+namespace vecxify {
+
+namespace {
+
+class HeapPolicy final : public MemoryPolicy {
+public:
+    void* allocate(const size_t& bytes) override {
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void* ptr, const size_t& bytes) noexcept override {
+        ::operator delete(ptr, bytes);
+    }
+};
+
+constinit HeapPolicy heapPolicy{};
+
+thread_local MemoryPolicy* currentPolicy = nullptr;
+
+// the pool of this thread, cleared on thread exit so late frees go to the heap
+// trivially destructible so it can still be read while thread_local objects are destroyed
+thread_local PoolPolicy* threadPool = nullptr;
+
+// pools of exited threads, handed to the next thread that asks for a pool
+// never destroyed, blocks allocated from a pool may be freed after the owning thread exit
+// and still need a valid object to call into
+std::mutex orphanMutex{};
+std::vector<PoolPolicy*>* orphanPools = new std::vector<PoolPolicy*>();
+
+struct PoolReleaser {
+    ~PoolReleaser() {
+        if (threadPool) {
+            threadPool->release();
+            std::lock_guard<std::mutex> lock{orphanMutex};
+            orphanPools->push_back(threadPool);
+            threadPool = nullptr;
+        }
+    }
+};
+
+}
+
+MemoryPolicy& MemoryPolicy::current() noexcept {
+    return currentPolicy ? *currentPolicy : heapPolicy;
+}
+
+MemoryPolicy& MemoryPolicy::heap() noexcept {
+    return heapPolicy;
+}
+
+MemoryPolicy& MemoryPolicy::pool() noexcept {
+    thread_local PoolReleaser releaser{};
+    if (!threadPool) {
+        std::lock_guard<std::mutex> lock{orphanMutex};
+        if (orphanPools->empty()) {
+            threadPool = new PoolPolicy();
+        } else {
+            threadPool = orphanPools->back();
+            orphanPools->pop_back();
+        }
+    }
+    return *threadPool;
+}
+
+size_t PoolPolicy::sizeClass(const size_t& bytes) noexcept {
+    return std::max<size_t>(MIN_CLASS, std::bit_width(std::max<size_t>(bytes, 1) - 1));
+}
+
+bool PoolPolicy::owned() const noexcept {
+    return threadPool == this;
+}
+
+void* PoolPolicy::allocate(const size_t& bytes) {
+    size_t cls = sizeClass(bytes);
+    if (cls > MAX_CLASS)
+        return ::operator new(bytes);
+
+    if (FreeBlock* block = _free[cls]) {
+        _free[cls] = block->next;
+        _cached[cls] -= size_t{1} << cls;
+        return block;
+    }
+    return ::operator new(size_t{1} << cls);
+}
+
+void PoolPolicy::deallocate(void* ptr, const size_t& bytes) noexcept {
+    size_t cls = sizeClass(bytes);
+    if (cls > MAX_CLASS || !owned() || _cached[cls] + (size_t{1} << cls) > MAX_CACHED_BYTES) {
+        ::operator delete(ptr);
+        return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = _free[cls];
+    _free[cls] = block;
+    _cached[cls] += size_t{1} << cls;
+}
+
+void PoolPolicy::release() noexcept {
+    for (size_t cls = 0; cls <= MAX_CLASS; ++cls) {
+        while (FreeBlock* block = _free[cls]) {
+            _free[cls] = block->next;
+            ::operator delete(block);
+        }
+        _cached[cls] = 0;
+    }
+}
+
+ArenaPolicy::ArenaPolicy(const size_t& initialBytes) : _nextChunk { std::max<size_t>(initialBytes, 256) } {}
+
+ArenaPolicy::~ArenaPolicy() {
+    release();
+}
+
+void ArenaPolicy::grow(const size_t& bytes) {
+    size_t size = std::max(_nextChunk, bytes);
+    auto* begin = static_cast<std::byte*>(::operator new(size));
+    _chunks.push_back({begin, size});
+    _top = begin;
+    _end = begin + size;
+    _nextChunk = size * 2;
+}
+
+void* ArenaPolicy::allocate(const size_t& bytes) {
+    constexpr size_t align = alignof(std::max_align_t);
+    size_t size = (std::max<size_t>(bytes, 1) + align - 1) & ~(align - 1);
+    if (static_cast<size_t>(_end - _top) < size)
+        grow(size);
+    void* res = _top;
+    _top += size;
+    return res;
+}
+
+void ArenaPolicy::deallocate(void* ptr, const size_t& bytes) noexcept {
+    constexpr size_t align = alignof(std::max_align_t);
+    size_t size = (std::max<size_t>(bytes, 1) + align - 1) & ~(align - 1);
+    // only the most recent allocation can be given back
+    if (static_cast<std::byte*>(ptr) + size == _top)
+        _top = static_cast<std::byte*>(ptr);
+}
+
+void ArenaPolicy::release() noexcept {
+    for (auto& chunk : _chunks)
+        ::operator delete(chunk.begin);
+    _chunks.clear();
+    _top = _end = nullptr;
+}
+
+size_t ArenaPolicy::reserved() const noexcept {
+    size_t res = 0;
+    for (auto& chunk : _chunks)
+        res += chunk.size;
+    return res;
+}
+
+PolicyScope::PolicyScope(MemoryPolicy& policy) noexcept : _previous { currentPolicy } {
+    currentPolicy = &policy;
+}
+
+PolicyScope::~PolicyScope() {
+    currentPolicy = _previous;
+}
+
+}
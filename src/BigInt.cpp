@@ -1,7 +1,43 @@
 #include "BigInt.hpp"
 
+#include <bit>
+#include <deque>
+#include <mutex>
+#include <cstring>
+#include <cmath>
+#include <optional>
+#include "ThreadPool.hpp"
+
 namespace vecxify {
 
+namespace {
+
+constexpr BigInt::Limb DECIMAL_BASE = 1000000000;
+constexpr size_t DECIMAL_DIGITS = 9;
+
+// below these sizes (in limbs) the quadratic algorithms are faster
+constexpr size_t RECIPROCAL_THRESHOLD = 40;
+constexpr size_t BARRETT_THRESHOLD = 80;
+constexpr size_t CONVERSION_THRESHOLD = 60;
+
+// conversions of numbers above this size (in limbs) split their work across the shared pool
+constexpr size_t PARALLEL_CONVERSION_THRESHOLD = 1 << 13;
+
+struct DecimalPowerCache {
+    std::mutex mutex;
+    // deque keeps references valid while it grows
+    std::deque<BigInt::LimbVector> powers;
+    std::deque<BigInt::LimbVector> reciprocals;
+    std::deque<bool> hasReciprocal;
+};
+
+DecimalPowerCache& decimalCache() {
+    static DecimalPowerCache cache{};
+    return cache;
+}
+
+}
+
 bool BigInt::isNumber(const char& x) noexcept {
     return (x <= '9' && x >= '0');
 }
@@ -9,10 +45,10 @@ bool BigInt::isNumber(const char& x) noexcept {
 bool BigInt::isValidBigInt(const std::string_view& m) noexcept{
     if (m.length() == 0)
         return false;
-    
+
     if (m.length() == 1 && m == "0")
         return true;
-    
+
     size_t last = 0;
     for (size_t i = m.length() - 1; i >= 1; --i){
         if (!isNumber(m[i]))
@@ -40,120 +76,607 @@ bool BigInt::sameSign(const BigInt& rhs) const noexcept {
     return _positive == rhs._positive;
 }
 
+void BigInt::normalize() noexcept {
+    while (!_limbs.empty() && _limbs.back() == 0)
+        _limbs.pop_back();
+    if (_limbs.empty())
+        _positive = false;
+}
 
-BigInt::BigInt (const std::shared_ptr<std::string>& ptr, const bool& positive) {
-    if (!ptr)
-        throw std::invalid_argument("ptr is null");
-    _num = ptr;
-    _positive = positive;
+int BigInt::compareMagnitude(const LimbVector& lhs, const LimbVector& rhs) noexcept {
+    if (lhs.size() != rhs.size())
+        return lhs.size() < rhs.size() ? -1 : 1;
+    for (size_t i = lhs.size(); i-- > 0; ) {
+        if (lhs[i] != rhs[i])
+            return lhs[i] < rhs[i] ? -1 : 1;
+    }
+    return 0;
 }
 
-BigInt BigInt::shallowCopy() noexcept {
-    BigInt res{};
-    res._num = _num;
-    res._positive = _positive;
-    return res;
+void BigInt::addMagnitude(LimbVector& lhs, const LimbVector& rhs) {
+    size_t n = rhs.size();
+    if (lhs.size() < n)
+        lhs.resize(n, 0);
+
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t total = carry + lhs[i] + rhs[i];
+        lhs[i] = static_cast<Limb>(total);
+        carry = total >> 32;
+    }
+    for (size_t i = n; carry && i < lhs.size(); ++i) {
+        uint64_t total = carry + lhs[i];
+        lhs[i] = static_cast<Limb>(total);
+        carry = total >> 32;
+    }
+    if (carry)
+        lhs.push_back(static_cast<Limb>(carry));
 }
 
-BigInt BigInt::deepCopy() const noexcept {
-    BigInt res{};
-    res._num = std::make_shared<std::string>(*_num);
-    res._positive = _positive;
-    return res;
+void BigInt::subMagnitude(LimbVector& lhs, const LimbVector& rhs) noexcept {
+    assert(compareMagnitude(lhs, rhs) >= 0);
+
+    int64_t borrow = 0;
+    size_t i = 0;
+    for ( ; i < rhs.size(); ++i) {
+        int64_t total = int64_t{lhs[i]} - rhs[i] - borrow;
+        borrow = total < 0;
+        lhs[i] = static_cast<Limb>(total);
+    }
+    for ( ; borrow && i < lhs.size(); ++i) {
+        int64_t total = int64_t{lhs[i]} - borrow;
+        borrow = total < 0;
+        lhs[i] = static_cast<Limb>(total);
+    }
+    while (!lhs.empty() && lhs.back() == 0)
+        lhs.pop_back();
 }
 
-BigInt BigInt::abs() const noexcept {
-    BigInt res{};
-    res._num = _num;
-    res._positive = _positive;
-    if (!_positive && *_num != "0")
-        res._positive = true;
-    return res;
+void BigInt::reverseSubMagnitude(LimbVector& lhs, const LimbVector& rhs) {
+    assert(compareMagnitude(lhs, rhs) < 0);
+
+    size_t n = lhs.size();
+    lhs.resize(rhs.size(), 0);
+    int64_t borrow = 0;
+    for (size_t i = 0; i < rhs.size(); ++i) {
+        int64_t total = int64_t{rhs[i]} - (i < n ? lhs[i] : 0) - borrow;
+        borrow = total < 0;
+        lhs[i] = static_cast<Limb>(total);
+    }
+    while (!lhs.empty() && lhs.back() == 0)
+        lhs.pop_back();
 }
 
-BigInt BigInt::operator*(const int8_t& rhs) const noexcept {
-    assert(rhs <= 9 && rhs >= 0);
-    
-    BigInt res{deepCopy()};
-    res *= rhs;
-    return res;
+BigInt::LimbVector BigInt::mulMagnitude(const LimbVector& lhs, const LimbVector& rhs) {
+    if (lhs.empty() || rhs.empty())
+        return LimbVector{};
+    return mulRange(lhs.data(), lhs.size(), rhs.data(), rhs.size());
 }
 
-BigInt& BigInt::operator*=(const int8_t& rhs) noexcept {
-    assert(rhs <= 9 && rhs >= 0);
-    
-    std::string res{};
-    int carry{0};
-    for (auto it = _num->rbegin(); it != _num->rend(); ++it) {
-        int total = {carry + charToInt(*it) * rhs};
-        carry = total / 10;
-        res.push_back(intToChar(total % 10));
+void BigInt::addShifted(LimbVector& lhs, const LimbVector& rhs, const size_t& offset) {
+    if (lhs.size() < offset + rhs.size())
+        lhs.resize(offset + rhs.size(), 0);
+
+    uint64_t carry = 0;
+    size_t i = 0;
+    for ( ; i < rhs.size(); ++i) {
+        uint64_t total = carry + lhs[offset + i] + rhs[i];
+        lhs[offset + i] = static_cast<Limb>(total);
+        carry = total >> 32;
+    }
+    for (i += offset; carry && i < lhs.size(); ++i) {
+        uint64_t total = carry + lhs[i];
+        lhs[i] = static_cast<Limb>(total);
+        carry = total >> 32;
     }
     if (carry)
-        res.push_back(intToChar(carry));
-   
-    std::reverse(res.begin(), res.end());
-    _num = std::make_shared<std::string>(std::move(res));
-    return *this;
+        lhs.push_back(static_cast<Limb>(carry));
+}
+
+void BigInt::shiftLeftMagnitude(LimbVector& x, const size_t& shift) {
+    if (x.empty())
+        return;
+    const size_t bits = shift % 32;
+    if (bits) {
+        Limb carry = 0;
+        for (auto& limb : x) {
+            Limb next = limb >> (32 - bits);
+            limb = (limb << bits) | carry;
+            carry = next;
+        }
+        if (carry)
+            x.push_back(carry);
+    }
+    x.insert(x.begin(), shift / 32, 0);
 }
 
-BigInt::BigInt() noexcept : _num {std::make_shared<std::string>("0")}, _positive(false) {}
+bool BigInt::shiftRightMagnitude(LimbVector& x, const size_t& shift) {
+    const size_t limbs = shift / 32;
+    const size_t bits = shift % 32;
+    if (limbs >= x.size()) {
+        bool lost = !x.empty();
+        x.clear();
+        return lost;
+    }
 
-BigInt::BigInt(const std::string_view& m) {
-    if (!isValidBigInt(m))
-        throw std::invalid_argument("Invalid representation of BigInt");
-    
-    if (m[0] == '-') {
-        _num = std::make_shared<std::string>(m.substr(1));
+    bool lost = std::any_of(x.begin(), x.begin() + limbs, [](const Limb& limb) { return limb != 0; });
+    x.erase(x.begin(), x.begin() + limbs);
+    if (bits) {
+        lost = lost || (x[0] & ((Limb{1} << bits) - 1));
+        for (size_t i = 0; i + 1 < x.size(); ++i)
+            x[i] = (x[i] >> bits) | (x[i + 1] << (32 - bits));
+        x.back() >>= bits;
+    }
+    while (!x.empty() && x.back() == 0)
+        x.pop_back();
+    return lost;
+}
+
+void BigInt::mulSmall(LimbVector& lhs, const Limb& mul, const Limb& add) {
+    uint64_t carry = add;
+    for (auto& limb : lhs) {
+        uint64_t total = uint64_t{limb} * mul + carry;
+        limb = static_cast<Limb>(total);
+        carry = total >> 32;
+    }
+    if (carry)
+        lhs.push_back(static_cast<Limb>(carry));
+    while (!lhs.empty() && lhs.back() == 0)
+        lhs.pop_back();
+}
+
+BigInt::Limb BigInt::divSmall(LimbVector& lhs, const Limb& div) noexcept {
+    assert(div != 0);
+
+    uint64_t rem = 0;
+    for (size_t i = lhs.size(); i-- > 0; ) {
+        uint64_t cur = (rem << 32) | lhs[i];
+        lhs[i] = static_cast<Limb>(cur / div);
+        rem = cur % div;
+    }
+    while (!lhs.empty() && lhs.back() == 0)
+        lhs.pop_back();
+    return static_cast<Limb>(rem);
+}
+
+void BigInt::divModMagnitude(const LimbVector& lhs, const LimbVector& rhs, LimbVector* quotient, LimbVector* remainder) {
+    assert(!rhs.empty());
+
+    if (compareMagnitude(lhs, rhs) < 0) {
+        if (quotient) quotient->clear();
+        if (remainder) *remainder = lhs;
+        return;
+    }
+
+    if (rhs.size() == 1) {
+        LimbVector q{lhs};
+        Limb r = divSmall(q, rhs[0]);
+        if (remainder) {
+            remainder->clear();
+            if (r) remainder->push_back(r);
+        }
+        if (quotient) *quotient = std::move(q);
+        return;
+    }
+
+    if (rhs.size() >= BARRETT_THRESHOLD && lhs.size() - rhs.size() >= BARRETT_THRESHOLD) {
+        // long division with digits of rhs.size() limbs, each step is a Barrett reduction
+        const size_t n = rhs.size();
+        const LimbVector inverse = reciprocal(rhs);
+        LimbVector q(lhs.size(), 0);
+        LimbVector r{};
+        LimbVector block{};
+        LimbVector digit{};
+        for (size_t end = lhs.size(); end > 0; ) {
+            const size_t begin = end > n ? end - n : 0;
+            // block = r * B^(end - begin) + lhs[begin, end) < rhs * B^n
+            block.assign(lhs.begin() + begin, lhs.begin() + end);
+            block.insert(block.end(), r.begin(), r.end());
+            while (!block.empty() && block.back() == 0)
+                block.pop_back();
+            barrettDivMod(block, rhs, inverse, &digit, r);
+            std::copy(digit.begin(), digit.end(), q.begin() + begin);
+            end = begin;
+        }
+        while (!q.empty() && q.back() == 0)
+            q.pop_back();
+        if (quotient) *quotient = std::move(q);
+        if (remainder) *remainder = std::move(r);
+        return;
+    }
+
+    // normalize so the top limb of the divisor has its highest bit set
+    const size_t n = rhs.size();
+    const size_t m = lhs.size() - n;
+    const int shift = std::countl_zero(rhs.back());
+
+    LimbVector v(n, 0);
+    for (size_t i = n - 1; i > 0; --i)
+        v[i] = (rhs[i] << shift) | (shift ? static_cast<Limb>(uint64_t{rhs[i - 1]} >> (32 - shift)) : 0);
+    v[0] = rhs[0] << shift;
+
+    LimbVector u(lhs.size() + 1, 0);
+    u[lhs.size()] = shift ? static_cast<Limb>(uint64_t{lhs.back()} >> (32 - shift)) : 0;
+    for (size_t i = lhs.size() - 1; i > 0; --i)
+        u[i] = (lhs[i] << shift) | (shift ? static_cast<Limb>(uint64_t{lhs[i - 1]} >> (32 - shift)) : 0);
+    u[0] = lhs[0] << shift;
+
+    LimbVector q(m + 1, 0);
+    constexpr uint64_t base = uint64_t{1} << 32;
+
+    for (size_t j = m + 1; j-- > 0; ) {
+        // estimate the quotient digit from the top two limbs
+        uint64_t top = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+        uint64_t qhat = top / v[n - 1];
+        uint64_t rhat = top % v[n - 1];
+        while (qhat >= base || qhat * v[n - 2] > ((rhat << 32) | u[j + n - 2])) {
+            --qhat;
+            rhat += v[n - 1];
+            if (rhat >= base)
+                break;
+        }
+
+        // multiply and subtract
+        int64_t borrow = 0;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t product = qhat * v[i] + carry;
+            carry = product >> 32;
+            int64_t total = int64_t{u[i + j]} - static_cast<Limb>(product) - borrow;
+            borrow = total < 0;
+            u[i + j] = static_cast<Limb>(total);
+        }
+        int64_t total = int64_t{u[j + n]} - static_cast<int64_t>(carry) - borrow;
+        u[j + n] = static_cast<Limb>(total);
+
+        // estimate was one too large, add back
+        if (total < 0) {
+            --qhat;
+            uint64_t c = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t sum = uint64_t{u[i + j]} + v[i] + c;
+                u[i + j] = static_cast<Limb>(sum);
+                c = sum >> 32;
+            }
+            u[j + n] = static_cast<Limb>(uint64_t{u[j + n]} + c);
+        }
+        q[j] = static_cast<Limb>(qhat);
+    }
+
+    if (quotient) {
+        while (!q.empty() && q.back() == 0)
+            q.pop_back();
+        *quotient = std::move(q);
+    }
+    if (remainder) {
+        remainder->assign(n, 0);
+        for (size_t i = 0; i < n; ++i)
+            (*remainder)[i] = (u[i] >> shift) | (shift ? static_cast<Limb>(uint64_t{u[i + 1]} << (32 - shift)) : 0);
+        while (!remainder->empty() && remainder->back() == 0)
+            remainder->pop_back();
+    }
+}
+
+void BigInt::addSigned(const LimbVector& rhs, const bool& rhsPositive) {
+    if (rhs.empty())
+        return;
+    if (_limbs.empty()) {
+        _limbs = rhs;
+        _positive = rhsPositive;
+        return;
+    }
+
+    if (_positive == rhsPositive) {
+        addMagnitude(_limbs, rhs);
+        return;
+    }
+
+    int compare = compareMagnitude(_limbs, rhs);
+    if (compare == 0) {
+        _limbs.clear();
         _positive = false;
+    } else if (compare > 0) {
+        subMagnitude(_limbs, rhs);
+    } else {
+        reverseSubMagnitude(_limbs, rhs);
+        _positive = rhsPositive;
+    }
+}
+
+BigInt::LimbVector BigInt::reciprocal(const LimbVector& v) {
+    const size_t n = v.size();
+    LimbVector scale(2 * n + 1, 0);
+    scale.back() = 1;
+
+    if (n <= RECIPROCAL_THRESHOLD) {
+        LimbVector res{};
+        divModMagnitude(scale, v, &res, nullptr);
+        return res;
+    }
+
+    // start from the reciprocal of the top half, correct to about n/2 limbs
+    const size_t h = (n + 1) / 2;
+    LimbVector approx = reciprocal(LimbVector(v.end() - h, v.end()));
+    approx.insert(approx.begin(), n - h, 0);
+    BigInt x{std::move(approx), true};
+    const BigInt divisor{LimbVector{v}, true};
+    const BigInt power{std::move(scale), true};
+
+    // one Newton step x += x (B^2n - v x) / B^2n doubles the number of correct limbs
+    BigInt step{x * (power - divisor * x)};
+    if (step._limbs.size() > 2 * n) {
+        step._limbs.erase(step._limbs.begin(), step._limbs.begin() + 2 * n);
+        x += step;
+    }
+
+    // the error left is a few units, fix it exactly with a short (linear time) division
+    BigInt error{power - divisor * x};
+    LimbVector correction{};
+    if (error._positive) {
+        divModMagnitude(error._limbs, v, &correction, nullptr);
+        addMagnitude(x._limbs, correction);
+    } else if (error) {
+        LimbVector remainder{};
+        divModMagnitude(error._limbs, v, &correction, &remainder);
+        if (!remainder.empty())
+            addMagnitude(correction, LimbVector{1});
+        subMagnitude(x._limbs, correction);
+    }
+    return std::move(x._limbs);
+}
+
+const BigInt::LimbVector& BigInt::decimalPower(const size_t& level) {
+    auto& cache = decimalCache();
+    std::unique_lock<std::mutex> lock{cache.mutex};
+    while (cache.powers.size() <= level) {
+        const size_t next = cache.powers.size();
+        // the cache outlives any arena, always allocate it from the heap
+        PolicyScope scope{MemoryPolicy::heap()};
+        LimbVector power{};
+        if (next == 0) {
+            power.push_back(DECIMAL_BASE);
+        } else {
+            // square without holding the lock, elements of a deque never move
+            const LimbVector& previous = cache.powers[next - 1];
+            lock.unlock();
+            power = mulMagnitude(previous, previous);
+            lock.lock();
+        }
+        if (cache.powers.size() == next) {
+            cache.powers.push_back(std::move(power));
+            cache.reciprocals.emplace_back();
+            cache.hasReciprocal.push_back(false);
+        }
+    }
+    return cache.powers[level];
+}
+
+const BigInt::LimbVector& BigInt::decimalReciprocal(const size_t& level) {
+    const LimbVector& power = decimalPower(level);
+    auto& cache = decimalCache();
+    {
+        std::lock_guard<std::mutex> lock{cache.mutex};
+        if (cache.hasReciprocal[level])
+            return cache.reciprocals[level];
+    }
+
+    PolicyScope scope{MemoryPolicy::heap()};
+    LimbVector inverse = reciprocal(power);
+
+    std::lock_guard<std::mutex> lock{cache.mutex};
+    if (!cache.hasReciprocal[level]) {
+        cache.reciprocals[level] = std::move(inverse);
+        cache.hasReciprocal[level] = true;
+    }
+    return cache.reciprocals[level];
+}
+
+void BigInt::barrettDivMod(const LimbVector& x, const LimbVector& v, const LimbVector& inverse, LimbVector* quotient, LimbVector& remainder) {
+    const size_t n = v.size();
+    assert(x.size() <= 2 * n);
+
+    if (compareMagnitude(x, v) < 0) {
+        if (quotient) quotient->clear();
+        remainder = x;
+        return;
+    }
+
+    // floor(floor(x / B^(n-1)) * inverse / B^(n+1)) is at most 2 below the real quotient
+    LimbVector estimate = mulMagnitude(LimbVector(x.begin() + (n - 1), x.end()), inverse);
+    if (estimate.size() > n + 1)
+        estimate.erase(estimate.begin(), estimate.begin() + (n + 1));
+    else
+        estimate.clear();
+
+    remainder = x;
+    subMagnitude(remainder, mulMagnitude(estimate, v));
+    while (compareMagnitude(remainder, v) >= 0) {
+        subMagnitude(remainder, v);
+        addMagnitude(estimate, LimbVector{1});
+    }
+    if (quotient)
+        *quotient = std::move(estimate);
+}
+
+void BigInt::divModDecimalPower(const LimbVector& x, const size_t& level, LimbVector& quotient, LimbVector& remainder) {
+    barrettDivMod(x, decimalPower(level), decimalReciprocal(level), &quotient, remainder);
+}
+
+BigInt::LimbVector BigInt::parseDecimal(const std::string_view& digits) {
+    LimbVector res{};
+    if (digits.length() <= CONVERSION_THRESHOLD * DECIMAL_DIGITS) {
+        // consume 9 decimal digits at a time
+        res.reserve(digits.length() / DECIMAL_DIGITS + 1);
+        size_t first = digits.length() % DECIMAL_DIGITS;
+        if (first == 0) first = DECIMAL_DIGITS;
+        for (size_t pos = 0; pos < digits.length(); pos += (pos == 0 ? first : DECIMAL_DIGITS)) {
+            size_t len = pos == 0 ? first : DECIMAL_DIGITS;
+            Limb chunk = 0;
+            for (size_t i = pos; i < pos + len; ++i)
+                chunk = chunk * 10 + charToInt(digits[i]);
+            mulSmall(res, pos == 0 ? 1 : DECIMAL_BASE, chunk);
+        }
+        return res;
+    }
+
+    // value = high * 10^(9 * 2^level) + low, low being the largest such block of trailing digits
+    size_t level = 0;
+    while ((DECIMAL_DIGITS << (level + 1)) < digits.length())
+        ++level;
+    const size_t lowLength = DECIMAL_DIGITS << level;
+    const LimbVector& power = decimalPower(level);
+
+    // parseLow may run on another thread: low is built there, never assigned into storage
+    // allocated here under this thread's memory policy
+    std::optional<LimbVector> low{};
+    auto parseHigh = [&]() {
+        res = mulMagnitude(parseDecimal(digits.substr(0, digits.length() - lowLength)), power);
+    };
+    auto parseLow = [&]() {
+        low.emplace(parseDecimal(digits.substr(digits.length() - lowLength)));
+    };
+    if (digits.length() >= PARALLEL_CONVERSION_THRESHOLD * DECIMAL_DIGITS) {
+        ThreadPool::shared().invoke(parseHigh, parseLow);
     } else {
-        _num = std::make_shared<std::string>(m);
-        _positive = true;
+        parseHigh();
+        parseLow();
     }
+    while (!low->empty() && low->back() == 0)
+        low->pop_back();
+    addMagnitude(res, *low);
+    return res;
+}
+
+void BigInt::writeDecimal(const LimbVector& x, const size_t& width, const std::function<void(const char*, const size_t&)>& sink) {
+    if (x.size() <= CONVERSION_THRESHOLD) {
+        // peel off 9 decimal digits at a time, least significant first
+        std::array<char, (CONVERSION_THRESHOLD + 1) * 10> buffer;
+        char* end = buffer.data() + buffer.size();
+        char* pos = end;
+        LimbVector copy{x};
+        while (!copy.empty()) {
+            Limb chunk = divSmall(copy, DECIMAL_BASE);
+            for (size_t i = 0; i < DECIMAL_DIGITS && (chunk || !copy.empty()); ++i, chunk /= 10)
+                *--pos = static_cast<char>('0' + chunk % 10);
+        }
+
+        static constexpr char zeros[] = "0000000000000000000000000000000000000000000000000000000000000000";
+        for (size_t pad = width > size_t(end - pos) ? width - (end - pos) : 0; pad; ) {
+            size_t count = std::min(pad, sizeof(zeros) - 1);
+            sink(zeros, count);
+            pad -= count;
+        }
+        if (pos != end)
+            sink(pos, end - pos);
+        return;
+    }
+
+    // smallest power with at least half the limbs of x, then x < power^2
+    size_t level = 0;
+    while (decimalPower(level).size() * 2 < x.size())
+        ++level;
+    if (compareMagnitude(x, decimalPower(level)) < 0)
+        --level;
+
+    LimbVector quotient{}, remainder{};
+    divModDecimalPower(x, level, quotient, remainder);
+    const size_t lowWidth = DECIMAL_DIGITS << level;
+    writeDecimal(quotient, width ? width - lowWidth : 0, sink);
+    writeDecimal(remainder, lowWidth, sink);
+}
+
+void BigInt::writeDecimalFixed(const LimbVector& x, char* out, const size_t& width) {
+    if (x.size() <= CONVERSION_THRESHOLD) {
+        LimbVector copy{x};
+        char* pos = out + width;
+        while (pos != out) {
+            Limb chunk = copy.empty() ? 0 : divSmall(copy, DECIMAL_BASE);
+            for (size_t i = 0; i < DECIMAL_DIGITS && pos != out; ++i, chunk /= 10)
+                *--pos = static_cast<char>('0' + chunk % 10);
+        }
+        return;
+    }
+
+    size_t level = 0;
+    while (decimalPower(level).size() * 2 < x.size())
+        ++level;
+    if (compareMagnitude(x, decimalPower(level)) < 0)
+        --level;
+
+    LimbVector quotient{}, remainder{};
+    divModDecimalPower(x, level, quotient, remainder);
+    const size_t lowWidth = DECIMAL_DIGITS << level;
+    auto writeHigh = [&]() { writeDecimalFixed(quotient, out, width - lowWidth); };
+    auto writeLow = [&]() { writeDecimalFixed(remainder, out + width - lowWidth, lowWidth); };
+    if (x.size() >= PARALLEL_CONVERSION_THRESHOLD) {
+        ThreadPool::shared().invoke(writeHigh, writeLow);
+    } else {
+        writeHigh();
+        writeLow();
+    }
+}
+
+size_t BigInt::maxDecimalLength() const noexcept {
+    if (_limbs.empty())
+        return 1;
+    size_t bits = 32 * _limbs.size() - std::countl_zero(_limbs.back());
+    // log10(2) < 0.30103
+    return bits * 30103 / 100000 + 1;
+}
+
+BigInt::BigInt(LimbVector&& limbs, const bool& positive) : _limbs{std::move(limbs)}, _positive(positive) {
+    normalize();
+}
+
+BigInt::BigInt() noexcept : _limbs{}, _positive(false) {}
+
+BigInt::BigInt(const std::string_view& m) : _limbs{}, _positive(false) {
+    if (!isValidBigInt(m))
+        throw std::invalid_argument("Invalid representation of BigInt");
+
+    _limbs = parseDecimal(m[0] == '-' ? m.substr(1) : m);
+    _positive = m[0] != '-';
+    normalize();
 }
 
-BigInt::BigInt(const char& m) {
+BigInt::BigInt(const char& m) : _limbs{}, _positive(false) {
     if (!isNumber(m))
         throw std::invalid_argument("Invalid representation of BigInt");
-    
+
+    if (m > '0')
+        _limbs.push_back(charToInt(m));
     _positive = m > '0';
-    _num = std::make_shared<std::string>(1, m);
-        
 }
 
-BigInt::BigInt(const long long& m) noexcept {
-    _num = std::make_shared<std::string>(std::to_string(std::abs(m)));
-    _positive = m > 0;
+BigInt::BigInt(const long long& m) : _limbs{}, _positive(m > 0) {
+    uint64_t magnitude = m < 0 ? uint64_t{0} - static_cast<uint64_t>(m) : static_cast<uint64_t>(m);
+    while (magnitude) {
+        _limbs.push_back(static_cast<Limb>(magnitude));
+        magnitude >>= 32;
+    }
 }
 
-BigInt::BigInt(const BigInt& m) noexcept {
-    _num = std::make_shared<std::string>(*m._num);
-    _positive = m._positive;
-}
+BigInt::BigInt(const BigInt& m) : _limbs{m._limbs}, _positive(m._positive) {}
 
-BigInt::BigInt(const BigInt&& m) noexcept {
-    _num = std::move(m._num);
-    _positive = m._positive;
+BigInt::BigInt(BigInt&& m) noexcept : _limbs{std::move(m._limbs)}, _positive(m._positive) {
+    m._positive = false;
 }
 
 BigInt& BigInt::operator=(const std::string_view& m) {
     if (!isValidBigInt(m))
         throw std::invalid_argument("Invalid representation of BigInt");
-    BigInt copy{m};
-    _num = copy._num;
-    _positive = copy._positive;
-    return *this;
+    return *this = BigInt{m};
 }
 
-BigInt& BigInt::operator=(const BigInt& m) noexcept {
-    BigInt copy{m.deepCopy()};
-    _num = copy._num;
+BigInt& BigInt::operator=(const BigInt& m) {
+    _limbs = m._limbs;
     _positive = m._positive;
     return *this;
 }
 
-BigInt& BigInt::operator=(const BigInt&& m) noexcept {
-    _num = std::move(m._num);
+BigInt& BigInt::operator=(BigInt&& m) {
+    // moves the buffer when both sides use the same memory policy, copies otherwise
+    _limbs = std::move(m._limbs);
     _positive = m._positive;
     return *this;
 }
@@ -165,207 +688,545 @@ BigInt BigInt::operator+(const BigInt& rhs) const {
 }
 
 
-BigInt BigInt::operator-() const noexcept {
-    BigInt res{deepCopy()};
-    if (*res._num != "0")
+BigInt BigInt::operator-() const {
+    BigInt res{*this};
+    if (!res._limbs.empty())
         res._positive = !res._positive;
-    else res._positive = false;
     return res;
 }
 
 BigInt BigInt::operator-(const BigInt& rhs) const {
-    return *this + (-rhs);
+    BigInt res = *this;
+    res -= rhs;
+    return res;
 }
 
 BigInt BigInt::operator*(const BigInt& rhs) const {
-    BigInt res{ deepCopy() };
-    return (res *= rhs);
+    BigInt res{};
+    res._limbs = mulMagnitude(_limbs, rhs._limbs);
+    res._positive = sameSign(rhs);
+    res.normalize();
+    return res;
+}
+
+BigInt BigInt::operator/(const BigInt& rhs) const {
+    BigInt res { *this };
+    return (res /= rhs);
 }
 
 BigInt BigInt::operator%(const BigInt& rhs) const {
-    BigInt res { deepCopy() };
+    BigInt res { *this };
     return (res %= rhs);
 }
 
 
 BigInt& BigInt::operator+=(const BigInt& rhs) {
-    bool resultIsPositive = false;
-    std::string res{};
-
-    bool compare = (this->abs() <= rhs.abs());
-    const BigInt& largerNum = compare ? rhs : *this;
-    const BigInt& smallerNum = compare ? *this : rhs;
-    auto it = largerNum._num->crbegin();
-    auto it2 = smallerNum._num->crbegin();
-
-    if (sameSign(rhs)) {
-        resultIsPositive = _positive;
-        bool carry = false;
-
-        for ( ; it2 != smallerNum._num->rend(); it++, it2++) {
-            int total { carry + charToInt(*it) + charToInt(*it2) };
-            carry = (total >= 10);
-            total %= 10;
-            res.push_back(intToChar(total));
-        }
+    addSigned(rhs._limbs, rhs._positive);
+    return *this;
+}
 
-        for ( ; it != largerNum._num->rend(); it++) {
-            int total { carry + charToInt(*it) };
-            carry = (total >= 10);
-            total %= 10;
-            res.push_back(intToChar(total));
-        }
+BigInt& BigInt::operator-=(const BigInt& rhs) {
+    if (this == &rhs) {
+        _limbs.clear();
+        _positive = false;
+        return *this;
+    }
+    addSigned(rhs._limbs, !rhs._positive);
+    return *this;
+}
 
-        if (carry)
-            res.push_back('1');
+BigInt& BigInt::operator*=(const BigInt& rhs) {
+    _limbs = mulMagnitude(_limbs, rhs._limbs);
+    _positive = sameSign(rhs);
+    normalize();
+    return *this;
+}
 
-    } else {
-        resultIsPositive = largerNum._positive;
-        bool takeOver = false;
-        for ( ; it2 != smallerNum._num->rend(); it++, it2++) {
-            int total { charToInt(*it) - takeOver - charToInt(*it2)};
-            takeOver = total < 0;
-            if (total < 0) {
-                total += 10;
-            }
-            res.push_back(intToChar(total));
-        }
+BigInt BigInt::operator<<(const size_t& shift) const {
+    BigInt res { *this };
+    return (res <<= shift);
+}
 
-        for ( ; it != largerNum._num->rend(); it++, it2++) {
-            int total { charToInt(*it) - takeOver};
-            takeOver = total < 0;
-            if (total < 0)
-                total += 10;
-            res.push_back(intToChar(total));
-        }
-    }
+BigInt BigInt::operator>>(const size_t& shift) const {
+    BigInt res { *this };
+    return (res >>= shift);
+}
 
-    std::reverse(res.begin(), res.end());
+BigInt& BigInt::operator/=(const BigInt& rhs) {
+    if (rhs._limbs.empty())
+        throw std::invalid_argument("Division by zero is undefined");
 
-    //erase for prefix zero
-    size_t prefix = -1;
-    for (size_t i = 0; i < res.length() && res[i] == '0'; ++i) {
-        prefix = i;
-    }
-    if (prefix == res.length() - 1) {
-        _num = std::make_shared<std::string>("0");
-        _positive = false;
-    } else {
-        res = res.substr(prefix + 1);
-        _num = std::make_shared<std::string>(std::move(res));
-        _positive = resultIsPositive;
-    }
+    LimbVector quotient{};
+    divModMagnitude(_limbs, rhs._limbs, &quotient, nullptr);
+    _limbs = std::move(quotient);
+    _positive = sameSign(rhs);
+    normalize();
     return *this;
 }
 
-BigInt& BigInt::operator-=(const BigInt& rhs) {
-    return (*this += rhs);
+BigInt& BigInt::operator<<=(const size_t& shift) {
+    shiftLeftMagnitude(_limbs, shift);
+    return *this;
 }
 
-BigInt& BigInt::operator*=(const BigInt& rhs) {
-    std::string zero{};
-    BigInt res{};
-    for (auto it = rhs._num->crbegin(); it != rhs._num->crend(); ++it, zero += '0') {
-        BigInt tmp{(*this) * charToInt(*it)};
-        tmp._num->operator+=(zero);
-        res += tmp;
-    }
-    _positive = !(_positive ^ rhs._positive);
-    if (!_positive && !rhs._positive && *res._num == "0")
-        _positive = false;
-    _num = res._num;
+BigInt& BigInt::operator>>=(const size_t& shift) {
+    bool lost = shiftRightMagnitude(_limbs, shift);
+    if (!_positive && lost)
+        addMagnitude(_limbs, LimbVector{1});
+    normalize();
     return *this;
 }
 
 BigInt& BigInt::operator%=(const BigInt& rhs) {
-    if (rhs == BigInt("0"))
+    if (rhs._limbs.empty())
         throw std::invalid_argument("Remainder of zero is undefined");
-    
-    bool tmp = *this < BigInt{"0"};
-    
-    while (*this > BigInt{"0"})
-        *this -= rhs.abs();
-        
-    while (*this < BigInt{"0"})
-        *this += rhs.abs();
-    
-    if (tmp)
-        *this -= rhs.abs();
-    
+
+    LimbVector remainder{};
+    divModMagnitude(_limbs, rhs._limbs, nullptr, &remainder);
+    _limbs = std::move(remainder);
+    normalize();
     return *this;
 }
 
 bool BigInt::operator==(const BigInt& rhs) const noexcept {
-    return (_positive == rhs._positive) && (_num == rhs._num || *_num == *(rhs._num));
+    return sameSign(rhs) && _limbs == rhs._limbs;
 }
 
 bool BigInt::operator<(const BigInt& rhs) const noexcept {
-    if (!sameSign(rhs)) {
-        if (_positive) return false;
-        else return true;
-    } else {
-        size_t lhsLength = _num->length();
-        size_t rhsLength = rhs._num->length();
-        if (_positive) {
-            return (lhsLength != rhsLength ? lhsLength < rhsLength : *_num < *(rhs._num));
-        } else {
-            return (lhsLength != rhsLength ? lhsLength > rhsLength : *_num > *(rhs._num));
-        }
-        return 1;
-    }
+    bool lhsNegative = !_positive && !_limbs.empty();
+    bool rhsNegative = !rhs._positive && !rhs._limbs.empty();
+    if (lhsNegative != rhsNegative)
+        return lhsNegative;
+    if (lhsNegative)
+        return compareMagnitude(_limbs, rhs._limbs) > 0;
+    return compareMagnitude(_limbs, rhs._limbs) < 0;
 }
 
 bool BigInt::operator<=(const BigInt& rhs) const noexcept {
-    return (*this < rhs) || (*this == rhs);
+    return !(rhs < *this);
 }
 
 bool BigInt::operator>(const BigInt& rhs) const noexcept {
-    return !(*this <= rhs);
+    return rhs < *this;
 }
 
 bool BigInt::operator>=(const BigInt& rhs) const noexcept {
     return !(*this < rhs);
 }
 
-//auto BigInt::operator<=>(const BigInt& rhs) const {
-//    if (!sameSign(rhs)) {
-//        if (_positive) return 1;
-//        else return -1;
-//    } else {
-//        size_t lhsLength = _num.length();
-//        size_t rhsLength = rhs._num.length();
-//        if (lhsLength != rhsLength) {
-//            if (lhsLength < rhsLength) return _positive ? -1 : 1;
-//            else return _positive ? 1 : -1;
-//        } else {
-//            auto compare = (_num <=> rhs._num);
-//            if (compare == 0) return 0;
-//            return _positive ? compare < 0 : compare > 0;
-//        }
-//    }
-//}
-
 BigInt::operator bool() const noexcept {
-    return (*_num) != "0";
+    return !_limbs.empty();
 }
 
-std::ostream& operator<<(std::ostream& out, const BigInt& x) {
-    if (!x._positive && *(x._num) != "0")
+bool BigInt::isNegative() const noexcept {
+    return !_positive && !_limbs.empty();
+}
+
+size_t BigInt::bitLength() const noexcept {
+    if (_limbs.empty())
+        return 0;
+    return 32 * _limbs.size() - std::countl_zero(_limbs.back());
+}
+
+std::string BigInt::toString() const {
+    if (_limbs.empty())
+        return "0";
+
+    // write into an upper bound of the length, then drop the unused leading zeros
+    const size_t width = maxDecimalLength();
+    std::string res(width + 1, '0');
+    writeDecimalFixed(_limbs, res.data() + 1, width);
+    size_t first = res.find_first_not_of('0', 1);
+    if (!_positive)
+        res[--first] = '-';
+    return res.substr(first);
+}
+
+char* BigInt::toChars(char* first, char* last) const {
+    const size_t available = last - first;
+    if (_limbs.empty()) {
+        if (available == 0)
+            return nullptr;
+        *first = '0';
+        return first + 1;
+    }
+
+    const size_t sign = _positive ? 0 : 1;
+    const size_t width = maxDecimalLength();
+    if (available < width + sign) {
+        // the bound may be one digit too large
+        std::string res = toString();
+        if (res.length() > available)
+            return nullptr;
+        return std::copy(res.begin(), res.end(), first);
+    }
+
+    char* digits = first + sign;
+    writeDecimalFixed(_limbs, digits, width);
+    char* begin = std::find_if(digits, digits + width, [](const char& c) { return c != '0'; });
+    const size_t length = digits + width - begin;
+    std::memmove(digits, begin, length);
+    if (sign)
+        *first = '-';
+    return digits + length;
+}
+
+void BigInt::write(std::ostream& out) const {
+    if (_limbs.empty()) {
+        out << '0';
+        return;
+    }
+    if (!_positive)
         out << '-';
-    out << *(x._num);
+
+    // collect digits into a fixed buffer and hand them to the stream in large chunks
+    constexpr size_t capacity = 1 << 16;
+    std::string buffer{};
+    buffer.reserve(capacity);
+    writeDecimal(_limbs, 0, [&](const char* digits, const size_t& length) {
+        if (buffer.size() + length > capacity) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+        buffer.append(digits, length);
+    });
+    out.write(buffer.data(), buffer.size());
+}
+
+const BigInt::LimbVector& BigInt::limbs() const noexcept {
+    return _limbs;
+}
+
+std::ostream& operator<<(std::ostream& out, const BigInt& x) {
+    x.write(out);
     return out;
 }
 
-BigInt abs(const BigInt& x) noexcept {
-    assert(!x._num);
-    return BigInt(std::make_shared<std::string>(*x._num), *x._num != "0" ? true : false);
+BigInt abs(const BigInt& x) {
+    BigInt res{x};
+    res._positive = !res._limbs.empty();
+    return res;
 }
 
-BigInt abs(const BigInt&& x) noexcept {
-    assert(!x._num);
-    std::string tmp = std::move(*x._num);
-    bool sign = tmp != "0" ? true : false;
-    return BigInt(std::make_shared<std::string>(std::move(tmp)), sign);
+BigInt abs(BigInt&& x) noexcept {
+    BigInt res{std::move(x)};
+    res._positive = !res._limbs.empty();
+    return res;
+}
+
+namespace {
+
+using Limb = BigInt::Limb;
+
+// -m^-1 mod 2^32 for odd m, each Newton step doubles the number of correct bits
+Limb montgomeryInverse(const Limb& m) noexcept {
+    Limb inverse = m;
+    for (int i = 0; i < 4; ++i)
+        inverse *= 2 - m * inverse;
+    return 0u - inverse;
+}
+
+// out = a * b / 2^(32n) mod m (CIOS), operands have n limbs and are below m
+// scratch must hold n + 2 limbs, out may alias a or b
+void montgomeryMultiply(const Limb* a, const Limb* b, const Limb* m, const size_t& n, const Limb& inverse, Limb* scratch, Limb* out) noexcept {
+    Limb* t = scratch;
+    std::fill(t, t + n + 2, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; ++j) {
+            uint64_t cur = uint64_t{a[j]} * b[i] + t[j] + carry;
+            t[j] = static_cast<Limb>(cur);
+            carry = cur >> 32;
+        }
+        uint64_t cur = uint64_t{t[n]} + carry;
+        t[n] = static_cast<Limb>(cur);
+        t[n + 1] = static_cast<Limb>(cur >> 32);
+
+        // add q * m so the lowest limb becomes zero, then drop it
+        Limb q = t[0] * inverse;
+        carry = (uint64_t{q} * m[0] + t[0]) >> 32;
+        for (size_t j = 1; j < n; ++j) {
+            cur = uint64_t{q} * m[j] + t[j] + carry;
+            t[j - 1] = static_cast<Limb>(cur);
+            carry = cur >> 32;
+        }
+        cur = uint64_t{t[n]} + carry;
+        t[n - 1] = static_cast<Limb>(cur);
+        t[n] = t[n + 1] + static_cast<Limb>(cur >> 32);
+    }
+
+    // t < 2m, one conditional subtraction brings it below m
+    bool subtract = t[n] != 0;
+    for (size_t i = n; !subtract && i-- > 0; ) {
+        if (t[i] != m[i]) {
+            subtract = t[i] > m[i];
+            break;
+        }
+        if (i == 0)
+            subtract = true;
+    }
+    if (subtract) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            int64_t total = int64_t{t[i]} - m[i] - borrow;
+            borrow = total < 0;
+            t[i] = static_cast<Limb>(total);
+        }
+    }
+    std::copy(t, t + n, out);
+}
+
+// left-to-right sliding window exponentiation, exp must be positive
+template <typename T, typename Multiply>
+T slidingWindowPower(const T& base, const BigInt& exp, const Multiply& multiply) {
+    const auto& e = exp.limbs();
+    const size_t bits = exp.bitLength();
+    const size_t window = bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : bits > 5 ? 2 : 1;
+    auto bit = [&](const size_t& i) -> bool { return (e[i / 32] >> (i % 32)) & 1; };
+
+    // odd powers base, base^3, ..., base^(2^window - 1)
+    std::vector<T> table{base};
+    if (window > 1) {
+        T square = multiply(base, base);
+        for (size_t k = 1; k < (size_t{1} << (window - 1)); ++k)
+            table.push_back(multiply(table.back(), square));
+    }
+
+    T res{};
+    bool first = true;
+    for (size_t i = bits; i-- > 0; ) {
+        if (!bit(i)) {
+            res = multiply(res, res);
+            continue;
+        }
+        size_t low = i + 1 >= window ? i + 1 - window : 0;
+        while (!bit(low))
+            ++low;
+        size_t value = 0;
+        for (size_t k = i + 1; k-- > low; )
+            value = (value << 1) | bit(k);
+
+        if (first) {
+            res = table[value >> 1];
+            first = false;
+        } else {
+            for (size_t k = low; k <= i; ++k)
+                res = multiply(res, res);
+            res = multiply(res, table[value >> 1]);
+        }
+        i = low;
+    }
+    return res;
+}
+
+// the 64 bits of x starting at bit shift
+uint64_t extractBits(const BigInt::LimbVector& x, const size_t& shift) noexcept {
+    const size_t limb = shift / 32;
+    const size_t bits = shift % 32;
+    auto at = [&](const size_t& i) -> uint64_t { return i < x.size() ? x[i] : 0; };
+    uint64_t low = at(limb) | (at(limb + 1) << 32);
+    if (bits == 0)
+        return low;
+    return (low >> bits) | (at(limb + 2) << (64 - bits));
+}
+
+uint64_t toUnsigned(const BigInt& x) noexcept {
+    return extractBits(x.limbs(), 0);
+}
+
+BigInt fromUnsigned(const uint64_t& x) {
+    return (BigInt(static_cast<long long>(x >> 32)) << 32) + BigInt(static_cast<long long>(x & 0xffffffffu));
+}
+
+uint64_t binaryGcd(uint64_t a, uint64_t b) noexcept {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    const int shift = std::countr_zero(a | b);
+    a >>= std::countr_zero(a);
+    do {
+        b >>= std::countr_zero(b);
+        if (a > b)
+            std::swap(a, b);
+        b -= a;
+    } while (b);
+    return a << shift;
+}
+
+// Lehmer's gcd on a >= b >= 0, reduce until b fits in 64 bits
+// when cofactors are tracked, a = ua * a0 (mod b0) and b = ub * a0 (mod b0) hold throughout
+template <bool COFACTOR>
+void lehmerReduce(BigInt& a, BigInt& b, BigInt& ua, BigInt& ub) {
+    while (b.bitLength() > 64) {
+        // simulate Euclid on the leading 32 bits, with cofactors kept in single precision
+        const size_t shift = a.bitLength() - 32;
+        int64_t ah = static_cast<int64_t>(extractBits(a.limbs(), shift));
+        int64_t bh = static_cast<int64_t>(extractBits(b.limbs(), shift));
+        int64_t A = 1, B = 0, C = 0, D = 1;
+        while (bh + C > 0 && bh + D > 0) {
+            int64_t q = (ah + A) / (bh + C);
+            if (q != (ah + B) / (bh + D))
+                break;
+            int64_t t = A - q * C; A = C; C = t;
+            t = B - q * D; B = D; D = t;
+            t = ah - q * bh; ah = bh; bh = t;
+        }
+
+        if (B == 0) {
+            // no progress from the leading bits, do one full division step
+            BigInt q = a / b;
+            BigInt r = a - q * b;
+            a = std::move(b);
+            b = std::move(r);
+            if constexpr (COFACTOR) {
+                BigInt u = ua - q * ub;
+                ua = std::move(ub);
+                ub = std::move(u);
+            }
+        } else {
+            BigInt na = BigInt(static_cast<long long>(A)) * a + BigInt(static_cast<long long>(B)) * b;
+            BigInt nb = BigInt(static_cast<long long>(C)) * a + BigInt(static_cast<long long>(D)) * b;
+            a = std::move(na);
+            b = std::move(nb);
+            if constexpr (COFACTOR) {
+                BigInt nua = BigInt(static_cast<long long>(A)) * ua + BigInt(static_cast<long long>(B)) * ub;
+                BigInt nub = BigInt(static_cast<long long>(C)) * ua + BigInt(static_cast<long long>(D)) * ub;
+                ua = std::move(nua);
+                ub = std::move(nub);
+            }
+        }
+    }
+}
+
+}
+
+BigInt pow(const BigInt& base, unsigned long long exp) {
+    BigInt res{1ll};
+    BigInt square{base};
+    while (exp) {
+        if (exp & 1)
+            res *= square;
+        exp >>= 1;
+        if (exp)
+            square *= square;
+    }
+    return res;
+}
+
+BigInt modpow(const BigInt& base, const BigInt& exp, const BigInt& mod) {
+    if (!mod)
+        throw std::invalid_argument("Modulus of zero is undefined");
+    if (exp.isNegative())
+        throw std::invalid_argument("Negative exponent is undefined");
+
+    const BigInt::LimbVector& m = mod._limbs;
+    if (m.size() == 1 && m[0] == 1)
+        return BigInt{};
+
+    BigInt b{base % mod};
+    if (b.isNegative())
+        b += abs(mod);
+    if (!exp)
+        return BigInt{1ll};
+
+    if (!(m[0] & 1)) {
+        // even modulus, Barrett reduction with a reciprocal computed once
+        const BigInt::LimbVector inverse = BigInt::reciprocal(m);
+        return slidingWindowPower(b, exp, [&](const BigInt& x, const BigInt& y) {
+            BigInt::LimbVector remainder{};
+            BigInt::barrettDivMod(BigInt::mulMagnitude(x._limbs, y._limbs), m, inverse, nullptr, remainder);
+            return BigInt{std::move(remainder), true};
+        });
+    }
+
+    // Montgomery form with R = 2^(32n), every product is reduced without division
+    const size_t n = m.size();
+    const Limb inverse = montgomeryInverse(m[0]);
+    BigInt::LimbVector scratch(n + 2, 0);
+    auto multiply = [&](const BigInt::LimbVector& x, const BigInt::LimbVector& y) {
+        BigInt::LimbVector res(n, 0);
+        montgomeryMultiply(x.data(), y.data(), m.data(), n, inverse, scratch.data(), res.data());
+        return res;
+    };
+
+    BigInt::LimbVector montgomeryBase{};
+    BigInt::divModMagnitude((b << (32 * n))._limbs, m, nullptr, &montgomeryBase);
+    montgomeryBase.resize(n, 0);
+
+    BigInt::LimbVector res = slidingWindowPower(montgomeryBase, exp, multiply);
+
+    // leave Montgomery form by multiplying with 1
+    BigInt::LimbVector one(n, 0);
+    one[0] = 1;
+    return BigInt{multiply(res, one), true};
+}
+
+BigInt gcd(const BigInt& lhs, const BigInt& rhs) {
+    BigInt a = abs(lhs), b = abs(rhs);
+    if (a < b)
+        std::swap(a, b);
+    BigInt unused{};
+    lehmerReduce<false>(a, b, unused, unused);
+    if (!b)
+        return a;
+    a %= b;
+    return fromUnsigned(binaryGcd(toUnsigned(a), toUnsigned(b)));
+}
+
+std::tuple<BigInt, BigInt, BigInt> extendedGcd(const BigInt& lhs, const BigInt& rhs) {
+    const BigInt a0 = abs(lhs), b0 = abs(rhs);
+    BigInt a = a0, b = b0;
+    BigInt ua{1ll}, ub{};
+    if (a < b) {
+        std::swap(a, b);
+        std::swap(ua, ub);
+    }
+    lehmerReduce<true>(a, b, ua, ub);
+
+    // numbers are small now, finish with plain Euclid
+    while (b) {
+        BigInt q = a / b;
+        BigInt r = a - q * b;
+        a = std::move(b);
+        b = std::move(r);
+        BigInt u = ua - q * ub;
+        ua = std::move(ub);
+        ub = std::move(u);
+    }
+
+    // a = ua * a0 + v * b0
+    BigInt v = b0 ? (a - ua * a0) / b0 : BigInt{};
+    if (lhs.isNegative())
+        ua = -ua;
+    if (rhs.isNegative())
+        v = -v;
+    return {a, ua, v};
+}
+
+BigInt isqrt(const BigInt& x) {
+    if (x.isNegative())
+        throw std::invalid_argument("Square root of negative number is undefined");
+    if (!x)
+        return BigInt{};
+
+    // start just above the root, from the root of the leading bits, so the iteration decreases monotonically
+    // the leading half is itself solved recursively, then a couple of full size steps finish the job
+    const size_t bits = x.bitLength();
+    BigInt y{};
+    if (bits <= 104) {
+        const size_t shift = bits > 52 ? (bits - 52 + 1) & ~size_t{1} : 0;
+        double top = static_cast<double>(toUnsigned(x >> shift));
+        y = BigInt(static_cast<long long>(std::sqrt(top)) + 2) << (shift / 2);
+    } else {
+        const size_t shift = bits / 4;
+        y = (isqrt(x >> (2 * shift)) + BigInt(1ll)) << shift;
+    }
+
+    while (true) {
+        BigInt z = (y + x / y) >> 1;
+        if (z >= y)
+            return y;
+        y = std::move(z);
+    }
 }
 
 }
@@ -0,0 +1,183 @@
+#include "BigInt.hpp"
+
+#include <bit>
+#include <array>
+#include <utility>
+#include <optional>
+#include "ModNum.hpp"
+#include "Reduction.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace {
+
+using Limb = BigInt::Limb;
+using LimbVector = BigInt::LimbVector;
+
+// number of primes available, their product exceeds 2^1392
+constexpr size_t CRT_PRIME_COUNT = 48;
+
+// every prime is above 2^29, so t of them multiply to more than 2^(29 t)
+constexpr size_t CRT_PRIME_BITS = 29;
+
+// the largest primes below 2^30: residues fit 32-bit lanes and the ModNum matrix kernel
+// accumulates 16 of their products in 64 bits before reducing
+constexpr std::array<uint32_t, CRT_PRIME_COUNT> CRT_PRIMES = []() {
+    std::array<uint32_t, CRT_PRIME_COUNT> res{};
+    uint32_t candidate = uint32_t{1} << 30;
+    for (uint32_t& p : res) {
+        do {
+            --candidate;
+        } while (!isPrime(candidate));
+        p = candidate;
+    }
+    return res;
+}();
+
+// the classical product is faster below this inner dimension, or when more than
+// PRIMES_PER_TERM primes per term of the inner dimension are needed (Garner's algorithm
+// is quadratic in the number of primes)
+constexpr size_t MODULAR_THRESHOLD = 12;
+constexpr size_t PRIMES_PER_TERM = 2;
+
+// conversions to and from residues are split in pieces of this many entries
+constexpr size_t PARALLEL_ENTRY_GRAIN = 64;
+
+// x mod P in [0, P)
+template <uint32_t P>
+uint32_t residue(const BigInt& x) noexcept {
+    const LimbVector& limbs = x.limbs();
+    uint64_t res = 0;
+    for (size_t i = limbs.size(); i-- > 0; )
+        res = ((res << 32) | limbs[i]) % P;
+    return x.isNegative() && res ? static_cast<uint32_t>(P - res) : static_cast<uint32_t>(res);
+}
+
+// out = lhs * rhs modulo the prime CRT_PRIMES[I], in [0, p)
+// one instance per prime so that every reduction is by a constant
+template <size_t I>
+void residueProduct(const BigInt* lhs, const BigInt* rhs, uint32_t* out, const size_t& n, const size_t& k, const size_t& m) {
+    constexpr uint32_t p = CRT_PRIMES[I];
+    using Residue = ModNum<uint32_t, p>;
+    std::vector<Residue> a(n * k), b(k * m), c(n * m);
+    for (size_t i = 0; i < n * k; ++i)
+        a[i] = residue<p>(lhs[i]);
+    for (size_t i = 0; i < k * m; ++i)
+        b[i] = residue<p>(rhs[i]);
+    MatrixKernel<Residue>::multiply(a.data(), b.data(), c.data(), n, k, m);
+    for (size_t i = 0; i < n * m; ++i)
+        out[i] = c[i].get();
+}
+
+// Garner's algorithm: an entry is v0 + p0 (v1 + p1 (v2 + ...)) with mixed radix digits vi in [0, pi)
+// turn the residues modulo CRT_PRIMES[I] of entries [first, last) into the digits vI,
+// given the digits of the previous primes and inverses[j] = pj^-1 mod pI
+template <size_t I>
+void garnerDigits(uint32_t* digits, const size_t& count, const uint32_t* inverses, const size_t& first, const size_t& last) noexcept {
+    constexpr uint64_t p = CRT_PRIMES[I];
+    uint32_t* v = digits + I * count;
+    for (size_t j = 0; j < I; ++j) {
+        const uint32_t* previous = digits + j * count;
+        for (size_t e = first; e < last; ++e)
+            v[e] = static_cast<uint32_t>((v[e] + p - previous[e] % p) * inverses[j] % p);
+    }
+}
+
+using ResidueProduct = void (*)(const BigInt*, const BigInt*, uint32_t*, const size_t&, const size_t&, const size_t&);
+using GarnerDigits = void (*)(uint32_t*, const size_t&, const uint32_t*, const size_t&, const size_t&);
+
+template <size_t... I>
+constexpr std::array<ResidueProduct, sizeof...(I)> residueProducts(std::index_sequence<I...>) {
+    return { &residueProduct<I>... };
+}
+
+template <size_t... I>
+constexpr std::array<GarnerDigits, sizeof...(I)> garnerSteps(std::index_sequence<I...>) {
+    return { &garnerDigits<I>... };
+}
+
+constexpr std::array<ResidueProduct, CRT_PRIME_COUNT> RESIDUE_PRODUCTS = residueProducts(std::make_index_sequence<CRT_PRIME_COUNT>{});
+constexpr std::array<GarnerDigits, CRT_PRIME_COUNT> GARNER_STEPS = garnerSteps(std::make_index_sequence<CRT_PRIME_COUNT>{});
+
+size_t maxBitLength(const BigInt* x, const size_t& count) noexcept {
+    size_t res = 0;
+    for (size_t i = 0; i < count; ++i)
+        res = std::max(res, x[i].bitLength());
+    return res;
+}
+
+}
+
+// the entries of out are assigned on the calling thread once the pool tasks are done: a task
+// builds them in its own storage, assigning into out there would allocate from the memory
+// policy of the caller (see PolicyAllocator) on another thread
+void MatrixKernel<BigInt>::multiply(const BigInt* lhs, const BigInt* rhs, BigInt* out, const size_t& n, const size_t& k, const size_t& m) {
+    // |out| < k * 2^(a + b) for entries of lhs below 2^a and of rhs below 2^b,
+    // the primes must multiply to more than twice that to recover the sign
+    const size_t lhsBits = maxBitLength(lhs, n * k), rhsBits = maxBitLength(rhs, k * m);
+    const size_t primes = lhsBits && rhsBits ? (lhsBits + rhsBits + std::bit_width(k) + 1 + CRT_PRIME_BITS - 1) / CRT_PRIME_BITS : 0;
+
+    const size_t count = n * m;
+    std::vector<std::optional<BigInt>> entries(count);
+    auto store = [&]() {
+        for (size_t e = 0; e < count; ++e)
+            out[e] = std::move(*entries[e]);
+    };
+
+    if (k < MODULAR_THRESHOLD || primes > std::min(CRT_PRIME_COUNT, PRIMES_PER_TERM * k)) {
+        // classical product, the entries are too large for the primes or the matrices too small to amortize them
+        ThreadPool::shared().parallelFor(0, n, 1, [&](const size_t& first, const size_t& last) {
+            for (size_t i = first; i < last; ++i) {
+                for (size_t j = 0; j < m; ++j) {
+                    BigInt& sum = entries[i * m + j].emplace();
+                    for (size_t p = 0; p < k; ++p)
+                        sum += lhs[i * k + p] * rhs[p * m + j];
+                }
+            }
+        });
+        store();
+        return;
+    }
+    if (primes == 0) {
+        for (size_t i = 0; i < n * m; ++i)
+            out[i] = BigInt{};
+        return;
+    }
+
+    std::vector<uint32_t> digits(primes * count);
+    ThreadPool::shared().parallelFor(0, primes, 1, [&](const size_t& first, const size_t& last) {
+        for (size_t j = first; j < last; ++j)
+            RESIDUE_PRODUCTS[j](lhs, rhs, digits.data() + j * count, n, k, m);
+    });
+
+    // inverses[i * primes + j] = pj^-1 mod pi for j < i
+    std::vector<uint32_t> inverses(primes * primes);
+    for (size_t i = 0; i < primes; ++i) {
+        for (size_t j = 0; j < i; ++j)
+            inverses[i * primes + j] = static_cast<uint32_t>(inverseMod(CRT_PRIMES[j] % CRT_PRIMES[i], CRT_PRIMES[i]));
+    }
+    LimbVector modulus{1};
+    for (size_t i = 0; i < primes; ++i)
+        BigInt::mulSmall(modulus, CRT_PRIMES[i], 0);
+    LimbVector half{modulus};
+    BigInt::shiftRightMagnitude(half, 1);
+
+    ThreadPool::shared().parallelFor(0, count, PARALLEL_ENTRY_GRAIN, [&](const size_t& first, const size_t& last) {
+        for (size_t i = 0; i < primes; ++i)
+            GARNER_STEPS[i](digits.data(), count, inverses.data() + i * primes, first, last);
+        for (size_t e = first; e < last; ++e) {
+            LimbVector limbs{};
+            for (size_t i = primes; i-- > 0; )
+                BigInt::mulSmall(limbs, CRT_PRIMES[i], digits[i * count + e]);
+            // residues above half the modulus stand for negative entries
+            const bool negative = BigInt::compareMagnitude(limbs, half) > 0;
+            if (negative)
+                BigInt::reverseSubMagnitude(limbs, modulus);
+            entries[e].emplace(BigInt(std::move(limbs), !negative));
+        }
+    });
+    store();
+}
+
+}
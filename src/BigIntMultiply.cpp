@@ -0,0 +1,313 @@
+#include "BigInt.hpp"
+
+#include <bit>
+#include <optional>
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace {
+
+using Limb = BigInt::Limb;
+using LimbVector = BigInt::LimbVector;
+using Residues = std::vector<uint32_t, PolicyAllocator<uint32_t>>;
+
+// below these sizes (in limbs of the shorter operand) the simpler algorithm is faster
+constexpr size_t KARATSUBA_THRESHOLD = 40;
+constexpr size_t NTT_THRESHOLD = 3000;
+
+// products whose shorter operand has at least this many limbs fork their subproducts on the shared pool
+constexpr size_t PARALLEL_MULTIPLY_THRESHOLD = 1 << 10;
+
+// butterfly passes and pointwise loops of transforms are split in pieces of this many elements
+constexpr size_t PARALLEL_NTT_GRAIN = 1 << 14;
+
+// primes of the form c * 2^k + 1 with 3 as primitive root, the smallest k is 23
+// a coefficient of the convolution of limbs is below min(n, m) * 2^64 <= 2^86 < p0 * p1 * p2
+// when n + m <= 2^23, so it is recovered exactly by the Chinese remainder theorem
+constexpr uint32_t NTT_PRIMES[3] = {998244353, 167772161, 469762049};
+
+// operands above this total size (in limbs) do not fit the longest transform and are split first
+constexpr size_t NTT_MAX_LIMBS = size_t{1} << 23;
+
+constexpr uint64_t powMod(uint64_t base, uint64_t exp, const uint64_t& mod) noexcept {
+    uint64_t res = 1;
+    for (base %= mod; exp; exp >>= 1, base = base * base % mod) {
+        if (exp & 1)
+            res = res * base % mod;
+    }
+    return res;
+}
+
+// arithmetic modulo an NTT prime, twiddle factors are kept in Montgomery form (R = 2^32)
+// so that mul(x, toMontgomery(w)) = x * w for x in normal form
+class NttPrime final {
+private:
+    uint32_t _p;
+    // -p^-1 mod 2^32
+    uint32_t _negInv;
+    // 2^64 mod p
+    uint32_t _r2;
+
+public:
+    constexpr explicit NttPrime(const uint32_t& p) noexcept : _p { p }, _negInv { 0 }, _r2 { 0 } {
+        uint32_t inv = p;
+        for (int i = 0; i < 4; ++i)
+            inv *= 2 - p * inv;
+        _negInv = -inv;
+        uint64_t r = (uint64_t{1} << 32) % p;
+        _r2 = static_cast<uint32_t>(r * r % p);
+    }
+
+    constexpr uint32_t modulus() const noexcept {
+        return _p;
+    }
+
+    // t * 2^-32 mod p, requires t < p * 2^32
+    constexpr uint32_t reduce(const uint64_t& t) const noexcept {
+        uint32_t m = static_cast<uint32_t>(t) * _negInv;
+        uint32_t res = static_cast<uint32_t>((t + uint64_t{m} * _p) >> 32);
+        return res >= _p ? res - _p : res;
+    }
+
+    constexpr uint32_t mul(const uint32_t& lhs, const uint32_t& rhs) const noexcept {
+        return reduce(uint64_t{lhs} * rhs);
+    }
+
+    constexpr uint32_t add(const uint32_t& lhs, const uint32_t& rhs) const noexcept {
+        uint32_t res = lhs + rhs;
+        return res >= _p ? res - _p : res;
+    }
+
+    constexpr uint32_t sub(const uint32_t& lhs, const uint32_t& rhs) const noexcept {
+        return lhs >= rhs ? lhs - rhs : lhs + _p - rhs;
+    }
+
+    constexpr uint32_t toMontgomery(const uint32_t& x) const noexcept {
+        return reduce(uint64_t{x} * _r2);
+    }
+};
+
+// roots[half + j] = w^j in Montgomery form, w a primitive (2 * half)-th root of unity
+// (or its inverse), for every power of two half below size
+Residues rootTable(const NttPrime& prime, const size_t& size, const bool& inverse) {
+    const uint32_t p = prime.modulus();
+    Residues roots(size);
+    for (size_t half = 1; half < size; half <<= 1) {
+        uint64_t exp = (p - 1) / (2 * half);
+        uint32_t w = prime.toMontgomery(static_cast<uint32_t>(powMod(3, inverse ? p - 1 - exp : exp, p)));
+        roots[half] = prime.toMontgomery(1);
+        for (size_t j = 1; j < half; ++j)
+            roots[half + j] = prime.mul(roots[half + j - 1], w);
+    }
+    return roots;
+}
+
+// one butterfly pass over blocks of 2 * half elements, butterflies [first, last) of size / 2
+// prime is taken by value, through a reference its fields could alias a and be reloaded every step
+template <bool INVERSE>
+void butterflies(const NttPrime prime, uint32_t* a, const uint32_t* roots, const size_t& half, const size_t& first, const size_t& last) noexcept {
+    for (size_t t = first; t < last; ) {
+        size_t block = t / half * 2 * half;
+        size_t j = t % half;
+        size_t end = std::min(last - t, half - j) + j;
+        for ( ; j < end; ++j, ++t) {
+            uint32_t& x = a[block + j];
+            uint32_t& y = a[block + j + half];
+            if constexpr (INVERSE) {
+                // Cooley-Tukey
+                uint32_t u = x, v = prime.mul(y, roots[half + j]);
+                x = prime.add(u, v);
+                y = prime.sub(u, v);
+            } else {
+                // Gentleman-Sande
+                uint32_t u = x, v = y;
+                x = prime.add(u, v);
+                y = prime.mul(prime.sub(u, v), roots[half + j]);
+            }
+        }
+    }
+}
+
+// forward transform takes natural order to bit-reversed order, the inverse takes it back
+// so no permutation is ever needed, the inverse is not scaled by 1 / size
+template <bool INVERSE>
+void transform(const NttPrime& prime, Residues& a, const Residues& roots) {
+    const size_t size = a.size();
+    auto pass = [&](const size_t& half) {
+        if (size >= 2 * PARALLEL_NTT_GRAIN) {
+            ThreadPool::shared().parallelFor(0, size / 2, PARALLEL_NTT_GRAIN, [&](const size_t& first, const size_t& last) {
+                butterflies<INVERSE>(prime, a.data(), roots.data(), half, first, last);
+            });
+        } else {
+            butterflies<INVERSE>(prime, a.data(), roots.data(), half, 0, size / 2);
+        }
+    };
+    if constexpr (INVERSE) {
+        for (size_t half = 1; half < size; half <<= 1)
+            pass(half);
+    } else {
+        for (size_t half = size / 2; half >= 1; half >>= 1)
+            pass(half);
+    }
+}
+
+// limbs reduced modulo p, zero padded to size
+Residues residues(const Limb* x, const size_t& n, const uint32_t& p, const size_t& size) {
+    Residues res(size, 0);
+    for (size_t i = 0; i < n; ++i)
+        res[i] = x[i] % p;
+    return res;
+}
+
+// cyclic convolution of the limbs of lhs and rhs modulo prime
+Residues convolve(const NttPrime& prime, const Limb* lhs, const size_t& n, const Limb* rhs, const size_t& m, const size_t& size) {
+    Residues roots = rootTable(prime, size, false);
+    std::optional<Residues> a{}, b{};
+    ThreadPool::shared().invoke(
+        [&]() { a.emplace(residues(lhs, n, prime.modulus(), size)); transform<false>(prime, *a, roots); },
+        [&]() { b.emplace(residues(rhs, m, prime.modulus(), size)); transform<false>(prime, *b, roots); }
+    );
+
+    // a * b loses a factor R in Montgomery reduction, scaling by R / size restores it and undoes the size factor
+    const uint32_t p = prime.modulus();
+    const uint64_t r = (uint64_t{1} << 32) % p;
+    const uint32_t scale = prime.toMontgomery(static_cast<uint32_t>(powMod(size, p - 2, p) * r % p));
+    ThreadPool::shared().parallelFor(0, size, PARALLEL_NTT_GRAIN, [&](const size_t& first, const size_t& last) {
+        for (size_t i = first; i < last; ++i)
+            (*a)[i] = prime.mul((*a)[i], (*b)[i]);
+    });
+    b.reset();
+
+    roots = rootTable(prime, size, true);
+    transform<true>(prime, *a, roots);
+    ThreadPool::shared().parallelFor(0, size, PARALLEL_NTT_GRAIN, [&](const size_t& first, const size_t& last) {
+        for (size_t i = first; i < last; ++i)
+            (*a)[i] = prime.mul((*a)[i], scale);
+    });
+    return std::move(*a);
+}
+
+// product by three-prime number theoretic transform, requires n + m <= NTT_MAX_LIMBS
+LimbVector nttMultiply(const Limb* lhs, const size_t& n, const Limb* rhs, const size_t& m) {
+    static constexpr NttPrime primes[3] = {NttPrime{NTT_PRIMES[0]}, NttPrime{NTT_PRIMES[1]}, NttPrime{NTT_PRIMES[2]}};
+    const size_t size = std::bit_ceil(n + m);
+
+    // the three transforms are independent
+    std::optional<Residues> r0{}, r1{}, r2{};
+    ThreadPool::shared().invoke(
+        [&]() { r0.emplace(convolve(primes[0], lhs, n, rhs, m, size)); },
+        [&]() {
+            ThreadPool::shared().invoke(
+                [&]() { r1.emplace(convolve(primes[1], lhs, n, rhs, m, size)); },
+                [&]() { r2.emplace(convolve(primes[2], lhs, n, rhs, m, size)); }
+            );
+        }
+    );
+
+    // Garner: x = x0 + p0 * t1 + p0 * p1 * t2
+    // the mixed-radix digits are independent per coefficient, only the carry below is sequential
+    constexpr uint64_t p0 = NTT_PRIMES[0], p1 = NTT_PRIMES[1], p2 = NTT_PRIMES[2];
+    constexpr uint64_t inv01 = powMod(p0, p1 - 2, p1);
+    constexpr uint64_t inv012 = powMod(p0 * p1 % p2, p2 - 2, p2);
+    const size_t count = n + m - 1;
+    std::vector<uint64_t, PolicyAllocator<uint64_t>> low(count);
+    ThreadPool::shared().parallelFor(0, count, PARALLEL_NTT_GRAIN, [&](const size_t& first, const size_t& last) {
+        for (size_t i = first; i < last; ++i) {
+            uint64_t x0 = (*r0)[i], x1 = (*r1)[i], x2 = (*r2)[i];
+            uint64_t t1 = (x1 + p1 - x0 % p1) % p1 * inv01 % p1;
+            uint64_t v = x0 + p0 * t1;
+            (*r2)[i] = static_cast<uint32_t>((x2 + p2 - v % p2) % p2 * inv012 % p2);
+            low[i] = v;
+        }
+    });
+
+    LimbVector res(n + m, 0);
+    unsigned __int128 carry = 0;
+    for (size_t i = 0; i < count; ++i) {
+        carry += low[i] + static_cast<unsigned __int128>(p0 * p1) * (*r2)[i];
+        res[i] = static_cast<Limb>(carry);
+        carry >>= 32;
+    }
+    // the product has at most n + m limbs
+    res[count] = static_cast<Limb>(carry);
+    return res;
+}
+
+}
+
+BigInt::LimbVector BigInt::mulRange(const Limb* lhs, const size_t& n, const Limb* rhs, const size_t& m) {
+    if (n < m)
+        return mulRange(rhs, m, lhs, n);
+
+    LimbVector res{};
+    if (m == 0)
+        return res;
+
+    ThreadPool& pool = ThreadPool::shared();
+    if (m < KARATSUBA_THRESHOLD) {
+        res.assign(n + m, 0);
+        for (size_t i = 0; i < m; ++i) {
+            uint64_t carry = 0;
+            uint64_t x = rhs[i];
+            for (size_t j = 0; j < n; ++j) {
+                uint64_t total = x * lhs[j] + res[i + j] + carry;
+                res[i + j] = static_cast<Limb>(total);
+                carry = total >> 32;
+            }
+            res[i + n] = static_cast<Limb>(carry);
+        }
+    } else if (m >= NTT_THRESHOLD && n + m <= NTT_MAX_LIMBS) {
+        res = nttMultiply(lhs, n, rhs, m);
+    } else if (n >= 2 * m) {
+        // unbalanced, split lhs at a multiple of m so every leaf is a balanced product
+        const size_t k = (n / m / 2) * m;
+        std::optional<LimbVector> high{};
+        auto mulLow = [&]() { res = mulRange(lhs, k, rhs, m); };
+        auto mulHigh = [&]() { high.emplace(mulRange(lhs + k, n - k, rhs, m)); };
+        if (n >= PARALLEL_MULTIPLY_THRESHOLD) {
+            pool.invoke(mulLow, mulHigh);
+        } else {
+            mulLow();
+            mulHigh();
+        }
+        addShifted(res, *high, k);
+    } else {
+        // Karatsuba: (a1 B^k + a0)(b1 B^k + b0) = z2 B^2k + ((a0 + a1)(b0 + b1) - z0 - z2) B^k + z0
+        const size_t k = n / 2;
+        std::optional<LimbVector> z0{}, z1{}, z2{};
+        auto mulLow = [&]() { z0.emplace(mulRange(lhs, k, rhs, k)); };
+        auto mulHigh = [&]() { z2.emplace(mulRange(lhs + k, n - k, rhs + k, m - k)); };
+        auto mulMiddle = [&]() {
+            LimbVector lhsSum(lhs, lhs + k);
+            addMagnitude(lhsSum, LimbVector(lhs + k, lhs + n));
+            LimbVector rhsSum(rhs, rhs + k);
+            addMagnitude(rhsSum, LimbVector(rhs + k, rhs + m));
+            z1.emplace(mulRange(lhsSum.data(), lhsSum.size(), rhsSum.data(), rhsSum.size()));
+        };
+        if (m >= PARALLEL_MULTIPLY_THRESHOLD) {
+            pool.invoke(mulLow, [&]() { pool.invoke(mulHigh, mulMiddle); });
+        } else {
+            mulLow();
+            mulHigh();
+            mulMiddle();
+        }
+        while (!z1->empty() && z1->back() == 0)
+            z1->pop_back();
+        while (!z0->empty() && z0->back() == 0)
+            z0->pop_back();
+        subMagnitude(*z1, *z0);
+        subMagnitude(*z1, *z2);
+
+        res.assign(n + m, 0);
+        addShifted(res, *z0, 0);
+        addShifted(res, *z1, k);
+        addShifted(res, *z2, 2 * k);
+    }
+
+    while (!res.empty() && res.back() == 0)
+        res.pop_back();
+    return res;
+}
+
+}
@@ -0,0 +1,261 @@
+#include "BitMatrix.hpp"
+
+#include <bit>
+#include <algorithm>
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace {
+
+using Word = BitMatrix::Word;
+constexpr size_t WORD_BITS = BitMatrix::WORD_BITS;
+
+// Four Russians product: every table holds the 2^TABLE_BITS sums of TABLE_BITS consecutive rows
+// of rhs, a row of out then takes one lookup per TABLE_BITS bits of the lhs row instead of one
+// row addition per set bit
+constexpr size_t TABLE_BITS = 8;
+constexpr size_t TABLE_SIZE = size_t{1} << TABLE_BITS;
+
+// tables built together, a pass over the rows of lhs reads one 32-bit piece of each of them
+constexpr size_t TABLES = 4;
+constexpr size_t PIECE_BITS = TABLES * TABLE_BITS;
+static_assert(WORD_BITS % PIECE_BITS == 0 && TABLES == 4 && TABLE_BITS == 8, "lookups of the product are unrolled for 4 bytes");
+
+// words of a row of out per column block, the TABLES tables of a block take 256 KiB
+constexpr size_t BLOCK_WORDS = 32;
+
+// pivots eliminated together by one table in Gauss-Jordan elimination
+constexpr size_t ELIMINATION_BITS = 8;
+
+// rows per task when rows are split across the shared pool
+constexpr size_t PARALLEL_ROW_GRAIN = 256;
+
+inline bool bit(const Word* row, const size_t& col) noexcept {
+    return (row[col / WORD_BITS] >> (col % WORD_BITS)) & 1;
+}
+
+inline void xorWords(Word* lhs, const Word* rhs, const size_t& count) noexcept {
+    for (size_t i = 0; i < count; ++i)
+        lhs[i] ^= rhs[i];
+}
+
+// 64 x 64 block transposed in place, x[i] is row i with column j at bit j
+// swaps the off-diagonal halves of blocks of size 32, 16, ... 1
+void transposeBlock(Word* x) noexcept {
+    Word mask = 0x00000000ffffffffull;
+    for (size_t j = 32; j != 0; j >>= 1, mask ^= mask << j) {
+        for (size_t k = 0; k < WORD_BITS; k = (k + j + 1) & ~j) {
+            const Word t = ((x[k] >> j) ^ x[k + j]) & mask;
+            x[k] ^= t << j;
+            x[k + j] ^= t;
+        }
+    }
+}
+
+// out = lhs * rhs with out zero on entry, sums are XOR for GF(2) and OR for the boolean product
+template <bool OR>
+void fourRussians(const BitMatrix& lhs, const BitMatrix& rhs, BitMatrix& out) {
+    const size_t n = lhs.rows(), k = lhs.cols(), words = rhs.stride();
+    const size_t blocks = (words + BLOCK_WORDS - 1) / BLOCK_WORDS;
+
+    ThreadPool::shared().parallelFor(0, blocks, 1, [&](const size_t& first, const size_t& last) {
+        std::vector<Word> tables(TABLES * TABLE_SIZE * BLOCK_WORDS);
+        for (size_t block = first; block < last; ++block) {
+            const size_t w0 = block * BLOCK_WORDS, width = std::min(BLOCK_WORDS, words - w0);
+            for (size_t p0 = 0; p0 < k; p0 += PIECE_BITS) {
+                // table t, entry s: sum of the rows p0 + t * TABLE_BITS + i of rhs for the bits i of s
+                for (size_t t = 0; t < TABLES; ++t) {
+                    Word* table = tables.data() + t * TABLE_SIZE * BLOCK_WORDS;
+                    std::fill(table, table + width, Word{0});
+                    for (size_t s = 1; s < TABLE_SIZE; ++s) {
+                        const size_t p = p0 + t * TABLE_BITS + std::countr_zero(s);
+                        const Word* previous = table + (s & (s - 1)) * BLOCK_WORDS;
+                        Word* entry = table + s * BLOCK_WORDS;
+                        if (p >= k) {
+                            std::copy(previous, previous + width, entry);
+                            continue;
+                        }
+                        const Word* row = rhs.row(p) + w0;
+                        for (size_t w = 0; w < width; ++w)
+                            entry[w] = OR ? previous[w] | row[w] : previous[w] ^ row[w];
+                    }
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    const Word piece = lhs.row(i)[p0 / WORD_BITS] >> (p0 % WORD_BITS);
+                    if ((piece & ((Word{1} << PIECE_BITS) - 1)) == 0)
+                        continue;
+                    const Word* t0 = tables.data() + (piece & 0xff) * BLOCK_WORDS;
+                    const Word* t1 = tables.data() + (TABLE_SIZE + ((piece >> 8) & 0xff)) * BLOCK_WORDS;
+                    const Word* t2 = tables.data() + (2 * TABLE_SIZE + ((piece >> 16) & 0xff)) * BLOCK_WORDS;
+                    const Word* t3 = tables.data() + (3 * TABLE_SIZE + ((piece >> 24) & 0xff)) * BLOCK_WORDS;
+                    Word* c = out.row(i) + w0;
+                    for (size_t w = 0; w < width; ++w)
+                        c[w] = OR ? c[w] | t0[w] | t1[w] | t2[w] | t3[w] : c[w] ^ t0[w] ^ t1[w] ^ t2[w] ^ t3[w];
+                }
+            }
+        }
+    });
+}
+
+void checkProduct(const BitMatrix& lhs, const BitMatrix& rhs) {
+    if (lhs.cols() != rhs.rows())
+        throw std::invalid_argument("Column number of lhs must match row number of rhs");
+}
+
+}
+
+BitMatrix::BitMatrix(const size_t& rows, const size_t& cols) : _rows { rows }, _cols { cols }, _stride { (cols + WORD_BITS - 1) / WORD_BITS }, _words(rows * _stride) {}
+
+BitMatrix BitMatrix::identity(const size_t& n) {
+    BitMatrix res{n, n};
+    for (size_t i = 0; i < n; ++i)
+        res.set(i, i, true);
+    return res;
+}
+
+void BitMatrix::checkIndex(const size_t& row, const size_t& col) const {
+    if (row >= _rows || col >= _cols)
+        throw std::out_of_range("Matrix index out-of-range");
+}
+
+bool BitMatrix::at(const size_t& row, const size_t& col) const {
+    checkIndex(row, col);
+    return (*this)(row, col);
+}
+
+size_t BitMatrix::count() const noexcept {
+    size_t res = 0;
+    for (const Word& word : _words)
+        res += std::popcount(word);
+    return res;
+}
+
+BitMatrix BitMatrix::transpose() const {
+    BitMatrix res{_cols, _rows};
+    const size_t blocks = (_rows + WORD_BITS - 1) / WORD_BITS;
+    ThreadPool::shared().parallelFor(0, blocks, PARALLEL_ROW_GRAIN / WORD_BITS, [&](const size_t& first, const size_t& last) {
+        Word x[WORD_BITS];
+        for (size_t b = first; b < last; ++b) {
+            const size_t i0 = b * WORD_BITS, height = std::min(WORD_BITS, _rows - i0);
+            for (size_t w = 0; w < _stride; ++w) {
+                for (size_t r = 0; r < WORD_BITS; ++r)
+                    x[r] = r < height ? row(i0 + r)[w] : 0;
+                transposeBlock(x);
+                const size_t j0 = w * WORD_BITS, width = std::min(WORD_BITS, _cols - j0);
+                for (size_t r = 0; r < width; ++r)
+                    res.row(j0 + r)[b] = x[r];
+            }
+        }
+    });
+    return res;
+}
+
+size_t BitMatrix::eliminate() {
+    size_t rank = 0;
+    std::vector<Word> table;
+    for (size_t col = 0; col < _cols && rank < _rows; ) {
+        // rows from rank on are zero before the first word
+        const size_t first = col / WORD_BITS, width = _stride - first;
+
+        // pivots of the next columns, a row is reduced by the pivots found so far before it is tested
+        size_t pivots[ELIMINATION_BITS];
+        size_t found = 0;
+        for ( ; col < _cols && found < ELIMINATION_BITS && rank + found < _rows; ++col) {
+            for (size_t i = rank + found; i < _rows; ++i) {
+                Word* r = row(i) + first;
+                for (size_t a = 0; a < found; ++a) {
+                    if (bit(row(i), pivots[a]))
+                        xorWords(r, row(rank + a) + first, width);
+                }
+                if (bit(row(i), col)) {
+                    std::swap_ranges(r, r + width, row(rank + found) + first);
+                    pivots[found++] = col;
+                    break;
+                }
+            }
+        }
+        if (found == 0)
+            break;
+
+        // clear the later pivot columns from the earlier pivot rows, the block becomes the identity
+        for (size_t a = found; a-- > 1; ) {
+            for (size_t b = 0; b < a; ++b) {
+                if (bit(row(rank + b), pivots[a]))
+                    xorWords(row(rank + b) + first, row(rank + a) + first, width);
+            }
+        }
+
+        // table of all the sums of the pivot rows, one lookup clears the pivot columns of any other row
+        table.assign((size_t{1} << found) * width, 0);
+        for (size_t s = 1; s < (size_t{1} << found); ++s) {
+            const Word* previous = table.data() + (s & (s - 1)) * width;
+            const Word* pivot = row(rank + std::countr_zero(s)) + first;
+            Word* entry = table.data() + s * width;
+            for (size_t w = 0; w < width; ++w)
+                entry[w] = previous[w] ^ pivot[w];
+        }
+        ThreadPool::shared().parallelFor(0, _rows, PARALLEL_ROW_GRAIN, [&](const size_t& begin, const size_t& end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (i >= rank && i < rank + found)
+                    continue;
+                size_t s = 0;
+                for (size_t a = 0; a < found; ++a)
+                    s |= size_t{bit(row(i), pivots[a])} << a;
+                if (s)
+                    xorWords(row(i) + first, table.data() + s * width, width);
+            }
+        });
+        rank += found;
+    }
+    return rank;
+}
+
+size_t BitMatrix::rank() const {
+    BitMatrix copy{*this};
+    return copy.eliminate();
+}
+
+BitMatrix BitMatrix::operator+(const BitMatrix& rhs) const {
+    BitMatrix res{*this};
+    return res += rhs;
+}
+
+BitMatrix& BitMatrix::operator+=(const BitMatrix& rhs) {
+    if (_rows != rhs._rows || _cols != rhs._cols)
+        throw std::invalid_argument("Dimensions must match");
+    xorWords(_words.data(), rhs._words.data(), _words.size());
+    return *this;
+}
+
+BitMatrix BitMatrix::operator*(const BitMatrix& rhs) const {
+    checkProduct(*this, rhs);
+    BitMatrix res{_rows, rhs._cols};
+    fourRussians<false>(*this, rhs, res);
+    return res;
+}
+
+bool BitMatrix::operator==(const BitMatrix& rhs) const noexcept {
+    return _rows == rhs._rows && _cols == rhs._cols && _words == rhs._words;
+}
+
+BitMatrix booleanMultiply(const BitMatrix& lhs, const BitMatrix& rhs) {
+    checkProduct(lhs, rhs);
+    BitMatrix res{lhs.rows(), rhs.cols()};
+    fourRussians<true>(lhs, rhs, res);
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& out, const BitMatrix& m) {
+    for (size_t i = 0; i < m.rows(); ++i) {
+        out << '[';
+        for (size_t j = 0; j < m.cols(); ++j)
+            out << (j ? ", " : "") << m(i, j);
+        out << ']';
+        if (i + 1 != m.rows())
+            out << '\n';
+    }
+    return out;
+}
+
+}
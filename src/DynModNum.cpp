@@ -0,0 +1,34 @@
+#include "DynModNum.hpp"
+
+#include <stdexcept>
+
+namespace vecxify {
+
+namespace {
+
+thread_local const Modulus* currentModulus = nullptr;
+
+uint64_t checkedModulus(const uint64_t& mod) {
+    if (mod == 0 || mod >= (uint64_t{1} << 63))
+        throw std::invalid_argument("Modulus must be in [1, 2^63)");
+    return mod;
+}
+
+}
+
+// Montgomery constants are only meaningful for odd moduli, 1 stands in for even ones
+Modulus::Modulus(const uint64_t& mod) : _montgomery { checkedModulus(mod) % 2 ? mod : 1 }, _barrett { mod }, _odd { mod % 2 == 1 } {}
+
+const Modulus* Modulus::current() noexcept {
+    return currentModulus;
+}
+
+ModulusScope::ModulusScope(const Modulus& mod) noexcept : _previous { currentModulus } {
+    currentModulus = &mod;
+}
+
+ModulusScope::~ModulusScope() {
+    currentModulus = _previous;
+}
+
+}
@@ -0,0 +1,82 @@
+#include "OutOfCore.hpp"
+
+#include <cerrno>
+#include <system_error>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace vecxify {
+
+namespace detail {
+
+namespace {
+
+[[noreturn]] void fail(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+}
+
+File::File(const std::string& path, const bool& create) : _fd { ::open(path.c_str(), create ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR, 0644) } {
+    if (_fd < 0)
+        fail("Cannot open matrix file");
+}
+
+File::File(File&& other) noexcept : _fd { other._fd } {
+    other._fd = -1;
+}
+
+File& File::operator=(File&& other) noexcept {
+    std::swap(_fd, other._fd);
+    return *this;
+}
+
+File::~File() {
+    if (_fd >= 0)
+        ::close(_fd);
+}
+
+uint64_t File::size() const {
+    struct stat info{};
+    if (::fstat(_fd, &info) != 0)
+        fail("Cannot read the size of a matrix file");
+    return static_cast<uint64_t>(info.st_size);
+}
+
+void File::resize(const uint64_t& bytes) {
+    if (::ftruncate(_fd, static_cast<off_t>(bytes)) != 0)
+        fail("Cannot resize a matrix file");
+}
+
+// pread and pwrite may stop early, they are repeated until every byte went through
+void File::read(const uint64_t& offset, void* data, const size_t& bytes) const {
+    char* out = static_cast<char*>(data);
+    for (size_t done = 0; done < bytes; ) {
+        const ssize_t res = ::pread(_fd, out + done, bytes - done, static_cast<off_t>(offset + done));
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res <= 0) {
+            if (res == 0)
+                errno = EIO;
+            fail("Cannot read a matrix file");
+        }
+        done += static_cast<size_t>(res);
+    }
+}
+
+void File::write(const uint64_t& offset, const void* data, const size_t& bytes) {
+    const char* in = static_cast<const char*>(data);
+    for (size_t done = 0; done < bytes; ) {
+        const ssize_t res = ::pwrite(_fd, in + done, bytes - done, static_cast<off_t>(offset + done));
+        if (res < 0 && errno == EINTR)
+            continue;
+        if (res < 0)
+            fail("Cannot write a matrix file");
+        done += static_cast<size_t>(res);
+    }
+}
+
+}
+
+}
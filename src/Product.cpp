@@ -0,0 +1,100 @@
+#include "Product.hpp"
+
+#include <bit>
+#include <limits>
+#include <vector>
+
+namespace vecxify {
+
+namespace {
+
+// factorials of at least this n compute the half factorial and the swing in parallel, below it
+// the swing is a few hundred words and both run inline
+constexpr unsigned long long PARALLEL_FACTORIAL_THRESHOLD = 1 << 12;
+
+std::vector<unsigned long long> primesUpTo(const unsigned long long& n) {
+    std::vector<unsigned long long> primes{};
+    if (n < 2)
+        return primes;
+    std::vector<bool> composite(n + 1, false);
+    for (unsigned long long i = 2; i <= n; ++i) {
+        if (composite[i])
+            continue;
+        primes.push_back(i);
+        for (unsigned long long j = i * i; j <= n; j += i)
+            composite[j] = true;
+    }
+    return primes;
+}
+
+// pack small factors into words below 2^63, the product tree then has far fewer leaves
+void pushFactor(std::vector<long long>& words, const unsigned long long& factor) {
+    constexpr auto limit = static_cast<unsigned long long>(std::numeric_limits<long long>::max());
+    if (words.empty() || static_cast<unsigned long long>(words.back()) > limit / factor)
+        words.push_back(static_cast<long long>(factor));
+    else
+        words.back() *= static_cast<long long>(factor);
+}
+
+// odd part of swing(n) = n! / (floor(n/2)!)^2
+// the exponent of p in swing(n) is the number of odd floor(n / p^i), i >= 1
+BigInt oddSwing(const unsigned long long& n, const std::vector<unsigned long long>& primes) {
+    std::vector<long long> words{};
+    for (size_t i = 1; i < primes.size() && primes[i] <= n; ++i) {
+        const unsigned long long p = primes[i];
+        for (unsigned long long q = n / p; q; q /= p) {
+            if (q & 1)
+                pushFactor(words, p);
+        }
+    }
+    return product<BigInt>(words);
+}
+
+// odd part of n!, (floor(n/2)!)^2 and swing(n) share the odd primes so their odd parts multiply
+BigInt oddFactorial(const unsigned long long& n, const std::vector<unsigned long long>& primes) {
+    if (n < 3)
+        return BigInt(1ll);
+    std::optional<BigInt> half{}, swing{};
+    auto left = [&]() { half.emplace(oddFactorial(n / 2, primes)); };
+    auto right = [&]() { swing.emplace(oddSwing(n, primes)); };
+    if (n >= PARALLEL_FACTORIAL_THRESHOLD) {
+        ThreadPool::shared().invoke(left, right);
+    } else {
+        left();
+        right();
+    }
+    return *half * *half * *swing;
+}
+
+}
+
+BigInt factorial(const unsigned long long& n) {
+    // the power of 2 in n! is n - popcount(n)
+    return oddFactorial(n, primesUpTo(n)) << (n - std::popcount(n));
+}
+
+BigInt binomial(const unsigned long long& n, const unsigned long long& k) {
+    if (k > n)
+        return BigInt{};
+
+    // Legendre: the exponent of p is the sum over i of floor(n / p^i) - floor(k / p^i) - floor((n - k) / p^i)
+    std::vector<long long> words{};
+    for (const unsigned long long& p : primesUpTo(n)) {
+        unsigned long long a = n, b = k, c = n - k;
+        while (a) {
+            a /= p, b /= p, c /= p;
+            for (unsigned long long e = a - b - c; e; --e)
+                pushFactor(words, p);
+        }
+    }
+    return product<BigInt>(words);
+}
+
+BigInt primorial(const unsigned long long& n) {
+    std::vector<long long> words{};
+    for (const unsigned long long& p : primesUpTo(n))
+        pushFactor(words, p);
+    return product<BigInt>(words);
+}
+
+}
@@ -0,0 +1,110 @@
+#include "Quantized.hpp"
+
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+
+namespace vecxify {
+
+namespace detail {
+
+namespace {
+
+// rows of out per task of the shared pool, and products below which the pool is not worth it
+constexpr size_t QUANTIZED_ROWS = 16;
+constexpr size_t PARALLEL_QUANTIZED_WORK = size_t{1} << 18;
+
+int32_t low(const int32_t& word) noexcept {
+    return static_cast<int16_t>(static_cast<uint32_t>(word) & 0xffff);
+}
+
+int32_t high(const int32_t& word) noexcept {
+    return static_cast<int16_t>(static_cast<uint32_t>(word) >> 16);
+}
+
+// columns [col, m) of out rows [first, last), row by row along the pairs so the inner loop vectorizes
+void productScalar(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& first, const size_t& last, const size_t& pairs, const size_t& m, const size_t& col) {
+    for (size_t i = first; i < last; ++i) {
+        int32_t* row = out + i * m;
+        std::fill(row + col, row + m, 0);
+        for (size_t q = 0; q < pairs; ++q) {
+            const int32_t a0 = low(lhs[i * pairs + q]), a1 = high(lhs[i * pairs + q]);
+            const int16_t* b = rhs + q * m * 2;
+            for (size_t j = col; j < m; ++j)
+                row[j] += a0 * b[2 * j] + a1 * b[2 * j + 1];
+        }
+    }
+}
+
+#if VECXIFY_SIMD_DISPATCH
+
+// ROWS x (8 * VECS) block of out at (i, j) in registers, a pair of lhs is broadcast to every lane
+// and vpmaddwd adds its two products with the pair of rhs of the lane into 32 bits
+template <size_t ROWS, size_t VECS>
+VECXIFY_SIMD_AVX2 inline void blockAvx2(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& i, const size_t& j, const size_t& pairs, const size_t& m) noexcept {
+    __m256i acc[ROWS][VECS];
+    for (size_t r = 0; r < ROWS; ++r)
+        for (size_t v = 0; v < VECS; ++v)
+            acc[r][v] = _mm256_setzero_si256();
+    for (size_t q = 0; q < pairs; ++q) {
+        const int16_t* b = rhs + (q * m + j) * 2;
+        __m256i y[VECS];
+        for (size_t v = 0; v < VECS; ++v)
+            y[v] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + 16 * v));
+        for (size_t r = 0; r < ROWS; ++r) {
+            const __m256i x = _mm256_set1_epi32(lhs[(i + r) * pairs + q]);
+            for (size_t v = 0; v < VECS; ++v)
+                acc[r][v] = _mm256_add_epi32(acc[r][v], _mm256_madd_epi16(x, y[v]));
+        }
+    }
+    for (size_t r = 0; r < ROWS; ++r)
+        for (size_t v = 0; v < VECS; ++v)
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + (i + r) * m + j + 8 * v), acc[r][v]);
+}
+
+template <size_t ROWS>
+VECXIFY_SIMD_AVX2 inline void rowsAvx2(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& i, const size_t& pairs, const size_t& m) noexcept {
+    size_t j = 0;
+    for (; j + 16 <= m; j += 16)
+        blockAvx2<ROWS, 2>(lhs, rhs, out, i, j, pairs, m);
+    if (j + 8 <= m)
+        blockAvx2<ROWS, 1>(lhs, rhs, out, i, j, pairs, m);
+}
+
+// blocks of 4 rows, then single rows; the last m % 8 columns are left to the scalar loop
+__attribute__((target("avx2"))) void productAvx2(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& first, const size_t& last, const size_t& pairs, const size_t& m) noexcept {
+    size_t i = first;
+    for (; i + 4 <= last; i += 4)
+        rowsAvx2<4>(lhs, rhs, out, i, pairs, m);
+    for (; i < last; ++i)
+        rowsAvx2<1>(lhs, rhs, out, i, pairs, m);
+}
+
+#endif
+
+void productRows(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& first, const size_t& last, const size_t& pairs, const size_t& m) {
+#if VECXIFY_SIMD_DISPATCH
+    // vpmaddwd on 512 bits needs AVX-512BW, the AVX2 kernel serves every AVX-512 CPU as well
+    if (simdIsa() != SimdIsa::scalar) {
+        productAvx2(lhs, rhs, out, first, last, pairs, m);
+        productScalar(lhs, rhs, out, first, last, pairs, m, m / 8 * 8);
+        return;
+    }
+#endif
+    productScalar(lhs, rhs, out, first, last, pairs, m, 0);
+}
+
+}
+
+void quantizedProduct(const int32_t* lhs, const int16_t* rhs, int32_t* out, const size_t& n, const size_t& pairs, const size_t& m) {
+    if (n * pairs * m < PARALLEL_QUANTIZED_WORK) {
+        productRows(lhs, rhs, out, 0, n, pairs, m);
+        return;
+    }
+    ThreadPool::shared().parallelFor(0, n, QUANTIZED_ROWS, [&](const size_t& first, const size_t& last) {
+        productRows(lhs, rhs, out, first, last, pairs, m);
+    });
+}
+
+}
+
+}
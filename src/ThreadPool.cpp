@@ -0,0 +1,136 @@
+#include "ThreadPool.hpp"
+
+#include "Allocator.hpp"
+
+namespace vecxify {
+
+namespace {
+
+// pool and queue index of the current thread if it is a worker
+thread_local const ThreadPool* workerPool = nullptr;
+thread_local size_t workerIndex = 0;
+
+}
+
+ThreadPool::ThreadPool(const size_t& threads) {
+    for (size_t i = 0; i <= threads; ++i)
+        _queues.push_back(std::make_unique<Queue>());
+    for (size_t i = 0; i < threads; ++i)
+        _workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+        _stop = true;
+    }
+    _wake.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool{std::max<size_t>(std::thread::hardware_concurrency(), 1) - 1};
+    return pool;
+}
+
+size_t ThreadPool::concurrency() const noexcept {
+    return _workers.size() + 1;
+}
+
+size_t ThreadPool::localQueue() const noexcept {
+    return workerPool == this ? workerIndex : _workers.size();
+}
+
+void ThreadPool::push(Task* task) {
+    Queue& queue = *_queues[localQueue()];
+    {
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        queue.tasks.push_back(task);
+    }
+    _pending.fetch_add(1);
+    {
+        // pairs with the predicate check of sleeping workers
+        std::lock_guard<std::mutex> lock{_sleepMutex};
+    }
+    _wake.notify_one();
+}
+
+bool ThreadPool::reclaim(Task* task) {
+    Queue& queue = *_queues[localQueue()];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (queue.tasks.empty() || queue.tasks.back() != task)
+        return false;
+    queue.tasks.pop_back();
+    _pending.fetch_sub(1);
+    return true;
+}
+
+ThreadPool::Task* ThreadPool::take() {
+    size_t local = localQueue();
+    {
+        Queue& queue = *_queues[local];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            Task* task = queue.tasks.back();
+            queue.tasks.pop_back();
+            _pending.fetch_sub(1);
+            return task;
+        }
+    }
+    // steal the oldest task, it is usually the largest piece of work
+    for (size_t offset = 1; offset < _queues.size(); ++offset) {
+        Queue& queue = *_queues[(local + offset) % _queues.size()];
+        std::lock_guard<std::mutex> lock{queue.mutex};
+        if (!queue.tasks.empty()) {
+            Task* task = queue.tasks.front();
+            queue.tasks.pop_front();
+            _pending.fetch_sub(1);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::execute(Task* task) noexcept {
+    // a task may run on any thread, so it never allocates from the arena of the thread that forked it
+    PolicyScope scope{MemoryPolicy::pool()};
+    try {
+        task->run(task->data);
+    } catch (...) {
+        task->error = std::current_exception();
+    }
+    task->done.store(true, std::memory_order_release);
+}
+
+bool ThreadPool::runOne() {
+    if (_pending.load() == 0)
+        return false;
+    Task* task = take();
+    if (!task)
+        return false;
+    execute(task);
+    return true;
+}
+
+void ThreadPool::workerLoop(const size_t& index) {
+    workerPool = this;
+    workerIndex = index;
+    while (true) {
+        if (runOne())
+            continue;
+        std::unique_lock<std::mutex> lock{_sleepMutex};
+        _wake.wait(lock, [this]() { return _stop || _pending.load() > 0; });
+        if (_stop)
+            return;
+    }
+}
+
+void ThreadPool::wait(Task& task) {
+    while (!task.done.load(std::memory_order_acquire)) {
+        if (!runOne())
+            std::this_thread::yield();
+    }
+}
+
+}
@@ -1,4 +1,13 @@
 #include "UnitTest.hpp"
+#include <sstream>
+#include <filesystem>
+
+// 64-bit linear congruential generator of the randomized tests: advances state and returns it,
+// the high bits are the random ones
+static unsigned long long nextRandom(unsigned long long& state) noexcept {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return state;
+}
 
 UnitTest::UnitTest() {
     test1();
@@ -9,6 +18,31 @@ UnitTest::UnitTest() {
     test6();
     test7();
     test8();
+    test9();
+    test10();
+    test11();
+    test12();
+    test13();
+    test14();
+    test15();
+    test16();
+    test17();
+    test18();
+    test19();
+    test20();
+    test21();
+    test22();
+    test23();
+    test24();
+    test25();
+    test26();
+    test27();
+    test28();
+    test29();
+    test30();
+    test31();
+    test32();
+    test33();
 }
 
 void UnitTest::test1() {
@@ -92,3 +126,1438 @@ void UnitTest::test8() {
 //    std::cout << a << std::endl;
     
 }
+
+void UnitTest::test9() {
+    BigInt kept{};
+    {
+        ArenaScope scope{};
+        BigInt a{"123456789012345678901234567890"};
+        BigInt b{a * a};
+        assert(&b.limbs().get_allocator().policy() == &scope.arena());
+        // assignment keeps the policy of the destination, so the value outlives the arena
+        kept = b - a;
+    }
+    assert(kept == BigInt("15241578753238836750495351562412741998489559520973784484210"));
+    assert(&kept.limbs().get_allocator().policy() == &MemoryPolicy::heap());
+
+    BigInt power{};
+    {
+        PoolScope scope{};
+        BigInt p{1ll};
+        for (int i = 0; i < 200; ++i)
+            p *= BigInt(3ll);
+        power = p;
+    }
+    assert(power == BigInt("265613988875874769338781322035779626829233452653394495974574961739092490901302182994384699044001"));
+    assert(power % BigInt(-7ll) == power % BigInt(7ll));
+    assert(BigInt(-10ll) % BigInt(3ll) == BigInt(-1ll));
+}
+
+void UnitTest::test10() {
+    std::string digits{"-"};
+    for (int i = 0; i < 500; ++i)
+        digits += "9876543210";
+    digits[1] = '1';
+
+    BigInt a{digits};
+    assert(a.toString() == digits);
+
+    std::ostringstream out;
+    out << a;
+    assert(out.str() == digits);
+
+    std::string buffer(digits.length(), ' ');
+    char* end = a.toChars(buffer.data(), buffer.data() + buffer.length());
+    assert(end == buffer.data() + buffer.length() && buffer == digits);
+    assert(a.toChars(buffer.data(), buffer.data() + 10) == nullptr);
+
+    // 10^5000 - 1 and back
+    BigInt nines{std::string(5000, '9')};
+    assert((nines + BigInt(1ll)).toString() == "1" + std::string(5000, '0'));
+    assert((a * a).toString().length() == 2 * (digits.length() - 1) - 1);
+}
+
+void UnitTest::test11() {
+    assert(pow(BigInt(2ll), 100) == BigInt("1267650600228229401496703205376"));
+    assert(pow(BigInt(-3ll), 3) == BigInt(-27ll));
+
+    assert(modpow(BigInt(4ll), BigInt(13ll), BigInt(497ll)) == BigInt(445ll));
+    assert(modpow(BigInt(-4ll), BigInt(13ll), BigInt(497ll)) == BigInt(52ll));
+    assert(modpow(BigInt(3ll), BigInt(1000ll), BigInt(1024ll)) == BigInt(801ll));
+    // Fermat's little theorem with the Mersenne prime 2^127 - 1
+    BigInt p = pow(BigInt(2ll), 127) - BigInt(1ll);
+    assert(modpow(BigInt("123456789012345678901234567890"), p - BigInt(1ll), p) == BigInt(1ll));
+
+    BigInt a = pow(BigInt(6ll), 60), b = pow(BigInt(10ll), 40);
+    assert(gcd(a, b) == pow(BigInt(2ll), 40));
+    assert(gcd(-a, BigInt{}) == a);
+    auto [g, x, y] = extendedGcd(a, -b);
+    assert(g == gcd(a, b) && a * x - b * y == g);
+
+    assert(isqrt(pow(BigInt(10ll), 40)) == pow(BigInt(10ll), 20));
+    assert(isqrt(pow(BigInt(10ll), 40) - BigInt(1ll)) == pow(BigInt(10ll), 20) - BigInt(1ll));
+
+    assert((BigInt(1ll) << 100) == pow(BigInt(2ll), 100));
+    assert((pow(BigInt(2ll), 100) >> 98) == BigInt(4ll));
+    assert((BigInt(-5ll) >> 1) == BigInt(-3ll));
+    assert(BigInt(-7ll) / BigInt(2ll) == BigInt(-3ll));
+}
+
+void UnitTest::test12() {
+    // (2^(32n) - 1)^2 = 2^(64n) - 2^(32n + 1) + 1 has the largest possible convolution coefficients
+    for (size_t n : {100, 5000, 40000}) {
+        BigInt x = (BigInt(1ll) << (32 * n)) - BigInt(1ll);
+        assert(x * x == (BigInt(1ll) << (64 * n)) - (BigInt(1ll) << (32 * n + 1)) + BigInt(1ll));
+    }
+
+    // balanced and unbalanced products above the transform threshold, also under an arena
+    BigInt a = pow(BigInt(3ll), 200000), b = pow(BigInt(7ll), 30000) + BigInt(1ll);
+    BigInt c = a * b;
+    assert(c / b == a && c % a == BigInt{});
+    assert(pow(BigInt(3ll), 400000) == a * a);
+    {
+        ArenaScope arena{};
+        assert((a * b) / a == b);
+    }
+}
+
+void UnitTest::test13() {
+    BigInt naive(1ll);
+    for (long long i = 1; i <= 300; ++i) {
+        naive *= BigInt(i);
+        assert(factorial(i) == naive);
+    }
+    assert(factorial(0) == BigInt(1ll));
+
+    // Pascal's rule
+    for (unsigned long long n = 1; n <= 60; ++n) {
+        for (unsigned long long k = 1; k <= n; ++k)
+            assert(binomial(n, k) == binomial(n - 1, k - 1) + binomial(n - 1, k));
+    }
+    assert(binomial(1000, 500) * factorial(500) * factorial(500) == factorial(1000));
+    assert(binomial(5, 6) == BigInt{});
+
+    assert(primorial(30) == BigInt(6469693230ll));
+    assert(primorial(1) == BigInt(1ll));
+
+    std::vector<long long> values{};
+    for (long long i = 1; i <= 1000; ++i)
+        values.push_back(i);
+    assert(product<BigInt>(values) == factorial(1000));
+    assert(product(values.begin(), values.begin() + 20) == 2432902008176640000ll);
+    std::vector<ModNum<long long, 1000000007>> terms(values.begin(), values.begin() + 50);
+    assert(product(terms) == (ModNum<long long, 1000000007>(318608048)));
+}
+
+void UnitTest::test14() {
+    using M7 = ModNum<int, 7>;
+    assert(M7(-1).get() == 6 && M7(-14).get() == 0 && (M7(3) - M7(5)).get() == 5);
+    assert((-M7(0)).get() == 0 && !M7(0) && M7(8));
+
+    // products of 61-bit residues would overflow long long before the reduction
+    using P = ModNum<long long, 2305843009213693951ll>;
+    assert((P(1ll << 60) * P(4)).get() == 2);
+    assert((P(123456789123456789ll) * P(987654321987654321ll)).get() == 587437849037674763ll);
+    P x(1);
+    for (int i = 0; i < 100; ++i)
+        x *= P(3);
+    assert(x.get() == 1175369268131054105ll);
+
+    // even modulus, Barrett reduction
+    using E = ModNum<long long, 1000000000000000000ll>;
+    assert((E(100000000000000003ll) * E(-11)).get() == 899999999999999967ll);
+    assert((E(999999999999999999ll) + E(2)).get() == 1 && (E(1) - E(2)).get() == 999999999999999999ll);
+    E y(5);
+    assert((y++).get() == 5 && y.get() == 6 && (--y).get() == 5 && y > E(4) && y < E(6));
+}
+
+void UnitTest::test15() {
+    Modulus p{1000000007}, e{1ull << 40};
+    DynModNum a(p, -1), b(p, 500000004);
+    assert(a.get() == 1000000006 && (b * DynModNum(p, 2)).get() == 1);
+    assert((a + b).get() == 500000003 && (-a).get() == 1 && (b - a).get() == 500000005);
+    assert((DynModNum(e, 1ll << 39) * DynModNum(e, 6)).get() == 0);
+    assert((DynModNum(e, -3) * DynModNum(e, 5)).get() == (1ll << 40) - 15);
+
+    // unbound constants take the modulus of the other operand
+    assert(a + 1 == DynModNum(p, 0) && !(a + 1) && a * 2 == DynModNum(p, -2));
+    {
+        ModulusScope scope{e};
+        DynModNum x = -1;
+        assert(x.modulus() == &e && x.get() == (1ll << 40) - 1);
+    }
+    assert(DynModNum(5).modulus() == nullptr);
+
+    // unbound arithmetic is exact and refuses to overflow instead of wrapping
+    assert((DynModNum(-3) * DynModNum(5)).get() == -15 && (-DynModNum(-7)).get() == 7);
+    bool overflowed = false;
+    try {
+        DynModNum(1ll << 40) * DynModNum(1ll << 40);
+    } catch (const std::overflow_error&) {
+        overflowed = true;
+    }
+    assert(overflowed);
+
+    // values of different moduli do not combine
+    bool mixed = false;
+    try {
+        DynModNum(p, 1) + DynModNum(e, 1);
+    } catch (const std::invalid_argument&) {
+        mixed = true;
+    }
+    assert(mixed);
+
+    // same results as the compile-time modulus, also as a Mat and Vec element
+    Mat<DynModNum, 2, 2> m{{DynModNum(p, 3), DynModNum(p, -7)}, {DynModNum(p, 123456789), DynModNum(p, 2)}};
+    Mat<ModNum<long long, 1000000007>, 2, 2> s{{3, -7}, {123456789, 2}};
+    auto m3 = m * m * m;
+    auto s3 = s * s * s;
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 2; ++j)
+            assert(m3(i, j).get() == s3(i, j).get());
+    Vec<DynModNum, 3> v{DynModNum(p, 1000000), DynModNum(p, 2000000), DynModNum(p, -3)};
+    assert((v * v).get() == 999965016);
+}
+
+void UnitTest::test16() {
+    using F = ModNum<long long, 998244353>;
+    assert(F(5).inv() == F(598946612) && F(5) * F(5).inv() == F(1));
+    assert(F(3).pow(1000000000000000000ull) == F(865857325) && F(7).pow(0) == F(1));
+    assert(F(10) / F(4) * F(4) == F(10));
+    bool thrown = false;
+    try {
+        F(0).inv();
+    } catch (const std::domain_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // even modulus: inverse exists for odd values only
+    using E = ModNum<int, 1 << 20>;
+    assert((E(12345) * E(12345).inv()).get() == 1);
+
+    std::vector<F> values{};
+    for (long long i = 1; i <= 1000; ++i)
+        values.push_back(F(i * i + 1));
+    std::vector<F> inverses = values;
+    batchInverse(inverses.begin(), inverses.end());
+    for (size_t i = 0; i < values.size(); ++i)
+        assert(values[i] * inverses[i] == F(1));
+
+    Modulus p{998244353};
+    DynModNum d(p, 5);
+    assert(d.inv().get() == 598946612 && (DynModNum(p, 10) / 4 * 4).get() == 10 && d.pow(3).get() == 125);
+
+    // elimination over a prime field, with a row swap
+    Mat<F, 4, 4> m{{3, 1, 4, 1}, {5, 9, 2, 6}, {5, 3, 5, 8}, {9, 7, 9, 3}};
+    assert(m.determinant() == F(98));
+    Mat<F, 3, 3> swapped{{0, 1, 2}, {1, 0, 3}, {4, 5, 0}};
+    assert(determinant(swapped) == F(22));
+    Mat<DynModNum, 3, 3> dynamic{{DynModNum(p, 0), DynModNum(p, 1), DynModNum(p, 2)}, {DynModNum(p, 1), DynModNum(p, 0), DynModNum(p, 3)}, {DynModNum(p, 4), DynModNum(p, 5), DynModNum(p, 0)}};
+    assert(dynamic.determinant().get() == 22);
+}
+
+template <typename M, size_t R, size_t K, size_t C>
+static void checkModularProduct() {
+    Mat<M, R, K> a;
+    Mat<M, K, C> b;
+    unsigned long long seed = 12345;
+    auto next = [&]() {
+        return static_cast<long long>(nextRandom(seed) >> 2);
+    };
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < K; ++j)
+            a(i, j) = M(next());
+    for (size_t i = 0; i < K; ++i)
+        for (size_t j = 0; j < C; ++j)
+            b(i, j) = M(next());
+
+    auto c = a * b;
+    for (size_t i = 0; i < R; ++i) {
+        for (size_t j = 0; j < C; ++j) {
+            M expected{};
+            for (size_t p = 0; p < K; ++p)
+                expected += a(i, p) * b(p, j);
+            assert(c(i, j) == expected);
+        }
+    }
+}
+
+void UnitTest::test17() {
+    // lazy-reduction kernel against scalar dot products, narrow and wide moduli, odd and even
+    checkModularProduct<ModNum<long long, 998244353>, 7, 45, 9>();
+    checkModularProduct<ModNum<int, 65536>, 5, 40, 6>();
+    checkModularProduct<ModNum<long long, 4294967296ll>, 3, 20, 4>();
+    checkModularProduct<ModNum<long long, 2305843009213693951ll>, 6, 33, 5>();
+    checkModularProduct<ModNum<long long, 1000000000000000000ll>, 4, 17, 4>();
+    checkModularProduct<ModNum<long long, 1>, 2, 3, 2>();
+
+    // Fibonacci numbers by matrix power
+    using F = ModNum<long long, 1000000007>;
+    Mat<F, 2, 2> fib{{1, 1}, {1, 0}};
+    Mat<F, 2, 2> res{};
+    res.identity();
+    for (int i = 0; i < 90; ++i)
+        res *= fib;
+    assert(res(0, 1) == F(2880067194370816120ll % 1000000007));
+}
+
+template <typename M>
+static void checkBulk(const size_t& n) {
+    unsigned long long seed = 777 + n;
+    auto next = [&]() {
+        return static_cast<long long>(nextRandom(seed) >> 2);
+    };
+    std::vector<M> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; ++i)
+        a[i] = M(next()), b[i] = M(next());
+    const M factor(next()), x(next());
+
+    bulk::add(a, b, out);
+    for (size_t i = 0; i < n; ++i)
+        assert(out[i] == a[i] + b[i]);
+    bulk::sub(a, b, out);
+    for (size_t i = 0; i < n; ++i)
+        assert(out[i] == a[i] - b[i]);
+    bulk::mul(a, b, out);
+    for (size_t i = 0; i < n; ++i)
+        assert(out[i] == a[i] * b[i]);
+    bulk::scale(a, factor, out);
+    for (size_t i = 0; i < n; ++i)
+        assert(out[i] == a[i] * factor);
+
+    M dot{}, prefix(1), value{}, power(1);
+    bulk::prefixProduct(a, out);
+    for (size_t i = 0; i < n; ++i) {
+        dot += a[i] * b[i];
+        prefix *= a[i];
+        assert(out[i] == prefix);
+        value += a[i] * power;
+        power *= x;
+    }
+    assert(bulk::dot(a, b) == dot);
+    assert(bulk::evaluate(a, x) == value);
+
+    // in place
+    std::vector<M> c = a;
+    bulk::mul(c, b, c);
+    for (size_t i = 0; i < n; ++i)
+        assert(c[i] == a[i] * b[i]);
+}
+
+void UnitTest::test18() {
+    // bulk kernels against the scalar operators, lengths that do not fill the vector lanes,
+    // once for every instruction set this CPU can run
+    for (auto isa : {detail::SimdIsa::scalar, detail::SimdIsa::avx2, detail::SimdIsa::avx512}) {
+        if (isa > detail::detectedSimdIsa())
+            continue;
+        detail::SimdIsaScope scope(isa);
+        assert(detail::simdIsa() == isa);
+        for (size_t n : {0, 1, 7, 8, 65, 1000, 5000}) {
+            checkBulk<ModNum<long long, 998244353>>(n);
+            checkBulk<ModNum<int, 1000000007>>(n);
+            checkBulk<ModNum<unsigned, 4294967291u>>(n);
+            checkBulk<ModNum<int, 65536>>(n);
+            checkBulk<ModNum<long long, 2305843009213693951ll>>(n);
+            checkBulk<ModNum<long long, 1>>(n);
+        }
+    }
+    assert(detail::simdIsa() == detail::detectedSimdIsa());
+    std::vector<ModNum<int, 7>> x{1, 2, 3};
+    std::array<ModNum<int, 7>, 2> y{};
+    bool thrown = false;
+    try {
+        bulk::add(x, x, y);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void UnitTest::test19() {
+    using F = ModNum<long long, 998244353>;
+    using P = Poly<F>;
+    unsigned long long seed = 4242;
+    auto random = [&](const size_t& n) {
+        std::vector<F> c(n);
+        for (F& x : c) {
+            x = F(static_cast<long long>(nextRandom(seed) >> 2));
+        }
+        return c;
+    };
+    auto naive = [](const P& a, const P& b) {
+        std::vector<F> res(a.size() && b.size() ? a.size() + b.size() - 1 : 0);
+        for (size_t i = 0; i < a.size(); ++i)
+            for (size_t j = 0; j < b.size(); ++j)
+                res[i + j] += a[i] * b[j];
+        return P(res);
+    };
+
+    // every multiplication algorithm, balanced and unbalanced
+    for (auto [n, m] : std::vector<std::pair<size_t, size_t>>{{0, 5}, {1, 1}, {20, 30}, {50, 200}, {300, 300}, {1000, 70}, {700, 900}}) {
+        P a(random(n)), b(random(m));
+        assert(a * b == naive(a, b));
+    }
+    P sq(random(500));
+    assert(sq * sq == naive(sq, sq));
+
+    // series inverse, division, log and exp
+    P f(random(400));
+    P inverse = f.inverse(400);
+    assert((f * inverse).truncated(400) == P{F(1)});
+    P g(random(150));
+    for (const P& d : {g, P(random(5)), P(random(390))}) {
+        auto [q, r] = f.divmod(d);
+        assert(r.degree() < d.degree());
+        assert(q * d + r == f);
+    }
+    std::vector<F> c = random(300);
+    c[0] = F(0);
+    P h(c);
+    assert(h.exp(300).log(300) == h);
+    c[0] = F(1);
+    P k(c);
+    assert(k.log(300).exp(300) == k);
+    assert((P{F(1), F(1)} * P{F(1), F(1)}).integral().derivative() == P({F(1), F(2), F(1)}));
+
+    // multipoint evaluation against Horner
+    std::vector<F> points = random(1000);
+    std::vector<F> values = f.evaluate(points);
+    for (size_t i = 0; i < points.size(); ++i) {
+        F value{};
+        for (size_t j = f.size(); j-- > 0; )
+            value = value * points[i] + f[j];
+        assert(values[i] == value);
+    }
+
+    bool thrown = false;
+    try {
+        f / P{};
+    } catch (const std::domain_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::ostringstream out;
+    out << P{F(3), F(0), F(-1)};
+    assert(out.str() == "[3, 0, 998244352]");
+}
+
+void UnitTest::test20() {
+    // multi-modular products against the classical sum of products, signed entries of growing size
+    unsigned long long seed = 99;
+    auto random = [&](const size_t& limbs) {
+        BigInt res{};
+        for (size_t i = 0; i < limbs; ++i) {
+            res = (res << 32) + BigInt(static_cast<long long>(nextRandom(seed) >> 32));
+        }
+        return seed & 1 ? -res : res;
+    };
+    for (size_t limbs : {1, 5, 20}) {
+        Mat<BigInt, 9, 24> a;
+        Mat<BigInt, 24, 7> b;
+        for (size_t i = 0; i < 9; ++i)
+            for (size_t j = 0; j < 24; ++j)
+                a(i, j) = random(limbs);
+        for (size_t i = 0; i < 24; ++i)
+            for (size_t j = 0; j < 7; ++j)
+                b(i, j) = random(limbs + i % 3);
+        auto c = a * b;
+        for (size_t i = 0; i < 9; ++i) {
+            for (size_t j = 0; j < 7; ++j) {
+                BigInt sum{};
+                for (size_t p = 0; p < 24; ++p)
+                    sum += a(i, p) * b(p, j);
+                assert(c(i, j) == sum);
+            }
+        }
+    }
+
+    // entries too large for the primes fall back to the classical product
+    Mat<BigInt, 16, 16> big;
+    for (size_t i = 0; i < 16; ++i)
+        for (size_t j = 0; j < 16; ++j)
+            big(i, j) = i == j ? random(30) : BigInt{};
+    auto square = big * big;
+    for (size_t i = 0; i < 16; ++i)
+        assert(square(i, i) == big(i, i) * big(i, i) && square(i, (i + 1) % 16) == BigInt{});
+
+    // both paths with the caller under an arena and under a pool: the entries are assigned on the
+    // calling thread, a pool task never allocates from the policy of the thread that forked it
+    Mat<BigInt, 9, 24> a;
+    Mat<BigInt, 24, 7> b;
+    for (size_t i = 0; i < 9; ++i)
+        for (size_t j = 0; j < 24; ++j)
+            a(i, j) = random(4);
+    for (size_t i = 0; i < 24; ++i)
+        for (size_t j = 0; j < 7; ++j)
+            b(i, j) = random(4);
+    const auto product = a * b;
+    {
+        ArenaScope scope{};
+        assert(a * b == product && big * big == square);
+    }
+    {
+        PoolScope scope{};
+        assert(a * b == product && big * big == square);
+    }
+}
+
+void UnitTest::test21() {
+    // min-plus powers of a random weighted graph are its shortest paths (Floyd-Warshall)
+    constexpr size_t n = 45;
+    constexpr int inf = MinPlus<int>::zero();
+    unsigned long long seed = 7;
+    auto random = [&]() {
+        return static_cast<int>(nextRandom(seed) >> 33);
+    };
+    Mat<int, n, n> w;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            w(i, j) = i == j ? 0 : random() % 4 == 0 ? 1 + random() % 100 : inf;
+    Mat<int, n, n> dist = w;
+    for (size_t p = 0; p < n; ++p)
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+                if (dist(i, p) != inf && dist(p, j) != inf)
+                    dist(i, j) = std::min(dist(i, j), dist(i, p) + dist(p, j));
+    Mat<int, n, n> paths = power(w, n - 1, MinPlus<int>{});
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            assert(paths(i, j) == dist(i, j));
+    power(w, 0, paths, MinPlus<int>{});
+    assert(paths(3, 3) == 0 && paths(3, 4) == inf);
+
+    // every semiring against the definition, out aliasing an operand
+    auto check = [&]<typename S, typename T, size_t N, size_t K, size_t M>(const S&, Mat<T, N, K>& a, Mat<T, K, M>& b) {
+        for (size_t i = 0; i < N; ++i)
+            for (size_t j = 0; j < K; ++j)
+                a(i, j) = random() % 5 == 0 ? T(S::zero()) : static_cast<T>(random() % 50);
+        for (size_t i = 0; i < K; ++i)
+            for (size_t j = 0; j < M; ++j)
+                b(i, j) = random() % 5 == 0 ? T(S::zero()) : static_cast<T>(random() % 50);
+        Mat<T, N, M> c = multiply(a, b, S{});
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < M; ++j) {
+                T sum = S::zero();
+                for (size_t p = 0; p < K; ++p)
+                    sum = S::add(sum, S::mul(a(i, p), b(p, j)));
+                assert(c(i, j) == sum);
+            }
+        }
+        if constexpr (K == M) {
+            multiply(a, b, a, S{});
+            for (size_t i = 0; i < N; ++i)
+                for (size_t j = 0; j < M; ++j)
+                    assert(a(i, j) == c(i, j));
+        }
+    };
+    Mat<long long, 13, 70> a1;
+    Mat<long long, 70, 70> b1;
+    check(MinPlus<long long>{}, a1, b1);
+    Mat<short, 37, 19> a2;
+    Mat<short, 19, 70> b2;
+    check(MaxPlus<short>{}, a2, b2);
+    Mat<double, 9, 33> a3;
+    Mat<double, 33, 33> b3;
+    check(MaxPlus<double>{}, a3, b3);
+    Mat<unsigned, 21, 40> a4;
+    Mat<unsigned, 40, 67> b4;
+    check(MaxMin<unsigned>{}, a4, b4);
+    Mat<bool, 70, 70> a5, b5;
+    check(Boolean{}, a5, b5);
+    Mat<long long, 6, 6> a6, b6;
+    check(PlusTimes<long long>{}, a6, b6);
+
+    // the ordinary product of heap matrices whose padded Strassen temporaries would overflow the stack
+    constexpr size_t big = 600;
+    auto x = std::make_unique<Mat<double, big, big>>();
+    auto y = std::make_unique<Mat<double, big, big>>();
+    auto z = std::make_unique<Mat<double, big, big>>();
+    for (size_t i = 0; i < big; ++i)
+        for (size_t j = 0; j < big; ++j)
+            (*x)(i, j) = static_cast<double>(random() % 7) - 3.0, (*y)(i, j) = i == j ? 1.0 : 0.0;
+    multiply(*x, *x, *z);
+    for (size_t i = 0; i < big; i += 97) {
+        for (size_t j = 0; j < big; j += 89) {
+            double sum = 0;
+            for (size_t p = 0; p < big; ++p)
+                sum += (*x)(i, p) * (*x)(p, j);
+            assert((*z)(i, j) == sum);
+        }
+    }
+    (*y)(0, 1) = 2.0;
+    power(*y, 3, *z);
+    assert((*z)(0, 1) == 6.0 && (*z)(1, 1) == 1.0 && (*z)(1, 0) == 0.0);
+    const double x50 = (*x)(5, 0), x51 = (*x)(5, 1), x52 = (*x)(5, 2);
+    multiply(*x, *y, *x);
+    assert((*x)(5, 0) == x50 && (*x)(5, 1) == x51 + 2.0 * x50 && (*x)(5, 2) == x52);
+}
+
+void UnitTest::test22() {
+    unsigned long long seed = 11;
+    auto random = [&]() {
+        return nextRandom(seed) >> 33;
+    };
+    auto randomMatrix = [&](const size_t& rows, const size_t& cols, const unsigned long long& density) {
+        BitMatrix res{rows, cols};
+        for (size_t i = 0; i < rows; ++i)
+            for (size_t j = 0; j < cols; ++j)
+                res.set(i, j, random() % density == 0);
+        return res;
+    };
+
+    // Four Russians products against the definition, sizes not multiple of the words or tables
+    BitMatrix a = randomMatrix(70, 2100, 2), b = randomMatrix(2100, 2177, 2);
+    BitMatrix c = a * b;
+    for (size_t i = 0; i < 70; i += 3) {
+        for (size_t j = 0; j < 2177; j += 7) {
+            bool sum = false;
+            for (size_t p = 0; p < 2100; ++p)
+                sum ^= a(i, p) && b(p, j);
+            assert(c(i, j) == sum);
+        }
+    }
+    BitMatrix sparse = randomMatrix(100, 100, 40);
+    BitMatrix reach = booleanMultiply(sparse, sparse);
+    for (size_t i = 0; i < 100; ++i) {
+        for (size_t j = 0; j < 100; ++j) {
+            bool any = false;
+            for (size_t p = 0; p < 100; ++p)
+                any = any || (sparse(i, p) && sparse(p, j));
+            assert(reach(i, j) == any);
+        }
+    }
+    assert(sparse * BitMatrix::identity(100) == sparse && (sparse + sparse).count() == 0);
+
+    // transpose of a matrix spanning several 64 x 64 blocks
+    BitMatrix t = c.transpose();
+    assert(t.rows() == 2177 && t.cols() == 70);
+    for (size_t i = 0; i < 70; ++i)
+        for (size_t j = 0; j < 2177; ++j)
+            assert(t(j, i) == c(i, j));
+    assert(t.transpose() == c);
+
+    // rank of a product of a 150 x 37 and a 37 x 130 matrix, reduced row echelon form
+    BitMatrix lowRank = randomMatrix(150, 37, 2) * randomMatrix(37, 130, 2);
+    BitMatrix reduced = lowRank;
+    const size_t rank = reduced.eliminate();
+    assert(rank <= 37 && rank + 3 >= 37 && lowRank.rank() == rank);
+    size_t previous = 0;
+    for (size_t i = 0; i < 150; ++i) {
+        size_t lead = 0;
+        while (lead < 130 && !reduced(i, lead))
+            ++lead;
+        assert((i < rank) == (lead < 130));
+        if (i >= rank)
+            continue;
+        assert(i == 0 || lead > previous);
+        for (size_t r = 0; r < 150; ++r)
+            assert(reduced(r, lead) == (r == i));
+        previous = lead;
+    }
+    // the reduced rows span the original ones: appending them does not raise the rank
+    BitMatrix stacked{150 + rank, 130};
+    for (size_t i = 0; i < 150 + rank; ++i)
+        for (size_t j = 0; j < 130; ++j)
+            stacked.set(i, j, i < 150 ? lowRank(i, j) : reduced(i - 150, j));
+    assert(stacked.rank() == rank && BitMatrix::identity(200).rank() == 200);
+
+    Mat<int, 2, 3> m { {1, 0, 2}, {0, 0, 1} };
+    BitMatrix fromMat{m};
+    assert(fromMat.count() == 3 && fromMat(0, 2) && !fromMat(1, 0));
+    std::ostringstream out;
+    out << fromMat;
+    assert(out.str() == "[1, 0, 1]\n[0, 0, 1]");
+}
+
+void UnitTest::test23() {
+    unsigned long long seed = 5;
+    auto random = [&]() {
+        return static_cast<long long>(nextRandom(seed) >> 40) % 19 - 9;
+    };
+    auto close = [](const double& lhs, const double& rhs) {
+        return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+    };
+
+    // packed symmetric: product with a vector and rank-k updates against the full matrix
+    constexpr size_t n = 17;
+    static_assert(sizeof(SymMat<long long, n>) == sizeof(long long) * n * (n + 1) / 2);
+    SymMat<long long, n> s;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j <= i; ++j)
+            s(i, j) = random();
+    Mat<long long, n, 4> a;
+    Vec<long long, n> x;
+    for (size_t i = 0; i < n; ++i) {
+        x(i) = random();
+        for (size_t j = 0; j < 4; ++j)
+            a(i, j) = random();
+    }
+    Mat<long long, n, n> full = s.toMat();
+    assert(full == transpose(full));
+    Vec<long long, n> y = s * x;
+    for (size_t i = 0; i < n; ++i) {
+        long long sum = 0;
+        for (size_t j = 0; j < n; ++j)
+            sum += full(i, j) * x(j);
+        assert(y(i) == sum);
+    }
+    s.rankUpdate(3, a).rankUpdate(-2, x);
+    auto updated = full + 3ll * (a * transpose(a));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            assert(s(i, j) == updated(i, j) - 2 * x(i) * x(j));
+
+    // Cholesky of a positive definite matrix, triangular solves with one and several right-hand sides
+    SymMat<double, n> spd;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j <= i; ++j)
+            spd(i, j) = i == j ? 4.0 * n : 1.0 / (1.0 + i + j);
+    TriMat<double, n, Triangle::lower> l = spd.cholesky();
+    auto product = l.toMat() * l.transpose().toMat();
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            assert(close(product(i, j), spd(i, j)));
+    Vec<double, n> b;
+    for (size_t i = 0; i < n; ++i)
+        b(i) = static_cast<double>(random());
+    Vec<double, n> solution = spd.solve(b), check = spd * solution;
+    for (size_t i = 0; i < n; ++i)
+        assert(close(check(i), b(i)));
+    Mat<double, n, 3> rhs;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            rhs(i, j) = static_cast<double>(random());
+    auto upperSolution = l.transpose().solve(rhs);
+    auto upperCheck = l.transpose().toMat() * upperSolution;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            assert(close(upperCheck(i, j), rhs(i, j)));
+
+    // banded LU with pivoting over a prime field, exact against the dense determinant
+    using F = ModNum<long long, 998244353>;
+    constexpr size_t m = 30;
+    BandMat<F, m, 3, 2> band;
+    Vec<F, m> v;
+    for (size_t i = 0; i < m; ++i) {
+        v(i) = F(random());
+        for (size_t j = 0; j < m; ++j)
+            if (band.contains(i, j))
+                band(i, j) = F(random());
+    }
+    band(0, 0) = F{};
+    Mat<F, m, m> dense = band.toMat();
+    assert(band.determinant() == dense.determinant());
+    Vec<F, m> w = band.solve(v), bv = band * w;
+    for (size_t i = 0; i < m; ++i) {
+        F sum{};
+        for (size_t j = 0; j < m; ++j)
+            sum += dense(i, j) * w(j);
+        assert(bv(i) == v(i) && sum == v(i));
+    }
+
+    // banded Cholesky of a diagonally dominant matrix
+    SymBandMat<double, m, 2> tridiagonal;
+    for (size_t i = 0; i < m; ++i) {
+        tridiagonal(i, i) = 6.0 + i % 3;
+        if (i + 1 < m)
+            tridiagonal(i + 1, i) = -1.0;
+        if (i + 2 < m)
+            tridiagonal(i + 2, i) = 0.5;
+    }
+    Vec<double, m> c;
+    for (size_t i = 0; i < m; ++i)
+        c(i) = static_cast<double>(random());
+    Vec<double, m> z = tridiagonal.solve(c), cz = tridiagonal * z;
+    for (size_t i = 0; i < m; ++i)
+        assert(close(cz(i), c(i)));
+    assert(close(tridiagonal.cholesky().determinant(), tridiagonal.toMat().determinant()));
+
+    bool thrown = false;
+    try {
+        BandMat<double, 4, 1, 1>{}.solve(Vec<double, 4>{});
+    } catch (const std::domain_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void UnitTest::test24() {
+    unsigned long long seed = 3;
+    auto random = [&]() {
+        return static_cast<double>(nextRandom(seed) >> 11) / static_cast<double>(1ull << 53) - 0.5;
+    };
+    auto close = [](const double& lhs, const double& rhs) {
+        return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+    };
+
+    // Cholesky of B B^T + n I, more than one block of columns
+    constexpr size_t n = 70;
+    auto b = std::make_unique<Mat<double, n, n>>();
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            (*b)(i, j) = random();
+    auto spd = std::make_unique<Mat<double, n, n>>();
+    auto square = *b * transpose(*b);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            (*spd)(i, j) = square(i, j) + (i == j ? double(n) : 0.0);
+    auto cholesky = std::make_unique<Cholesky<double, n>>(*spd);
+    const Mat<double, n, n>& l = cholesky->factor();
+    auto product = l * transpose(l);
+    for (size_t i = 0; i < n; ++i) {
+        assert(l(i, i) > 0 && (i + 1 == n || l(i, i + 1) == 0.0));
+        for (size_t j = 0; j < n; ++j)
+            assert(close(product(i, j), (*spd)(i, j)));
+    }
+    Vec<double, n> rhs;
+    for (size_t i = 0; i < n; ++i)
+        rhs(i) = random();
+    Vec<double, n> x = cholesky->solve(rhs);
+    for (size_t i = 0; i < n; ++i) {
+        double sum = 0;
+        for (size_t j = 0; j < n; ++j)
+            sum += (*spd)(i, j) * x(j);
+        assert(close(sum, rhs(i)));
+    }
+    Mat<double, 3, 3> small { {4, 2, -2}, {2, 10, 2}, {-2, 2, 5} };
+    assert(close(Cholesky<double, 3>(small).determinant(), small.determinant()));
+    bool thrown = false;
+    try {
+        Cholesky<double, 2>(Mat<double, 2, 2>{ {1, 2}, {2, 1} });
+    } catch (const std::domain_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // QR of a tall matrix: orthonormal Q, Q R = A, least squares residual orthogonal to the columns
+    constexpr size_t rows = 120, cols = 60;
+    auto a = std::make_unique<Mat<double, rows, cols>>();
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            (*a)(i, j) = random();
+    auto qr = std::make_unique<QR<double, rows, cols>>(*a);
+    auto q = std::make_unique<Mat<double, rows, cols>>(qr->q());
+    auto r = qr->r();
+    auto qtq = transpose(*q) * *q;
+    auto qrProduct = *q * r;
+    for (size_t i = 0; i < cols; ++i) {
+        for (size_t j = 0; j < cols; ++j)
+            assert(close(qtq(i, j), i == j ? 1.0 : 0.0) && (j >= i || r(i, j) == 0.0));
+    }
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j)
+            assert(close(qrProduct(i, j), (*a)(i, j)));
+    Vec<double, rows> observations;
+    for (size_t i = 0; i < rows; ++i)
+        observations(i) = random();
+    Vec<double, cols> fit = qr->solve(observations);
+    std::array<double, rows> residual{};
+    for (size_t i = 0; i < rows; ++i) {
+        residual[i] = -observations(i);
+        for (size_t j = 0; j < cols; ++j)
+            residual[i] += (*a)(i, j) * fit(j);
+    }
+    for (size_t j = 0; j < cols; ++j) {
+        double dot = 0;
+        for (size_t i = 0; i < rows; ++i)
+            dot += (*a)(i, j) * residual[i];
+        assert(std::abs(dot) < 1e-9);
+    }
+}
+
+void UnitTest::test25() {
+    using M = ModNum<long long, 1000000007>;
+    using E = ModNum<int, 1 << 16>;
+
+    // Fibonacci numbers by repeated squaring, folded by the compiler
+    constexpr auto fibonacci = [](unsigned long long exp) {
+        Mat<M, 2, 2> res{};
+        res.identity();
+        Mat<M, 2, 2> base{{1, 1}, {1, 0}};
+        for ( ; exp; exp >>= 1) {
+            if (exp & 1)
+                res *= base;
+            base *= base;
+        }
+        return res(0, 1);
+    };
+    static_assert(fibonacci(10) == M{55});
+    static_assert(fibonacci(90) == M{2880067194370816120ll % 1000000007});
+
+    // residue arithmetic, Montgomery and Barrett engines
+    static_assert(M{2}.pow(1000000006) == M{1});
+    static_assert(M{3}.inv() * M{3} == M{1} && (M{1} / M{2}).get() == 500000004);
+    static_assert((E{-1} * E{-1}).get() == 1 && E{3}.pow(16).get() == 43046721 % 65536);
+
+    // table of inverses computed at compile time
+    constexpr auto inverses = []() {
+        std::array<M, 16> res{};
+        for (long long i = 1; i < 16; ++i)
+            res[i] = M{i}.inv();
+        return res;
+    }();
+    static_assert(inverses[7] * M{7} == M{1});
+
+    // matrix operations over integers and prime fields
+    constexpr Mat<long long, 3, 3> a{{2, 0, 1}, {1, 3, 2}, {1, 1, 1}};
+    constexpr Mat<double, 3, 3> f{{4, 2, 0}, {2, 5, 3}, {0, 3, 6}};
+    static_assert(determinant(f) == 60.0);
+    constexpr Mat<M, 3, 3> b{{2, 0, 1}, {1, 3, 2}, {1, 1, 4}};
+    static_assert(determinant(b) == M{18});
+    constexpr auto c = a * transpose(a) - a + 2ll * identity(a);
+    static_assert(c(0, 0) == 5 && c(1, 2) == 4 && c(2, 1) == 5);
+    constexpr Vec<long long, 3> u{1, 2, 3}, v{4, 5, 6};
+    static_assert(u * v == 32);
+
+    // same values when evaluated at runtime through the matrix kernel
+    Mat<M, 2, 2> base{{1, 1}, {1, 0}};
+    assert(power(base, 90)(0, 1) == fibonacci(90));
+    Mat<M, 3, 3> d{{2, 0, 1}, {1, 3, 2}, {1, 1, 4}};
+    assert(d.determinant() == determinant(b));
+}
+
+void UnitTest::test26() {
+    using M = ModNum<long long, 998244353>;
+    auto close = [](const double& lhs, const double& rhs) {
+        return std::abs(lhs - rhs) <= 1e-12 * std::max(1.0, std::abs(rhs));
+    };
+
+    // unrolled products against the definition, rectangular shapes included
+    Mat<double, 3, 4> a{{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+    Mat<double, 4, 2> b{{1, -1}, {2, 0}, {0, 3}, {-2, 1}};
+    auto ab = a * b;
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 2; ++j) {
+            double sum = 0;
+            for (size_t p = 0; p < 4; ++p)
+                sum += a(i, p) * b(p, j);
+            assert(ab(i, j) == sum);
+        }
+    }
+
+    // closed-form determinants agree with elimination over a prime field
+    Mat<M, 4, 4> m{{3, 1, 4, 1}, {5, 9, 2, 6}, {5, 3, 5, 8}, {9, 7, 9, 3}};
+    assert(m.determinant() == M{98});
+    Mat<M, 3, 3> m3{{2, 7, 1}, {8, 2, 8}, {1, 8, 2}};
+    assert(m3.determinant() == M{-114});
+    assert((Mat<M, 2, 2>{{4, 7}, {2, 6}}.determinant() == M{10}));
+
+    // adjugate inverses, exact over the field
+    auto identity4 = Mat<M, 4, 4>{}.identity();
+    assert(m * m.inverse() == identity4 && m.inverse() * m == identity4);
+    auto identity3 = Mat<M, 3, 3>{}.identity();
+    assert(m3 * inverse(m3) == identity3);
+    Mat<double, 4, 4> r{{4, -2, 1, 0.5}, {3, 6, -4, 2}, {2, 1, 8, -1}, {1, 0.25, -3, 5}};
+    auto ri = r.inverse() * r;
+    for (size_t i = 0; i < 4; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            assert(close(ri(i, j), i == j ? 1.0 : 0.0));
+    static_assert(Mat<double, 2, 2>{{3, 1}, {2, 2}}.inverse()(0, 1) == -0.25);
+    // integer matrices would truncate the reciprocal of the determinant, they have no inverse
+    constexpr auto invertible = []<typename X>(const X&) { return requires (const X& x) { x.inverse(); }; };
+    static_assert(invertible(Mat<double, 2, 2>{}) && !invertible(Mat<int, 2, 2>{}));
+
+    // Gauss-Jordan beyond 4 x 4
+    Mat<M, 6, 6> g;
+    for (size_t i = 0; i < 6; ++i)
+        for (size_t j = 0; j < 6; ++j)
+            g(i, j) = M{static_cast<long long>((i + 1) * (j + 2) % 7 + (i == j ? 3 : 0))};
+    auto gi = g.inverse();
+    assert((g * gi == Mat<M, 6, 6>{}.identity()));
+
+    bool thrown = false;
+    try {
+        Mat<double, 3, 3>{{1, 2, 3}, {2, 4, 6}, {0, 1, 1}}.inverse();
+    } catch (const std::domain_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // matrix-vector product, the vector as a column
+    Vec<double, 4> x{1, -1, 2, 0.5};
+    Vec<double, 3> ax = a * x;
+    assert(ax(0) == 1 - 2 + 6 + 2 && ax(1) == 5 - 6 + 14 + 4 && ax(2) == 9 - 10 + 22 + 6);
+}
+
+void UnitTest::test27() {
+    using M = ModNum<long long, 1000000007>;
+
+    // every policy gives the serial operators' results, a small grain forces many tasks
+    constexpr size_t n = 100, m = 70;
+    auto a = allocate<long long, n, m>(execution::par(64), 3ll);
+    auto b = allocate<long long, n, m>(execution::seq);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < m; ++j)
+            (*a)(i, j) += static_cast<long long>(i * j % 13), (*b)(i, j) = static_cast<long long>(i + 2 * j);
+    auto out = std::make_unique<Mat<long long, n, m>>();
+
+    add(execution::par(64), *a, *b, *out);
+    assert(*out == *a + *b);
+    subtract(execution::par_unseq(64), *a, *b, *out);
+    assert(*out == *a - *b);
+    scale(execution::seq, *a, 5ll, *out);
+    assert(*out == *a * 5ll);
+    transform(execution::par(100), *out, *out, [](const long long& x) { return x / 5; });
+    assert(equal(execution::par(64), *out, *a) && !equal(execution::par(64), *out, *b));
+
+    fill(execution::par_unseq(32), *out, 7ll);
+    assert(reduce(execution::par(64), *out, 1ll, [](const long long& x, const long long& y) { return x + y; }) == 7 * n * m + 1);
+    assert(reduce(execution::seq, *a, 0ll, [](const long long& x, const long long& y) { return std::max(x, y); }) == 15);
+
+    // transposes, tiled out of place and pairwise in place
+    auto t = std::make_unique<Mat<long long, m, n>>();
+    transpose(execution::par(64), *a, *t);
+    assert(*t == transpose(*a));
+    auto s = std::make_unique<Mat<M, n, n>>();
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            (*s)(i, j) = M{static_cast<long long>(i * n + j)};
+    auto expected = transpose(*s);
+    transpose(execution::par(64), *s, *s);
+    assert(*s == expected);
+
+    identity(execution::par(64), *s);
+    assert((*s == Mat<M, n, n>{}.identity()));
+}
+
+void UnitTest::test28() {
+    using M = ModNum<long long, 1000000007>;
+
+    // Fibonacci numbers: (F(n + 1), F(n)) = Q^n (1, 0)
+    Mat<M, 2, 2> q{{1, 1}, {1, 0}};
+    PowerCache<M, 2> fibonacci{q};
+    const Vec<M, 2> start{1, 0};
+    assert(fibonacci.apply(0, start) == start);
+    assert(fibonacci.apply(90, start)(1) == M{2880067194370816120ll % 1000000007});
+    const unsigned long long big = 1000000000000000000ull;
+    assert(fibonacci.apply(big, start)(1) == power(q, big)(1, 0));
+
+    // a 4-bit window and a bounded exponent against repeated squaring
+    constexpr size_t n = 12;
+    Mat<M, n, n> a;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            a(i, j) = M{static_cast<long long>((i * 7 + j * 3) % 11 + i * j)};
+    PowerCache<M, n, 4> cache{a, 100000};
+    Vec<M, n> v;
+    for (size_t i = 0; i < n; ++i)
+        v(i) = M{static_cast<long long>(i + 1)};
+    std::vector<unsigned long long> exponents{0, 1, 2, 15, 16, 17, 255, 4097, 99999, 100000, 4097};
+    std::vector<Vec<M, n>> vectors(exponents.size(), v);
+    cache.apply(exponents, vectors);
+    for (size_t k = 0; k < exponents.size(); ++k) {
+        const Vec<M, n> single = cache.apply(exponents[k], v);
+        const Vec<M, n> expected = power(a, exponents[k]) * v;
+        assert(single == expected && vectors[k] == expected);
+    }
+
+    bool thrown = false;
+    try {
+        cache.apply(100001, v);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // floating point through the vector kernels: a stochastic matrix keeps the sum of v
+    constexpr size_t m = 40;
+    Mat<double, m, m> p;
+    for (size_t i = 0; i < m; ++i) {
+        p(i, i) = 0.5;
+        p((i + 1) % m, i) += 0.25;
+        p((i + 7) % m, i) += 0.25;
+    }
+    PowerCache<double, m> chain{p, 1 << 20};
+    Vec<double, m> mass;
+    mass(0) = 1.0;
+    const Vec<double, m> spread = chain.apply(1000, mass);
+    const Vec<double, m> expected = power(p, 1000) * mass;
+    double total = 0;
+    for (size_t i = 0; i < m; ++i) {
+        total += spread(i);
+        assert(std::abs(spread(i) - expected(i)) < 1e-12);
+    }
+    assert(std::abs(total - 1.0) < 1e-12);
+}
+
+void UnitTest::test29() {
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string pathA = (directory / "vecxify_test29_a.bin").string();
+    const std::string pathB = (directory / "vecxify_test29_b.bin").string();
+    const std::string pathC = (directory / "vecxify_test29_c.bin").string();
+
+    // operands written a row at a time, edge tiles in every dimension
+    constexpr size_t n = 150, k = 90, m = 200;
+    std::vector<double> a(n * k), b(k * m);
+    for (size_t i = 0; i < n * k; ++i)
+        a[i] = static_cast<double>(i % 17) - 8.0;
+    for (size_t i = 0; i < k * m; ++i)
+        b[i] = static_cast<double>(i % 11) * 0.5;
+    {
+        auto fileA = FileMatrix<double>::create(pathA, n, k);
+        auto fileB = FileMatrix<double>::create(pathB, k, m);
+        for (size_t i = 0; i < n; ++i)
+            fileA.write(i, 0, 1, k, a.data() + i * k, k);
+        fileB.write(0, 0, k, m, b.data(), m);
+    }
+
+    auto lhs = FileMatrix<double>::open(pathA, n, k);
+    auto rhs = FileMatrix<double>::open(pathB, k, m);
+    auto out = FileMatrix<double>::create(pathC, n, m);
+
+    // six 32 x 32 tiles of doubles fit the budget
+    const OutOfCoreStats stats = multiply(lhs, rhs, out, 6 * 32 * 32 * sizeof(double));
+    assert(stats.tile == 32);
+    assert(stats.bytesWritten == n * m * sizeof(double));
+    assert(stats.bytesRead >= (n * k + k * m) * sizeof(double));
+    // every tile of out but the first reuses a tile of lhs or rhs from the one before
+    constexpr size_t tilesN = (n + 31) / 32, tilesM = (m + 31) / 32;
+    assert(stats.bytesRead < (tilesM * n * k + tilesN * k * m) * sizeof(double));
+
+    std::vector<double> c(n * m);
+    out.read(0, 0, n, m, c.data(), m);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            double sum = 0;
+            for (size_t p = 0; p < k; ++p)
+                sum += a[i * k + p] * b[p * m + j];
+            assert(c[i * m + j] == sum);
+        }
+    }
+
+    // a block read back through a leading dimension
+    std::vector<double> block(3 * 4);
+    lhs.read(10, 20, 3, 4, block.data(), 4);
+    assert(block[5] == a[11 * k + 21]);
+
+    bool thrown = false;
+    try {
+        multiply(lhs, rhs, out, 64);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    thrown = false;
+    try {
+        FileMatrix<double>::open(pathA, n, k + 1);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::filesystem::remove(pathA);
+    std::filesystem::remove(pathB);
+    std::filesystem::remove(pathC);
+}
+
+void UnitTest::test30() {
+    // odd inner dimension and a column count past the 16 and 8 column blocks
+    constexpr size_t n = 7, k = 37, m = 29;
+    auto a = std::make_unique<Mat<int8_t, n, k>>();
+    auto u = std::make_unique<Mat<uint8_t, n, k>>();
+    auto b = std::make_unique<Mat<int8_t, k, m>>();
+    auto w = std::make_unique<Mat<int16_t, k, m>>();
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t p = 0; p < k; ++p) {
+            (*a)(i, p) = static_cast<int8_t>(static_cast<int>((i * 37 + p * 11) % 256) - 128);
+            (*u)(i, p) = static_cast<uint8_t>((i * 53 + p * 29) % 256);
+        }
+    }
+    for (size_t p = 0; p < k; ++p) {
+        for (size_t j = 0; j < m; ++j) {
+            (*b)(p, j) = static_cast<int8_t>(static_cast<int>((p * 13 + j * 71) % 256) - 128);
+            (*w)(p, j) = static_cast<int16_t>(static_cast<int>((p * 997 + j * 331) % 2000) - 1000);
+        }
+    }
+
+    // full-range operands give exact 32-bit sums
+    auto check = [&](const auto& lhs, const auto& rhs) {
+        auto out = std::make_unique<Mat<int32_t, n, m>>();
+        multiply(lhs, rhs, *out);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                int32_t sum = 0;
+                for (size_t p = 0; p < k; ++p)
+                    sum += static_cast<int32_t>(lhs(i, p)) * rhs(p, j);
+                assert((*out)(i, j) == sum);
+            }
+        }
+    };
+    check(*a, *b);
+    check(*u, *b);
+    check(*a, *w);
+    Mat<int8_t, 1, 1> one{{-128}};
+    Mat<int32_t, 1, 1> square;
+    multiply(one, one, square);
+    assert(square(0, 0) == 16384);
+
+    // real product: lhs per row, rhs per tensor, zero points undone by the row and column sums
+    Quantization qa{std::vector<float>(n), std::vector<int32_t>(n)};
+    for (size_t i = 0; i < n; ++i)
+        qa.scales[i] = 0.5f / static_cast<float>(i + 1), qa.zeroPoints[i] = static_cast<int32_t>(i) * 10;
+    const Quantization qb{{0.25f}, {-3}};
+    auto real = std::make_unique<Mat<float, n, m>>();
+    multiply(*u, qa, *b, qb, *real);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            double sum = 0;
+            for (size_t p = 0; p < k; ++p)
+                sum += (qa.scales[i] * ((*u)(i, p) - qa.zeroPoints[i])) * (0.25 * ((*b)(p, j) + 3));
+            assert(std::abs((*real)(i, j) - sum) <= 1e-4 * std::max(1.0, std::abs(sum)));
+        }
+    }
+
+    // int8 output rounds to nearest and saturates
+    const Quantization qo{{4.0f}, {5}};
+    auto quantized = std::make_unique<Mat<int8_t, n, m>>();
+    multiply(*u, qa, *b, qb, *quantized, qo);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            const long expected = std::clamp<long>(std::lrint((*real)(i, j) / 4.0f) + 5, -128, 127);
+            assert(std::abs((*quantized)(i, j) - expected) <= 1);
+        }
+    }
+
+    bool thrown = false;
+    try {
+        multiply(*u, Quantization{{1.0f, 2.0f}, {0}}, *b, qb, *real);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+void UnitTest::test31() {
+    // padded strides: rows start on cache lines, a 4 KiB stride gets one more line
+    static_assert(LayoutMat<double, 3, 1023, layout::PaddedRowMajor>::leadingDimension() == 1032);
+    static_assert(LayoutMat<double, 3, 512, layout::PaddedRowMajor>::leadingDimension() == 520);
+    static_assert(LayoutMat<double, 1, 512, layout::PaddedRowMajor>::leadingDimension() == 512);
+    static_assert(LayoutMat<float, 5, 3, layout::PaddedColumnMajor>::leadingDimension() == 16);
+    static_assert(LayoutMat<double, 5, 3, layout::ColumnMajor>::leadingDimension() == 5);
+
+    constexpr size_t n = 37, k = 70, m = 45;
+    auto a = std::make_unique<Mat<double, n, k>>();
+    auto b = std::make_unique<Mat<double, k, m>>();
+    for (size_t i = 0; i < n; ++i)
+        for (size_t p = 0; p < k; ++p)
+            (*a)(i, p) = static_cast<double>((i * 7 + p * 3) % 13) - 6.0;
+    for (size_t p = 0; p < k; ++p)
+        for (size_t j = 0; j < m; ++j)
+            (*b)(p, j) = static_cast<double>((p * 5 + j) % 11) * 0.5;
+    auto expected = std::make_unique<Mat<double, n, m>>();
+    multiply(*a, *b, *expected);
+
+    // conversions keep every element and start on a cache line
+    LayoutMat<double, n, k, layout::PaddedColumnMajor> ac{*a};
+    assert(reinterpret_cast<uintptr_t>(ac.data()) % 64 == 0);
+    assert(ac(5, 9) == (*a)(5, 9) && ac.data()[9 * ac.leadingDimension() + 5] == (*a)(5, 9));
+    LayoutMat<double, n, k, layout::RowMajor> ar{ac};
+    LayoutMat<double, k, m, layout::PaddedRowMajor> br{*b};
+    LayoutMat<double, k, m, layout::ColumnMajor> bc{br};
+    auto back = std::make_unique<Mat<double, n, k>>();
+    ar.store(*back);
+    assert(*back == *a);
+
+    // every mix of orders gives the same product
+    auto check = [&](const auto& out) {
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < m; ++j)
+                assert(out(i, j) == (*expected)(i, j));
+    };
+    LayoutMat<double, n, m, layout::PaddedRowMajor> cr;
+    LayoutMat<double, n, m, layout::ColumnMajor> cc;
+    multiply(ar, br, cr);
+    check(cr);
+    multiply(ac, bc, cc);
+    check(cc);
+    multiply(ac, br, cr);
+    check(cr);
+    multiply(ar, bc, cc);
+    check(cc);
+
+    // the transpose takes the storage over, and products alias their operands
+    LayoutMat<double, m, n, layout::RowMajor> ct = std::move(cc).transpose();
+    assert(ct(4, 7) == (*expected)(7, 4));
+    auto unit = std::make_unique<Mat<double, n, n>>();
+    LayoutMat<double, n, n, layout::PaddedColumnMajor> sq{unit->identity()};
+    sq(0, 1) = 2.0;
+    multiply(sq, sq, sq);
+    assert(sq(0, 1) == 4.0 && sq(1, 1) == 1.0 && sq(1, 0) == 0.0);
+
+    // other semirings run on the same layouts
+    LayoutMat<double, n, m, layout::PaddedColumnMajor> shortest;
+    multiply(ar, bc, shortest, MinPlus<double>{});
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < m; ++j) {
+            double best = (*a)(i, 0) + (*b)(0, j);
+            for (size_t p = 1; p < k; ++p)
+                best = std::min(best, (*a)(i, p) + (*b)(p, j));
+            assert(shortest(i, j) == best);
+        }
+    }
+
+    // elements of 24 bytes do not divide a cache line: unpadded layouts take them, and an operand
+    // in the other order is converted without padding
+    struct Wide {
+        double value = 0, spare[2] = {};
+        Wide() = default;
+        Wide(const double& x) : value { x } {}
+        Wide operator+(const Wide& rhs) const { return value + rhs.value; }
+        Wide operator*(const Wide& rhs) const { return value * rhs.value; }
+        Wide operator-() const { return -value; }
+        bool operator==(const Wide& rhs) const { return value == rhs.value; }
+    };
+    static_assert(detail::LAYOUT_ALIGNMENT % sizeof(Wide) != 0);
+    LayoutMat<Wide, 3, 4, layout::RowMajor> wa;
+    LayoutMat<Wide, 4, 5, layout::ColumnMajor> wb;
+    LayoutMat<Wide, 3, 5, layout::RowMajor> wc;
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t p = 0; p < 4; ++p)
+            wa(i, p) = static_cast<double>(i + p);
+    for (size_t p = 0; p < 4; ++p)
+        for (size_t j = 0; j < 5; ++j)
+            wb(p, j) = static_cast<double>(p * j) - 2.0;
+    multiply(wa, wb, wc);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 5; ++j) {
+            double sum = 0;
+            for (size_t p = 0; p < 4; ++p)
+                sum += static_cast<double>(i + p) * (static_cast<double>(p * j) - 2.0);
+            assert(wc(i, j).value == sum);
+        }
+    }
+}
+
+void UnitTest::test32() {
+    // more points than one tile, counts that split neither in tiles nor in query blocks
+    constexpr size_t N = 13;
+    std::vector<Vec<float, N>> queries(70), points(300);
+    for (size_t i = 0; i < queries.size(); ++i)
+        for (size_t p = 0; p < N; ++p)
+            queries[i](p) = static_cast<float>((i * 7 + p * 5) % 17) * 0.25f - 2.0f;
+    for (size_t j = 0; j < points.size(); ++j)
+        for (size_t p = 0; p < N; ++p)
+            points[j](p) = static_cast<float>((j * 11 + p * 3) % 19) * 0.25f - 2.0f;
+    points[4] = Vec<float, N>{};
+    points[123](0) = 5.0f;
+
+    auto reference = [&](const size_t& i, const size_t& j, const Metric& metric) {
+        double dot = 0, squared = 0, qq = 0, pp = 0;
+        for (size_t p = 0; p < N; ++p) {
+            dot += queries[i](p) * points[j](p);
+            squared += (queries[i](p) - points[j](p)) * (queries[i](p) - points[j](p));
+            qq += queries[i](p) * queries[i](p);
+            pp += points[j](p) * points[j](p);
+        }
+        const double cosine = qq * pp > 0 ? dot / std::sqrt(qq * pp) : 0.0;
+        switch (metric) {
+            case Metric::squaredEuclidean: return squared;
+            case Metric::euclidean: return std::sqrt(squared);
+            case Metric::cosineDistance: return 1 - cosine;
+            case Metric::cosineSimilarity: return cosine;
+            default: return dot;
+        }
+    };
+
+    const Metric metrics[] = {Metric::squaredEuclidean, Metric::euclidean, Metric::cosineDistance, Metric::cosineSimilarity, Metric::innerProduct};
+    for (const Metric& metric : metrics) {
+        const std::vector<float> all = pairwise(queries, points, metric);
+        assert(all.size() == queries.size() * points.size());
+        for (size_t i = 0; i < queries.size(); ++i)
+            for (size_t j = 0; j < points.size(); ++j)
+                assert(std::abs(all[i * points.size() + j] - reference(i, j, metric)) <= 1e-3);
+
+        // the k best of each row of the full matrix, best first
+        const std::vector<std::vector<Neighbor<float>>> top = nearest(queries, points, 5, metric);
+        const bool larger = metric == Metric::cosineSimilarity || metric == Metric::innerProduct;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            std::vector<float> row(all.begin() + i * points.size(), all.begin() + (i + 1) * points.size());
+            std::sort(row.begin(), row.end());
+            if (larger)
+                std::reverse(row.begin(), row.end());
+            assert(top[i].size() == 5);
+            for (size_t r = 0; r < 5; ++r) {
+                assert(std::abs(top[i][r].value - row[r]) <= 1e-3);
+                assert(std::abs(top[i][r].value - reference(i, top[i][r].index, metric)) <= 1e-3);
+            }
+        }
+    }
+
+    // a query among the points is its own nearest neighbor, k beyond the points returns them all
+    std::vector<Vec<float, N>> self{points[123]};
+    assert(nearest(self, points, 1, Metric::euclidean)[0][0].index == 123);
+    assert(nearest(self, points, 1000, Metric::euclidean)[0].size() == points.size());
+}
+
+void UnitTest::test33() {
+    // sizes past the vector blocks with tails, the extrema placed in the middle of a block
+    constexpr size_t R = 67, C = 301;
+    auto m = std::make_unique<Mat<double, R, C>>();
+    for (size_t i = 0; i < R; ++i)
+        for (size_t j = 0; j < C; ++j)
+            (*m)(i, j) = static_cast<double>((i * 31 + j * 17) % 101) * 0.125 - 6.0;
+    (*m)(40, 250) = -100.0;
+    (*m)(12, 3) = 100.0;
+    (*m)(50, 7) = 100.0;
+
+    double total = 0, frobenius = 0, inf = 0, one = 0;
+    std::vector<double> rows(R, 0.0), cols(C, 0.0), absCols(C, 0.0);
+    for (size_t i = 0; i < R; ++i) {
+        double absRow = 0;
+        for (size_t j = 0; j < C; ++j) {
+            total += (*m)(i, j);
+            frobenius += (*m)(i, j) * (*m)(i, j);
+            rows[i] += (*m)(i, j);
+            cols[j] += (*m)(i, j);
+            absCols[j] += std::abs((*m)(i, j));
+            absRow += std::abs((*m)(i, j));
+        }
+        inf = std::max(inf, absRow);
+    }
+    one = *std::max_element(absCols.begin(), absCols.end());
+
+    // the sequential and parallel paths agree with the plain loops, the parallel ones with small ranges
+    auto check = [&](const auto& policy) {
+        assert(std::abs(sum(policy, *m) - total) < 1e-9);
+        const Vec<double, R> r = rowSums(policy, *m);
+        const Vec<double, C> c = colSums(policy, *m);
+        for (size_t i = 0; i < R; ++i)
+            assert(std::abs(r(i) - rows[i]) < 1e-9);
+        for (size_t j = 0; j < C; ++j)
+            assert(std::abs(c(j) - cols[j]) < 1e-9);
+        const Extremum<double> low = min(policy, *m), high = max(policy, *m);
+        assert(low.value == -100.0 && low.row == 40 && low.col == 250);
+        assert(high.value == 100.0 && high.row == 12 && high.col == 3);
+        assert(std::abs(frobeniusNorm(policy, *m) - std::sqrt(frobenius)) < 1e-9);
+        assert(std::abs(norm1(policy, *m) - one) < 1e-9);
+        assert(std::abs(normInf(policy, *m) - inf) < 1e-9);
+    };
+    check(execution::seq);
+    check(execution::par(1000));
+    check(execution::par_unseq(1000));
+    assert(sum(execution::par(1000), *m) == sum(execution::par(1000), *m));
+
+    // pairwise summation keeps a long sum of 0.1 close
+    auto tenths = std::make_unique<Mat<float, 1000, 1000>>();
+    fill(execution::seq, *tenths, 0.1f);
+    assert(std::abs(sum(*tenths) - 100000.0f) < 1.0f);
+
+    // integers, sums in the element type
+    Mat<int, 3, 3> small{{1, -2, 3}, {-4, 5, -6}, {7, -8, 9}};
+    assert(sum(small) == 5);
+    assert(trace(small) == 15);
+    assert(norm1(small) == 18 && normInf(small) == 24);
+    assert(frobeniusNorm(small) == std::sqrt(285.0));
+    assert(min(small).value == -8 && min(small).row == 2 && min(small).col == 1);
+    assert(colSums(small)(2) == 6 && rowSums(small)(1) == -5);
+    Mat<uint8_t, 2, 40> bytes;
+    bytes(1, 33) = 200;
+    assert(max(bytes).row == 1 && max(bytes).col == 33 && min(bytes).row == 0 && min(bytes).col == 0);
+
+    // plain sums for other elements
+    using M7 = ModNum<int, 7>;
+    Mat<M7, 2, 2> residues{{M7(3), M7(4)}, {M7(5), M7(6)}};
+    assert(sum(residues) == M7(4));
+    assert(trace(residues) == M7(2));
+}